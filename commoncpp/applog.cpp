@@ -52,6 +52,11 @@
 #include <cstdlib>
 #include <stdarg.h>
 #include <errno.h>
+#ifndef _MSWINDOWS_
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
 
 // TODO sc: test if has to move up now that it is into commoncpp
 // NOTE: the order of inclusion is important do not move following include line
@@ -62,6 +67,8 @@
 
 namespace ost {
 
+class logRing;
+
 class logStruct
 {
   public:
@@ -72,6 +79,8 @@ class logStruct
     bool         _clogEnable;
     bool         _slogEnable;
     size_t       _msgpos;
+    logRing      *_ring;
+    time_t       _stampTime;
 
     enum logEnum
     {
@@ -79,12 +88,17 @@ class logStruct
       LAST_CHAR = BUFF_SIZE - 1
     };
     char         _msgbuf[BUFF_SIZE];
+    // formatted date and time up to the second, cached per thread, with
+    // room for six fields of any int value
+    char         _stamp[72];
 
     logStruct() :  _ident("") ,  _priority(Slog::levelDebug),
         _level(Slog::levelDebug), _enable(false),
-        _clogEnable(false), _slogEnable(false), _msgpos(0)
+        _clogEnable(false), _slogEnable(false), _msgpos(0),
+        _ring(NULL), _stampTime(0)
     {
       memset(_msgbuf, 0, BUFF_SIZE);
+      _stamp[0] = '\0';
     };
 
     ~logStruct() {};
@@ -140,6 +154,72 @@ class logger : public ost::ThreadQueue
 
 };
 
+#ifndef _MSWINDOWS_
+
+// a single producer, single consumer byte ring of formatted log lines for
+// one subscribed thread.  The thread only publishes whole messages, so the
+// writer never sees a partial line.
+class logRing
+{
+  public:
+    char            *_buf;
+    size_t          _mask;
+    volatile size_t _head;      // bytes published by the logging thread
+    volatile size_t _tail;      // bytes written out by the writer thread
+    volatile bool   _detached;  // thread unsubscribed, free once drained
+    unsigned long   _dropped;
+    logRing         *_next;
+
+    logRing(size_t size);
+    ~logRing();
+
+    bool put(const char *msg, size_t len);
+};
+
+// writer thread of asynchronous logging, gathering all rings into the
+// log file.  It sleeps on the conditional when idle, and threads blocked
+// on a full ring wait on the same conditional for room.
+class asyncLogger : protected ucommon::JoinableThread, protected ucommon::Conditional
+{
+  private:
+    string          _nomeFile;
+    int             _fd;
+    size_t          _ringSize;
+    AppLog::Overflow _policy;
+    logRing         *_rings;
+    unsigned long   _dropped;
+    volatile bool   _idle;
+    volatile bool   _stopping;
+    volatile bool   _closedByApplog;
+    volatile unsigned _blocked;
+
+    size_t flush(void);
+    bool pending(void);
+    void writeOut(struct iovec *iov, unsigned count, logRing **rings, size_t *sizes, unsigned used);
+    void release(void);
+    void wakeup(void);
+
+  protected:
+    void run(void);
+
+  public:
+    asyncLogger(const char *logFileName, size_t ringSize, AppLog::Overflow policy);
+    virtual ~asyncLogger();
+
+    logRing *attach(void);
+    void detach(logRing *ring);
+    bool post(logRing *ring, const char *msg, size_t len);
+    unsigned long dropped(void);
+
+    inline void openFile(void)
+      {_closedByApplog = false;}
+
+    inline void closeFile(void)
+      {_closedByApplog = true;}
+};
+
+#endif
+
 // mapping thread ID <-> logStruct (buffer)
 typedef std::map <cctid_t, logStruct> LogPrivateData;
 // map ident <-> levels
@@ -159,6 +239,14 @@ class __LOCAL AppLogPrivate
     bool           _logPipe;
     // log spooler
     logger         *_pLogger;
+#ifndef _MSWINDOWS_
+    // asynchronous log writer
+    asyncLogger    *_pAsync;
+#endif
+    unsigned long  _dropped;
+    // held shared while posting to the async writer, and exclusively to
+    // replace it, so it is never freed under a posting thread
+    ost::ThreadLock _asyncLock;
 
     string        _nomeFile;
     Mutex         _lock;
@@ -167,13 +255,47 @@ class __LOCAL AppLogPrivate
     static const levelNamePair _values[];
     static LevelName           _assoc;
 
-    AppLogPrivate() : _pLogger(NULL) {}
+    AppLogPrivate() : _pLogger(NULL), _dropped(0)
+    {
+#ifndef _MSWINDOWS_
+      _pAsync = NULL;
+#endif
+    }
 
     ~AppLogPrivate()
     {
+      asyncRelease();
       if (_pLogger)
         delete _pLogger;
     }
+
+    inline bool async(void) const
+    {
+#ifndef _MSWINDOWS_
+      return _pAsync != NULL;
+#else
+      return false;
+#endif
+    }
+
+    // stop asynchronous logging, the caller holds _subMutex
+    void asyncRelease(void)
+    {
+#ifndef _MSWINDOWS_
+      if (!_pAsync)
+        return;
+
+      _asyncLock.writeLock();
+      for (LogPrivateData::iterator it = _logs.begin(); it != _logs.end(); ++it)
+        it->second._ring = NULL;
+
+      // the writer drains every ring before it goes
+      _dropped += _pAsync->dropped();
+      delete _pAsync;
+      _pAsync = NULL;
+      _asyncLock.unlock();
+#endif
+    }
 };
 
 const levelNamePair AppLogPrivate::_values[] =
@@ -425,6 +547,298 @@ void logger::final()
   }
 }
 
+#ifndef _MSWINDOWS_
+
+// slices gathered into a single writev, within any posix IOV_MAX
+#define LOG_VECTORS 64
+
+logRing::logRing(size_t size) : _head(0), _tail(0), _detached(false), _dropped(0), _next(NULL)
+{
+  size_t limit = 4096;
+
+  while (limit < size)
+    limit <<= 1;
+
+  _buf = new char[limit];
+  _mask = limit - 1;
+}
+
+logRing::~logRing()
+{
+  delete[] _buf;
+}
+
+bool logRing::put(const char *msg, size_t len)
+{
+  size_t head = _head;
+  size_t pos = head & _mask;
+  size_t first = _mask + 1 - pos;
+
+  if (len > _mask + 1 - (head - ucommon::atomic::load(&_tail)))
+    return false;
+
+  if (first > len)
+    first = len;
+  memcpy(_buf + pos, msg, first);
+  memcpy(_buf, msg + first, len - first);
+  ucommon::atomic::store(&_head, head + len);
+  return true;
+}
+
+asyncLogger::asyncLogger(const char *logFileName, size_t ringSize, AppLog::Overflow policy) :
+JoinableThread(), Conditional(), _nomeFile(logFileName), _ringSize(ringSize), _policy(policy),
+_rings(NULL), _dropped(0), _idle(false), _stopping(false), _closedByApplog(false), _blocked(0)
+{
+  _fd = ::open(_nomeFile.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0640);
+  if (_fd < 0)
+    THROW(AppLogException("Can't open log file name"));
+
+  start();
+}
+
+asyncLogger::~asyncLogger()
+{
+  _stopping = true;
+  lock();
+  broadcast();
+  unlock();
+  join();
+
+  while (_rings)
+  {
+    logRing *next = _rings->_next;
+    delete _rings;
+    _rings = next;
+  }
+
+  if (_fd > -1)
+    ::close(_fd);
+}
+
+logRing *asyncLogger::attach(void)
+{
+  logRing *ring = new logRing(_ringSize);
+
+  lock();
+  ring->_next = _rings;
+  _rings = ring;
+  unlock();
+  return ring;
+}
+
+void asyncLogger::detach(logRing *ring)
+{
+  // the writer frees it once it has been written out
+  ring->_detached = true;
+  wakeup();
+}
+
+void asyncLogger::wakeup(void)
+{
+  // pairs with the fence the writer makes before going idle
+  ucommon::atomic::fence();
+  if (!_idle)
+    return;
+
+  lock();
+  signal();
+  unlock();
+}
+
+bool asyncLogger::post(logRing *ring, const char *msg, size_t len)
+{
+  if (len > ring->_mask + 1)
+    len = ring->_mask + 1;
+
+  if (ring->put(msg, len))
+  {
+    wakeup();
+    return true;
+  }
+
+  if (_policy == AppLog::overflowDrop)
+  {
+    ++ring->_dropped;
+    return false;
+  }
+
+  lock();
+  ++_blocked;
+  while (!ring->put(msg, len))
+  {
+    broadcast();
+    Conditional::wait((timeout_t)10);
+  }
+  --_blocked;
+  broadcast();
+  unlock();
+  return true;
+}
+
+unsigned long asyncLogger::dropped(void)
+{
+  unsigned long total = _dropped;
+
+  lock();
+  for (logRing *ring = _rings; ring; ring = ring->_next)
+    total += ring->_dropped;
+  unlock();
+  return total;
+}
+
+void asyncLogger::writeOut(struct iovec *iov, unsigned count, logRing **rings, size_t *sizes, unsigned used)
+{
+  ssize_t result;
+
+  if (_fd < 0)
+    _fd = ::open(_nomeFile.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0640);
+
+  // a failing log file loses the lines rather than stalling every thread
+  while (count && _fd > -1)
+  {
+    result = ::writev(_fd, iov, count);
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result < 1)
+      break;
+    while (count && (size_t)result >= iov->iov_len)
+    {
+      result -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count)
+    {
+      iov->iov_base = (char *)iov->iov_base + result;
+      iov->iov_len -= result;
+    }
+  }
+
+  for (unsigned pos = 0; pos < used; ++pos)
+    ucommon::atomic::store(&rings[pos]->_tail, rings[pos]->_tail + sizes[pos]);
+
+  if (_blocked)
+  {
+    lock();
+    broadcast();
+    unlock();
+  }
+}
+
+size_t asyncLogger::flush(void)
+{
+  struct iovec iov[LOG_VECTORS];
+  logRing *rings[LOG_VECTORS / 2];
+  size_t sizes[LOG_VECTORS / 2];
+  unsigned count = 0, used = 0;
+  size_t head, tail, pos, first, total = 0;
+  logRing *ring;
+
+  // only this thread unlinks rings, so the list can be walked unlocked
+  lock();
+  ring = _rings;
+  unlock();
+
+  while (ring)
+  {
+    head = ucommon::atomic::load(&ring->_head);
+    tail = ring->_tail;
+    if (head != tail)
+    {
+      pos = tail & ring->_mask;
+      first = ring->_mask + 1 - pos;
+      if (first > head - tail)
+        first = head - tail;
+      iov[count].iov_base = ring->_buf + pos;
+      iov[count++].iov_len = first;
+      if (first < head - tail)
+      {
+        iov[count].iov_base = ring->_buf;
+        iov[count++].iov_len = head - tail - first;
+      }
+      rings[used] = ring;
+      sizes[used++] = head - tail;
+      total += head - tail;
+      if (count > LOG_VECTORS - 2)
+      {
+        writeOut(iov, count, rings, sizes, used);
+        count = used = 0;
+      }
+    }
+    ring = ring->_next;
+  }
+
+  if (count)
+    writeOut(iov, count, rings, sizes, used);
+
+  if (_closedByApplog && _fd > -1)
+  {
+    ::close(_fd);
+    _fd = -1;
+  }
+  return total;
+}
+
+// called with the lock held
+bool asyncLogger::pending(void)
+{
+  for (logRing *ring = _rings; ring; ring = ring->_next)
+  {
+    if (ucommon::atomic::load(&ring->_head) != ring->_tail)
+      return true;
+  }
+  return false;
+}
+
+void asyncLogger::release(void)
+{
+  logRing *ring, *prev = NULL, *next;
+
+  lock();
+  ring = _rings;
+  while (ring)
+  {
+    next = ring->_next;
+    if (ring->_detached && ucommon::atomic::load(&ring->_head) == ring->_tail)
+    {
+      if (prev)
+        prev->_next = next;
+      else
+        _rings = next;
+      _dropped += ring->_dropped;
+      delete ring;
+    }
+    else
+      prev = ring;
+    ring = next;
+  }
+  unlock();
+}
+
+void asyncLogger::run(void)
+{
+  for (;;)
+  {
+    if (flush())
+      continue;
+
+    release();
+    if (_stopping)
+      break;
+
+    lock();
+    _idle = true;
+    ucommon::atomic::fence();
+    // a post made before we went idle is found here, later ones signal us
+    if (!_stopping && !pending())
+      Conditional::wait((timeout_t)100);
+    _idle = false;
+    unlock();
+  }
+}
+
+#endif
+
 #ifndef _MSWINDOWS_
 AppLog::AppLog(const char* logFileName, bool logDirectly, bool usePipe) :
     streambuf(), ostream((streambuf*) this)
@@ -538,6 +952,11 @@ void AppLog::unsubscribe()
     LogPrivateData::iterator logIt = d->_logs.find(tid);
     if (logIt != d->_logs.end())
     {
+#ifndef _MSWINDOWS_
+      // the writer frees the ring once the last lines are written
+      if (logIt->second._ring)
+        d->_pAsync->detach(logIt->second._ring);
+#endif
       // unsubscribes thread
       d->_logs.erase(logIt);
     }
@@ -556,6 +975,10 @@ void AppLog::logFileName(const char* FileName, bool logDirectly)
     return;
   }
 
+  d->_subMutex.enterMutex();
+  d->asyncRelease();
+  d->_subMutex.leaveMutex();
+
   d->_lock.enterMutex();
   d->_nomeFile = FileName;
   close();
@@ -603,6 +1026,33 @@ void AppLog::logFileName(const char* FileName, bool logDirectly)
   d->_lock.leaveMutex();
 }
 
+// formats the time of a message, the date and time of day are only
+// reformatted when the second changes
+static void logStamp(logStruct& ls, char *buf, size_t size)
+{
+  struct timeval detail_time;
+  time_t now;
+
+  gettimeofday(&detail_time, NULL);
+  now = detail_time.tv_sec;
+  if (now != ls._stampTime || !ls._stamp[0])
+  {
+    struct tm *dt;
+#ifdef HAVE_LOCALTIME_R
+    struct tm local;
+    dt = ::localtime_r(&now, &local);
+#else
+    dt = localtime(&now);
+#endif
+    snprintf(ls._stamp, sizeof(ls._stamp), "%04d-%02d-%02d %02d:%02d:%02d",
+             dt->tm_year + 1900, dt->tm_mon + 1, dt->tm_mday,
+             dt->tm_hour, dt->tm_min, dt->tm_sec);
+    ls._stampTime = now;
+  }
+
+  snprintf(buf, size, "%s.%03d ", ls._stamp, (int)(detail_time.tv_usec / 1000));
+}
+
 // writes to log
 void AppLog::writeLog(bool endOfLine)
 {
@@ -616,7 +1066,7 @@ void AppLog::writeLog(bool endOfLine)
       return;
 
     if ((d->_logDirectly && !d->_logfs.is_open() && !logIt->second._clogEnable) ||
-        (!d->_logDirectly && !d->_pLogger && !logIt->second._clogEnable))
+        (!d->_logDirectly && !d->_pLogger && !d->async() && !logIt->second._clogEnable))
 
     {
       logIt->second._msgpos = 0;
@@ -626,13 +1076,10 @@ void AppLog::writeLog(bool endOfLine)
 
     if (logIt->second._enable)
     {
-      time_t now;
-      struct tm *dt;
-      time(&now);
-      struct timeval detail_time;
-      gettimeofday(&detail_time, NULL);
-      dt = localtime(&now);
-      char buf[50];
+      char buf[96];
+      bool locked = false;
+
+      logStamp(logIt->second, buf, sizeof(buf));
 
       const char *p = "unknown";
       switch (logIt->second._priority)
@@ -663,15 +1110,10 @@ void AppLog::writeLog(bool endOfLine)
           break;
       }
 
-      snprintf(buf, sizeof(buf) - 1, "%04d-%02d-%02d %02d:%02d:%02d.%03d ",
-               dt->tm_year + 1900, dt->tm_mon + 1, dt->tm_mday,
-               dt->tm_hour, dt->tm_min, dt->tm_sec, (int)(detail_time.tv_usec / 1000));
-
-      buf[sizeof(buf)-1] = 0;    // per sicurezza
-
       if (d->_logDirectly)
       {
         d->_lock.enterMutex();
+        locked = true;
         if (d->_logfs.is_open())
         {
           d->_logfs << buf;
@@ -687,6 +1129,35 @@ void AppLog::writeLog(bool endOfLine)
           d->_logfs.flush();
         }
       }
+#ifndef _MSWINDOWS_
+      else if (d->_pAsync)
+      {
+        // formatted in place and handed to the writer without locking
+        char line[logStruct::BUFF_SIZE + 128];
+        int len;
+
+        if (logIt->second._ident.empty())
+          len = snprintf(line, sizeof(line), "%s[%s] %s", buf, p, logIt->second._msgbuf);
+        else
+          len = snprintf(line, sizeof(line), "%s%s: [%s] %s", buf,
+                         logIt->second._ident.c_str(), p, logIt->second._msgbuf);
+        if (len < 0)
+          len = 0;
+        if (len > (int)sizeof(line) - 2)
+          len = (int)sizeof(line) - 2;
+        if (endOfLine)
+          line[len++] = '\n';
+
+        d->_asyncLock.readLock();
+        if (d->_pAsync)
+        {
+          if (!logIt->second._ring)
+            logIt->second._ring = d->_pAsync->attach();
+          d->_pAsync->post(logIt->second._ring, line, len);
+        }
+        d->_asyncLock.unlock();
+      }
+#endif
       else if (d->_pLogger)
       {
         // ThreadQueue
@@ -710,11 +1181,17 @@ void AppLog::writeLog(bool endOfLine)
         d->_pLogger->post((void *) sstr.str().c_str(), sstr.str().length() + 1);
 
         d->_lock.enterMutex();
+        locked = true;
       }
 
       // slog it if error level is right
       if (logIt->second._slogEnable && logIt->second._priority <= Slog::levelError)
       {
+        if (!locked)
+        {
+          d->_lock.enterMutex();
+          locked = true;
+        }
         slog((Slog::Level) logIt->second._priority) << logIt->second._msgbuf;
         if (endOfLine) slog << endl;
       }
@@ -724,12 +1201,18 @@ void AppLog::writeLog(bool endOfLine)
 #endif
          )
       {
+        if (!locked)
+        {
+          d->_lock.enterMutex();
+          locked = true;
+        }
         clog << logIt->second._msgbuf;
         if (endOfLine)
           clog << endl;
       }
 
-      d->_lock.leaveMutex();
+      if (locked)
+        d->_lock.leaveMutex();
     }
 
     logIt->second._msgpos = 0;
@@ -749,6 +1232,10 @@ void AppLog::close(void)
     }
     d->_lock.leaveMutex();
   }
+#ifndef _MSWINDOWS_
+  else if (d->_pAsync)
+    d->_pAsync->closeFile();
+#endif
   else
   {
     if (d->_pLogger)
@@ -756,6 +1243,46 @@ void AppLog::close(void)
   }
 }
 
+void AppLog::asyncEnable(size_t ringSize, Overflow policy)
+{
+#ifndef _MSWINDOWS_
+  ost::MutexLock mtx(d->_subMutex);
+
+  if (d->_nomeFile.empty() || d->_logPipe)
+  {
+    slog.error("Asynchronous log needs a log file!");
+    return;
+  }
+
+  d->asyncRelease();
+  close();
+
+  d->_lock.enterMutex();
+  if (d->_pLogger)
+  {
+    delete d->_pLogger;
+    d->_pLogger = NULL;
+  }
+  d->_logDirectly = false;
+  asyncLogger *writer = new asyncLogger(d->_nomeFile.c_str(), ringSize, policy);
+  d->_asyncLock.writeLock();
+  d->_pAsync = writer;
+  d->_asyncLock.unlock();
+  d->_lock.leaveMutex();
+#endif
+}
+
+unsigned long AppLog::dropped(void)
+{
+  ost::MutexLock mtx(d->_subMutex);
+
+#ifndef _MSWINDOWS_
+  if (d->_pAsync)
+    return d->_dropped + d->_pAsync->dropped();
+#endif
+  return d->_dropped;
+}
+
 void AppLog::open(const char *ident)
 {
   Thread *pThr = getThread();
@@ -786,6 +1313,10 @@ void AppLog::open(const char *ident)
       }
       d->_lock.leaveMutex();
     }
+#ifndef _MSWINDOWS_
+    else if (d->_pAsync)
+      d->_pAsync->openFile();
+#endif
     else
     {
       if (d->_pLogger)
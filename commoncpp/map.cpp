@@ -44,6 +44,17 @@
 
 namespace ost {
 
+// chains are walked by concurrent lookups while they are changed
+static inline MapObject *map_get(MapObject *const volatile *ptr)
+{
+    return (MapObject *)ucommon::atomic::load((void *const volatile *)ptr);
+}
+
+static inline void map_put(MapObject *volatile *ptr, MapObject *obj)
+{
+    ucommon::atomic::store((void *volatile *)ptr, obj);
+}
+
 MapIndex& MapIndex::operator=(MapObject *theObject)
 {
     thisObject = theObject;
@@ -59,14 +70,14 @@ MapIndex& MapIndex::operator++()
         thisObject = thisObject->nextObject;
     }
     else if (thisObject->table != NULL) {
+        MapTable *table = thisObject->table;
         MapObject* obj = NULL;
-        unsigned i = thisObject->table->getIndex(thisObject->idObject) + 1;
 
-
-        thisObject->table->enterMutex();
-        for ( ; obj == NULL && i < thisObject->table->range; i++)
-                obj = thisObject->table->map[i];
-        thisObject->table->leaveMutex();
+        table->enterMutex();
+        unsigned i = table->index(thisObject->idObject) + 1;
+        for ( ; obj == NULL && i < table->range; i++)
+                obj = table->map[i];
+        table->leaveMutex();
 
         thisObject = obj;
     }
@@ -81,6 +92,22 @@ Mutex()
     memset(map, 0, sizeof(MapObject *) * (size + 1));
     range = size;
     count = 0;
+    concurrent = false;
+    sequence = 0;
+}
+
+MapTable::MapTable(unsigned size, bool lockfree) :
+Mutex()
+{
+    if(!size)
+        size = 1;
+
+    map = new MapObject *[size + 1];
+    memset(map, 0, sizeof(MapObject *) * (size + 1));
+    range = size;
+    count = 0;
+    concurrent = lockfree;
+    sequence = 0;
 }
 
 MapTable::~MapTable()
@@ -99,12 +126,50 @@ void MapTable::cleanup(void)
 
 unsigned MapTable::getIndex(const char *id)
 {
-    unsigned key = 0;
+    return ucommon::String::hash_case(id) % range;
+}
+
+unsigned MapTable::index(const char *id)
+{
+    if(concurrent)
+        return ucommon::String::hash_case(id) % range;
+
+    return getIndex(id);
+}
+
+// objects are pushed onto the chains of a new set of slots while lookups
+// may still walk the old ones.  A lookup that is carried onto a new chain
+// may miss, but then sees the sequence changed and tries again.
+void MapTable::grow(void)
+{
+    unsigned size = range * 2, slot;
+    MapObject **slots = new MapObject *[size + 1], **prior = map;
+    MapObject *obj, *next;
+
+    memset(slots, 0, sizeof(MapObject *) * (size + 1));
+    slots[size] = map[range];
+
+    ucommon::atomic::add(&sequence, 1);
+    for(unsigned pos = 0; pos < range; ++pos) {
+        obj = map[pos];
+        while(obj) {
+            next = obj->nextObject;
+            slot = ucommon::String::hash_case(obj->idObject) % size;
+            map_put(&obj->nextObject, slots[slot]);
+            slots[slot] = obj;
+            obj = next;
+        }
+    }
 
-    while(*id)
-        key = (key << 1) ^ (*(id++) & 0x1f);
+    // lookups read range before map, so a larger range is never used
+    // to index into the prior slots.
+    ucommon::atomic::store((void *volatile *)&map, slots);
+    ucommon::atomic::fence();
+    range = size;
+    ucommon::atomic::add(&sequence, 1);
 
-    return key % range;
+    readers.synchronize();
+    delete[] prior;
 }
 
 void *MapTable::getObject(const char *id)
@@ -112,8 +177,35 @@ void *MapTable::getObject(const char *id)
     if(!map)
         return NULL;
 
+    if(concurrent && !ucommon::atomic::simulated) {
+        unsigned hash = ucommon::String::hash_case(id), size;
+        unsigned reader = readers.enter();
+        MapObject *obj, **slots;
+        long seq;
+
+        for(;;) {
+            seq = ucommon::atomic::load(&sequence);
+            if(seq & 1) {
+                Thread::yield();
+                continue;
+            }
+            // the range is read before the slots, as grow expects...
+            size = *(const volatile unsigned *)&range;
+            ucommon::atomic::fence();
+            slots = (MapObject **)ucommon::atomic::load((void *const volatile *)&map);
+            obj = map_get(&slots[hash % size]);
+            while(obj && stricmp(obj->idObject, id))
+                obj = map_get(&obj->nextObject);
+            if(obj || ucommon::atomic::load(&sequence) == seq)
+                break;
+        }
+
+        readers.leave(reader);
+        return (void *)obj;
+    }
+
     enterMutex();
-    MapObject *obj = map[getIndex(id)];
+    MapObject *obj = map[index(id)];
 
     while(obj) {
         if(!stricmp(obj->idObject, id))
@@ -178,17 +270,20 @@ void MapTable::addFree(MapObject *obj)
 
 void MapTable::addObject(MapObject &obj)
 {
-    unsigned idx = getIndex(obj.idObject);
-
     if(obj.table == this || !map)
         return;
 
     obj.detach();
     enterMutex();
+    unsigned idx = index(obj.idObject);
+
+    // the object is complete before a concurrent lookup can reach it
     obj.nextObject = map[idx];
-    map[idx] = &obj;
     obj.table = this;
+    map_put(&map[idx], &obj);
     count++;
+    if(concurrent && count > range)
+        grow();
     leaveMutex();
 }
 
@@ -219,8 +314,8 @@ void MapObject::detach(void)
     if(!table)
         return;
 
-    idx = table->getIndex(idObject);
     table->enterMutex();
+    idx = table->index(idObject);
     node = table->map[idx];
 
     while(node) {
@@ -230,11 +325,15 @@ void MapObject::detach(void)
         node = prev->nextObject;
     }
 
+    // our own link is kept, so that lookups passing us still find their
+    // way, and they are waited for before we may be reused...
     if(node && !prev)
-        table->map[idx] = nextObject;
+        map_put(&table->map[idx], nextObject);
     else if(node)
-        prev->nextObject = nextObject;
+        map_put(&prev->nextObject, nextObject);
     table->count--;
+    if(table->concurrent)
+        table->readers.synchronize();
     table->leaveMutex();
     table = NULL;
 }
@@ -134,6 +134,9 @@ void Socket::setSocket(void)
 
 void Socket::endSocket(void)
 {
+    if(reader)
+        reader->clear();
+
     if(Socket::state == STREAM) {
         state = INITIAL;
         if(so != INVALID_SOCKET) {
@@ -541,59 +544,44 @@ Socket::Error Socket::setNoDelay(bool enable)
 
 ssize_t Socket::readLine(char *str, size_t request, timeout_t timeout)
 {
-    bool crlf = false;
-    bool nl = false;
-    size_t nleft = request - 1; // leave also space for terminator
-    int nstat,c;
+    const char *line;
+    ssize_t nstat;
 
     if(request < 1)
         return 0;
 
     str[0] = 0;
+    if(request < 2)
+        return 0;
 
-    while(nleft && !nl) {
-        if(timeout) {
-            if(!isPending(pendingInput, timeout)) {
-                error(errTimeout,(char *)"Read timeout", 0);
-                return -1;
-            }
-        }
-        nstat = ::recv(so, str, _IOLEN64 nleft, MSG_PEEK);
-        if(nstat <= 0) {
-            error(errInput,(char *)"Could not read from socket", socket_errno);
-            return -1;
-        }
+    if(!reader)
+        reader = new ucommon::LineReader(request > 2048 ? request : 2048);
+    else
+        reader->reserve(request);
 
-        // FIXME: if unique char in buffer is '\r' return "\r"
-        //        if buffer end in \r try to read another char?
-        //        and if timeout ??
-        //        remember last \r
-
-        for(c=0; c < nstat; ++c) {
-            if(str[c] == '\n') {
-                if (c > 0 && str[c-1] == '\r')
-                    crlf = true;
-                ++c;
-                nl = true;
-                break;
-            }
-        }
-        nstat = ::recv(so, str, _IOLEN64 c, 0);
-        // TODO: correct ???
-        if(nstat < 0)
-            break;
+    if(timeout && !reader->pending() && !isPending(pendingInput, timeout)) {
+        error(errTimeout,(char *)"Read timeout", 0);
+        return -1;
+    }
 
-        // adjust ending \r\n in \n
-        if(crlf) {
-            --nstat;
-            str[nstat - 1] = '\n';
-        }
+    // leave also space for terminator
+    nstat = reader->getline(so, &line, request - 1, timeout);
+    if(nstat <= 0) {
+        error(errInput,(char *)"Could not read from socket", socket_errno);
+        return -1;
+    }
 
-        str += nstat;
-        nleft -= nstat;
+    // adjust ending \r\n in \n
+    if(nstat > 1 && line[nstat - 1] == '\n' && line[nstat - 2] == '\r') {
+        memcpy(str, line, nstat - 2);
+        str[nstat - 2] = '\n';
+        --nstat;
     }
-    *str = 0;
-    return (ssize_t)(request - nleft - 1);
+    else
+        memcpy(str, line, nstat);
+
+    str[nstat] = 0;
+    return nstat;
 }
 
 ssize_t Socket::readData(void *Target, size_t Size, char Separator, timeout_t timeout)
@@ -607,13 +595,16 @@ ssize_t Socket::readData(void *Target, size_t Size, char Separator, timeout_t ti
     ssize_t nstat;
 
     if (Separator == 0) {       // Flat-out read for a number of bytes.
-        if (timeout) {
+        if (timeout && !(reader && reader->pending())) {
             if (!isPending (pendingInput, timeout)) {
                 error(errTimeout);
                 return (-1);
             }
         }
-        nstat =::recv (so, (char *)Target, _IOLEN64 Size, 0);
+        if (reader && reader->pending())
+            nstat = reader->read(so, Target, Size);
+        else
+            nstat =::recv (so, (char *)Target, _IOLEN64 Size, 0);
 
         if (nstat < 0) {
             error (errInput);
@@ -624,40 +615,29 @@ ssize_t Socket::readData(void *Target, size_t Size, char Separator, timeout_t ti
     /////////////////////////////////////////////////////////////
     // Otherwise, we have a special char separator to use
     /////////////////////////////////////////////////////////////
-    bool found = false;
-    size_t nleft = Size;
-    int c;
-    char *str = (char *) Target;
+    const char *line;
 
-    memset (str, 0, Size);
+    if(!reader)
+        reader = new ucommon::LineReader(Size > 2048 ? Size : 2048);
+    else
+        reader->reserve(Size);
 
-    while (nleft && !found) {
-        if (timeout) {
-            if (!isPending (pendingInput, timeout)) {
-                error(errTimeout);
-                return (-1);
-            }
-        }
-        nstat =::recv (so, str, _IOLEN64 nleft, MSG_PEEK);
-        if (nstat <= 0) {
-            error (errInput);
+    if (timeout && !reader->pending()) {
+        if (!isPending (pendingInput, timeout)) {
+            error(errTimeout);
             return (-1);
         }
+    }
 
-        for (c = 0; (c < nstat) && !found; ++c) {
-            if (str[c] == Separator)
-                found = true;
-        }
-
-        memset (str, 0, nleft);
-        nstat =::recv (so, str, c, 0);
-        if (nstat < 0)
-            break;
-
-        str += nstat;
-        nleft -= nstat;
+    nstat = reader->getline(so, &line, Size, timeout, Separator);
+    if (nstat <= 0) {
+        error (errInput);
+        return (-1);
     }
-    return (ssize_t)(Size - (ssize_t) nleft);
+
+    memset (Target, 0, Size);
+    memcpy (Target, line, nstat);
+    return nstat;
 }
 
 ssize_t Socket::writeData(const void *Source, size_t Size, timeout_t timeout)
@@ -704,6 +684,9 @@ const char *Socket::getSystemErrorString(void) const
 bool Socket::isPending(Pending pending, timeout_t timeout)
 {
     int status = 0;
+
+    if(pending == pendingInput && reader && reader->pending())
+        return true;
 #ifdef USE_POLL
     struct pollfd pfd;
 
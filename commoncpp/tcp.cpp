@@ -922,6 +922,48 @@ int TCPStream::getSegmentSize(void)
     return mss;
 }
 
+// bulk buffers hold whole segments, as many as fit...
+#define BULK_BUFFER     65536
+
+void TCPStream::bulkBuffering(void)
+{
+    size_t mss = (size_t)getSegmentSize();
+    size_t size, avail = 0;
+    char *input, *output;
+
+    if(mss < 80)
+        mss = 536;
+
+    size = (BULK_BUFFER / mss) * mss;
+    if(size < mss)
+        size = mss;
+
+    if(pbase() && pptr() > pbase())
+        writeStream(pbase(), (size_t)(pptr() - pbase()));
+
+    if(gbuf && gptr() < egptr())
+        avail = (size_t)(egptr() - gptr());
+
+    if(avail > size)
+        size = avail;
+
+    input = new char[size];
+    output = new char[size];
+    if(avail)
+        memcpy(input, gptr(), avail);
+
+    if(gbuf)
+        delete[] gbuf;
+    if(pbuf)
+        delete[] pbuf;
+    gbuf = input;
+    pbuf = output;
+    bufsize = size;
+
+    setg(gbuf, gbuf, gbuf + avail);
+    setp(pbuf, pbuf + size);
+}
+
 void TCPStream::disconnect(void)
 {
     if(Socket::state == AVAILABLE)
@@ -1070,20 +1112,36 @@ int TCPStream::sync(void)
 size_t TCPStream::printf(const char *format, ...)
 {
     va_list args;
-    size_t len;
-    char *buf;
+    size_t space = 0, count;
+    char *buf = NULL;
+    int len;
+
+    if(pbase()) {
+        buf = pptr();
+        space = (size_t)(epptr() - pptr());
+    }
 
     va_start(args, format);
-    overflow(EOF);
-    len = pptr() - pbase();
-    buf = pptr();
-    vsnprintf(buf, len, format, args);
+    len = vsnprintf(buf, space, format, args);
     va_end(args);
-    len = strlen(buf);
-    if(Socket::state == STREAM)
-        return ::write((int)so, buf, _IOLEN64 len);
-    else
-        return writeData(buf, len);
+    if(len < 0)
+        return 0;
+
+    if((size_t)len < space) {
+        pbump(len);
+        overflow(EOF);
+        return (size_t)len;
+    }
+
+    // too large for what is left of the buffer, so sent from its own
+    buf = new char[len + 1];
+    va_start(args, format);
+    vsnprintf(buf, len + 1, format, args);
+    va_end(args);
+    count = (size_t)xsputn(buf, len);
+    delete[] buf;
+    overflow(EOF);
+    return count;
 }
 
 int TCPStream::overflow(int c)
@@ -1145,6 +1203,99 @@ int TCPStream::overflow(int c)
     return c;
 }
 
+ssize_t TCPStream::readStream(char *data, size_t len)
+{
+    ssize_t rlen;
+
+    if(Socket::state == STREAM)
+        rlen = ::read((int)so, data, _IOLEN64 len);
+    else if(timeout && !Socket::isPending(pendingInput, timeout)) {
+        iostream::clear(ios::failbit | rdstate());
+        error(errTimeout,(char *)"Socket read timed out",socket_errno);
+        return -1;
+    }
+    else
+        rlen = readData(data, len);
+    if(rlen < 0) {
+        iostream::clear(ios::failbit | rdstate());
+        error(errInput,(char *)"Could not read from socket",socket_errno);
+    }
+    return rlen;
+}
+
+// a block is written whole, even if the socket takes it in parts...
+size_t TCPStream::writeStream(const char *data, size_t len)
+{
+    size_t count = 0;
+    ssize_t rlen;
+
+    while(count < len) {
+        if(Socket::state == STREAM)
+            rlen = ::write((int)so, data + count, _IOLEN64 (len - count));
+        else
+            rlen = writeData(data + count, len - count);
+        if(rlen < 1) {
+            if(rlen < 0) {
+                iostream::clear(ios::failbit | rdstate());
+                error(errOutput,(char *)"Could not write to socket",socket_errno);
+            }
+            break;
+        }
+        count += (size_t)rlen;
+    }
+    return count;
+}
+
+std::streamsize TCPStream::xsgetn(char *data, std::streamsize size)
+{
+    std::streamsize count = 0;
+    ssize_t rlen;
+
+    if(size < 1)
+        return 0;
+
+    if(bufsize > 1) {
+        if(gptr() && gptr() < egptr()) {
+            count = (std::streamsize)(egptr() - gptr());
+            if(count > size)
+                count = size;
+            memcpy(data, gptr(), (size_t)count);
+            gbump((int)count);
+        }
+
+        // a small remainder is better read ahead into the buffer
+        if(size - count < (std::streamsize)bufsize)
+            return count + std::streambuf::xsgetn(data + count, size - count);
+    }
+
+    while(count < size) {
+        rlen = readStream(data + count, (size_t)(size - count));
+        if(rlen < 1)
+            break;
+        count += rlen;
+    }
+    return count;
+}
+
+std::streamsize TCPStream::xsputn(const char *data, std::streamsize size)
+{
+    size_t pending;
+
+    if(size < 1)
+        return 0;
+
+    if(bufsize > 1 && size < (std::streamsize)bufsize)
+        return std::streambuf::xsputn(data, size);
+
+    if(pbase() && pptr() > pbase()) {
+        pending = (size_t)(pptr() - pbase());
+        if(writeStream(pbase(), pending) < pending)
+            return 0;
+        setp(pbuf, pbuf + bufsize);
+    }
+    return (std::streamsize)writeStream(data, (size_t)size);
+}
+
 TCPSession::TCPSession(const IPV4Host &ia, tpport_t port, size_t size, int pri, size_t stack) :
 Thread(pri, stack), TCPStream(IPV4)
 {
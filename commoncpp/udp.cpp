@@ -300,6 +300,19 @@ ssize_t UDPSocket::receive(void *buf, size_t len, bool reply)
     return _IORET64 bytes;
 }
 
+unsigned UDPSocket::send(ucommon::DatagramBatch& batch)
+{
+    if(isConnected())
+        return batch.send(so);
+
+    return batch.send(so, 0, peer);
+}
+
+unsigned UDPSocket::receive(ucommon::DatagramBatch& batch)
+{
+    return batch.receive(so);
+}
+
 Socket::Error UDPSocket::join(const IPV4Multicast &ia,int InterfaceIndex)
 {
     return join(Socket::address(getaddress(ia)), InterfaceIndex);
@@ -32,8 +32,139 @@ atomic::spinlock::spinlock()
     value = 0;
 }
 
+atomic::epoch::epoch()
+{
+    current = 0;
+    readers[0] = readers[1] = 0;
+}
+
+unsigned atomic::epoch::enter(void)
+{
+    unsigned reader;
+
+    // if the epoch flipped before we registered, the writer may not
+    // have waited for us, so register again under the new one...
+    for(;;) {
+        reader = (unsigned)(load(&current) & 1);
+        add(&readers[reader], 1);
+        if((unsigned)(load(&current) & 1) == reader)
+            return reader;
+        add(&readers[reader], -1);
+    }
+}
+
+void atomic::epoch::leave(unsigned reader)
+{
+    add(&readers[reader], -1);
+}
+
+void atomic::epoch::synchronize(void)
+{
+    unsigned reader = (unsigned)(load(&current) & 1);
+
+    add(&current, 1);
+    while(load(&readers[reader]))
+        Thread::yield();
+}
+
 #ifdef HAVE_GCC_ATOMICS
 
+#if defined(__ATOMIC_ACQUIRE)
+long atomic::load(const volatile long *ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+void *atomic::load(void *const volatile *ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+size_t atomic::load(const volatile size_t *ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+void atomic::store(volatile long *ptr, long value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+void atomic::store(void *volatile *ptr, void *value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+void atomic::store(volatile size_t *ptr, size_t value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+void atomic::fence(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+#else
+long atomic::load(const volatile long *ptr)
+{
+    long value = *ptr;
+    __sync_synchronize();
+    return value;
+}
+
+void *atomic::load(void *const volatile *ptr)
+{
+    void *value = *ptr;
+    __sync_synchronize();
+    return value;
+}
+
+size_t atomic::load(const volatile size_t *ptr)
+{
+    size_t value = *ptr;
+    __sync_synchronize();
+    return value;
+}
+
+void atomic::store(volatile long *ptr, long value)
+{
+    __sync_synchronize();
+    *ptr = value;
+}
+
+void atomic::store(void *volatile *ptr, void *value)
+{
+    __sync_synchronize();
+    *ptr = value;
+}
+
+void atomic::store(volatile size_t *ptr, size_t value)
+{
+    __sync_synchronize();
+    *ptr = value;
+}
+
+void atomic::fence(void)
+{
+    __sync_synchronize();
+}
+#endif
+
+long atomic::add(volatile long *ptr, long value)
+{
+    return __sync_add_and_fetch(ptr, value);
+}
+
+bool atomic::cas(volatile long *ptr, long expected, long value)
+{
+    return __sync_bool_compare_and_swap(ptr, expected, value);
+}
+
+bool atomic::cas(volatile size_t *ptr, size_t expected, size_t value)
+{
+    return __sync_bool_compare_and_swap(ptr, expected, value);
+}
+
 long atomic::counter::operator++()
 {
     return __sync_add_and_fetch(&value, 1);
@@ -69,6 +200,92 @@ void atomic::spinlock::release(void)
 
 #define SIMULATED true
 
+long atomic::load(const volatile long *ptr)
+{
+    long value;
+    Mutex::protect((const void *)ptr);
+    value = *ptr;
+    Mutex::release((const void *)ptr);
+    return value;
+}
+
+void *atomic::load(void *const volatile *ptr)
+{
+    void *value;
+    Mutex::protect((const void *)ptr);
+    value = *ptr;
+    Mutex::release((const void *)ptr);
+    return value;
+}
+
+size_t atomic::load(const volatile size_t *ptr)
+{
+    size_t value;
+    Mutex::protect((const void *)ptr);
+    value = *ptr;
+    Mutex::release((const void *)ptr);
+    return value;
+}
+
+void atomic::store(volatile long *ptr, long value)
+{
+    Mutex::protect((const void *)ptr);
+    *ptr = value;
+    Mutex::release((const void *)ptr);
+}
+
+void atomic::store(void *volatile *ptr, void *value)
+{
+    Mutex::protect((const void *)ptr);
+    *ptr = value;
+    Mutex::release((const void *)ptr);
+}
+
+void atomic::store(volatile size_t *ptr, size_t value)
+{
+    Mutex::protect((const void *)ptr);
+    *ptr = value;
+    Mutex::release((const void *)ptr);
+}
+
+long atomic::add(volatile long *ptr, long value)
+{
+    long rval;
+    Mutex::protect((const void *)ptr);
+    rval = (*ptr += value);
+    Mutex::release((const void *)ptr);
+    return rval;
+}
+
+bool atomic::cas(volatile long *ptr, long expected, long value)
+{
+    bool rtn = false;
+    Mutex::protect((const void *)ptr);
+    if(*ptr == expected) {
+        *ptr = value;
+        rtn = true;
+    }
+    Mutex::release((const void *)ptr);
+    return rtn;
+}
+
+bool atomic::cas(volatile size_t *ptr, size_t expected, size_t value)
+{
+    bool rtn = false;
+    Mutex::protect((const void *)ptr);
+    if(*ptr == expected) {
+        *ptr = value;
+        rtn = true;
+    }
+    Mutex::release((const void *)ptr);
+    return rtn;
+}
+
+// values are only shared under their own locks, which already order them
+void atomic::fence(void)
+{
+}
+
 long atomic::counter::operator++()
 {
     long rval;
@@ -21,6 +21,7 @@
 #include <ucommon/object.h>
 #include <ucommon/memory.h>
 #include <ucommon/thread.h>
+#include <ucommon/atomic.h>
 #include <ucommon/containers.h>
 #include <string.h>
 
@@ -278,7 +279,7 @@ bool Buffer::put(void *dbuf, timeout_t timeout)
         memcpy(tail, dbuf, objsize);
         tail += objsize;
         if(tail >= (buf + bufsize))
-            tail = 0;
+            tail = buf;
         ++objcount;
         signal();
     }
@@ -308,6 +309,246 @@ bool Buffer::operator!() const
     return rtn;
 }
 
+// each ring slot is a sequence number followed by the object data, and
+// the sequence tells us if the slot is ready for a producer or consumer.
+
+#define RING_SEQUENCE(slot) (*((volatile size_t *)(slot)))
+#define RING_DATA(slot) ((caddr_t)(slot) + RING_ALIGN)
+#define RING_ALIGN (sizeof(size_t) * 2)
+#define RING_SPINS 16
+
+Ring::Ring(size_t osize, size_t c) :
+Conditional()
+{
+    assert(osize > 0 && c > 0);
+
+    size_t limit = 1;
+
+    while(limit < c)
+        limit <<= 1;
+
+    objsize = osize;
+    slotsize = (RING_ALIGN + osize + RING_ALIGN - 1) & ~(RING_ALIGN - 1);
+    mask = limit - 1;
+    head = tail = 0;
+    waiting = 0;
+
+    slots = (caddr_t)malloc(slotsize * limit);
+    crit(slots != NULL, "ring alloc failed");
+
+    for(size_t pos = 0; pos < limit; ++pos)
+        RING_SEQUENCE(slots + pos * slotsize) = pos;
+}
+
+Ring::~Ring()
+{
+    if(slots)
+        free(slots);
+    slots = NULL;
+}
+
+unsigned Ring::size(void) const
+{
+    return (unsigned)(mask + 1);
+}
+
+unsigned Ring::count(void) const
+{
+    size_t first = tail;
+    size_t last = head;
+
+    if(last - first > mask + 1)
+        return 0;
+    return (unsigned)(last - first);
+}
+
+#ifdef  HAVE_GCC_ATOMICS
+
+bool Ring::push(const void *data)
+{
+    size_t pos = atomic::load(&head);
+    caddr_t slot;
+    ssize_t diff;
+
+    for(;;) {
+        slot = slots + (pos & mask) * slotsize;
+        diff = (ssize_t)(atomic::load(&RING_SEQUENCE(slot)) - pos);
+        if(diff == 0) {
+            if(atomic::cas(&head, pos, pos + 1))
+                break;
+            pos = atomic::load(&head);
+        }
+        else if(diff < 0)
+            return false;
+        else
+            pos = atomic::load(&head);
+    }
+
+    memcpy(RING_DATA(slot), data, objsize);
+    atomic::store(&RING_SEQUENCE(slot), pos + 1);
+    return true;
+}
+
+bool Ring::pull(void *data)
+{
+    size_t pos = atomic::load(&tail);
+    caddr_t slot;
+    ssize_t diff;
+
+    for(;;) {
+        slot = slots + (pos & mask) * slotsize;
+        diff = (ssize_t)(atomic::load(&RING_SEQUENCE(slot)) - (pos + 1));
+        if(diff == 0) {
+            if(atomic::cas(&tail, pos, pos + 1))
+                break;
+            pos = atomic::load(&tail);
+        }
+        else if(diff < 0)
+            return false;
+        else
+            pos = atomic::load(&tail);
+    }
+
+    memcpy(data, RING_DATA(slot), objsize);
+    atomic::store(&RING_SEQUENCE(slot), pos + mask + 1);
+    return true;
+}
+
+#else
+
+bool Ring::push(const void *data)
+{
+    caddr_t slot = slots + (head & mask) * slotsize;
+
+    if(RING_SEQUENCE(slot) != head)
+        return false;
+
+    memcpy(RING_DATA(slot), data, objsize);
+    RING_SEQUENCE(slot) = ++head;
+    return true;
+}
+
+bool Ring::pull(void *data)
+{
+    caddr_t slot = slots + (tail & mask) * slotsize;
+
+    if(RING_SEQUENCE(slot) != tail + 1)
+        return false;
+
+    memcpy(data, RING_DATA(slot), objsize);
+    RING_SEQUENCE(slot) = tail + mask + 1;
+    ++tail;
+    return true;
+}
+
+#endif
+
+void Ring::wakeup(void)
+{
+    // the slot is published by a release store after the compare and
+    // swap, and a later load of waiting may pass it.  A full barrier keeps
+    // a waiter that registered before we published from being missed...
+    atomic::fence();
+    if(!waiting)
+        return;
+
+    lock();
+    broadcast();
+    unlock();
+}
+
+void Ring::put(const void *data)
+{
+    put(data, Timer::inf);
+}
+
+bool Ring::put(const void *data, timeout_t timeout)
+{
+    assert(data != NULL);
+
+    struct timespec ts;
+    bool rtn = true;
+
+#ifdef  HAVE_GCC_ATOMICS
+    // briefly yield on the full/empty edge before sleeping...
+    for(unsigned spin = 0; spin < RING_SPINS; ++spin) {
+        if(push(data)) {
+            wakeup();
+            return true;
+        }
+        if(!timeout)
+            return false;
+        Thread::yield();
+    }
+#endif
+
+    if(timeout && timeout != Timer::inf)
+        set(&ts, timeout);
+
+    lock();
+    ++waiting;
+    atomic::fence();
+    while(!push(data)) {
+        if(timeout == Timer::inf)
+            wait();
+        else if(!timeout || !wait(&ts)) {
+            rtn = false;
+            break;
+        }
+    }
+    --waiting;
+    if(rtn && waiting)
+        broadcast();
+    unlock();
+    return rtn;
+}
+
+void Ring::get(void *data)
+{
+    get(data, Timer::inf);
+}
+
+bool Ring::get(void *data, timeout_t timeout)
+{
+    assert(data != NULL);
+
+    struct timespec ts;
+    bool rtn = true;
+
+#ifdef  HAVE_GCC_ATOMICS
+    // briefly yield on the full/empty edge before sleeping...
+    for(unsigned spin = 0; spin < RING_SPINS; ++spin) {
+        if(pull(data)) {
+            wakeup();
+            return true;
+        }
+        if(!timeout)
+            return false;
+        Thread::yield();
+    }
+#endif
+
+    if(timeout && timeout != Timer::inf)
+        set(&ts, timeout);
+
+    lock();
+    ++waiting;
+    atomic::fence();
+    while(!pull(data)) {
+        if(timeout == Timer::inf)
+            wait();
+        else if(!timeout || !wait(&ts)) {
+            rtn = false;
+            break;
+        }
+    }
+    --waiting;
+    if(rtn && waiting)
+        broadcast();
+    unlock();
+    return rtn;
+}
+
 Queue::member::member(Queue *q, ObjectProtocol *o) :
 OrderedObject(q)
 {
@@ -0,0 +1,547 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <ucommon-config.h>
+#include <ucommon/export.h>
+#include <ucommon/atomic.h>
+#include <ucommon/executor.h>
+#ifdef  HAVE_SCHED_SETAFFINITY
+#include <sched.h>
+#endif
+
+namespace ucommon {
+
+#define EXECUTOR_DEQUE  1024    // tasks a worker queues before sharing them
+#define EXECUTOR_SPINS  64      // rounds a worker looks for work before sleep
+
+// the deques are lock-free when atomics are available.  Without them each
+// deque is guarded by a mutex.
+#ifdef  HAVE_GCC_ATOMICS
+#define EXECUTOR_ATOMICS
+#endif
+
+// A Chase-Lev work stealing deque of fixed size.  Only the owning worker
+// pushes and takes at the bottom, while any other worker may steal from
+// the top.  A full deque refuses the push, and the task is then shared
+// through the executor's queue instead.
+class __LOCAL deque
+{
+private:
+    Executor::task *volatile ring[EXECUTOR_DEQUE];
+    volatile long top, bottom;
+#ifndef EXECUTOR_ATOMICS
+    Mutex lock;
+#endif
+
+public:
+    deque();
+
+    bool push(Executor::task *task);
+    Executor::task *take(void);
+    Executor::task *steal(void);
+
+    inline bool is_empty(void)
+        {return atomic::load(&bottom) <= atomic::load(&top);}
+};
+
+deque::deque()
+{
+    top = bottom = 0;
+}
+
+#ifdef  EXECUTOR_ATOMICS
+
+bool deque::push(Executor::task *task)
+{
+    long b = bottom;
+
+    if(b - atomic::load(&top) >= EXECUTOR_DEQUE)
+        return false;
+
+    ring[b & (EXECUTOR_DEQUE - 1)] = task;
+    atomic::store(&bottom, b + 1);
+    return true;
+}
+
+Executor::task *deque::take(void)
+{
+    long b = bottom - 1, t;
+    Executor::task *task;
+
+    bottom = b;
+    atomic::fence();
+    t = atomic::load(&top);
+    if(t > b) {
+        bottom = b + 1;
+        return NULL;
+    }
+
+    task = ring[b & (EXECUTOR_DEQUE - 1)];
+    if(t == b) {
+        // last entry, so race thieves for it...
+        if(!atomic::cas(&top, t, t + 1))
+            task = NULL;
+        bottom = b + 1;
+    }
+    return task;
+}
+
+Executor::task *deque::steal(void)
+{
+    long t = atomic::load(&top), b;
+    Executor::task *task;
+
+    atomic::fence();
+    b = atomic::load(&bottom);
+    if(t >= b)
+        return NULL;
+
+    task = ring[t & (EXECUTOR_DEQUE - 1)];
+    if(!atomic::cas(&top, t, t + 1))
+        return NULL;
+
+    return task;
+}
+
+#else
+
+bool deque::push(Executor::task *task)
+{
+    lock.acquire();
+    if(bottom - top >= EXECUTOR_DEQUE) {
+        lock.release();
+        return false;
+    }
+    ring[bottom++ & (EXECUTOR_DEQUE - 1)] = task;
+    lock.release();
+    return true;
+}
+
+Executor::task *deque::take(void)
+{
+    Executor::task *task = NULL;
+
+    lock.acquire();
+    if(bottom > top)
+        task = ring[--bottom & (EXECUTOR_DEQUE - 1)];
+    lock.release();
+    return task;
+}
+
+Executor::task *deque::steal(void)
+{
+    Executor::task *task = NULL;
+
+    lock.acquire();
+    if(bottom > top)
+        task = ring[top++ & (EXECUTOR_DEQUE - 1)];
+    lock.release();
+    return task;
+}
+
+#endif
+
+class __LOCAL Executor::worker : public JoinableThread
+{
+public:
+    Executor *owner;
+    deque local;
+    unsigned id;
+    unsigned seed;
+
+    worker(Executor *executor, unsigned index, size_t size);
+
+    void run(void);
+    void bind(void);
+    task *find(void);
+    void execute(task *task);
+
+    inline void finish(void)
+        {join();}
+};
+
+Executor::worker::worker(Executor *executor, unsigned index, size_t size) :
+JoinableThread(size)
+{
+    owner = executor;
+    id = index;
+    seed = index * 2654435761u + 1;
+}
+
+void Executor::worker::bind(void)
+{
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(CPU_SET) && defined(CPU_COUNT)
+    cpu_set_t allowed, mask;
+    int cpu, count;
+
+    // pick among the cpus the process may run on, in order of worker id
+    if(sched_getaffinity(0, sizeof(allowed), &allowed))
+        return;
+
+    count = CPU_COUNT(&allowed);
+    if(count < 1)
+        return;
+
+    count = (int)(id % (unsigned)count);
+    for(cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if(!CPU_ISSET(cpu, &allowed))
+            continue;
+        if(count-- == 0)
+            break;
+    }
+
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    sched_setaffinity(0, sizeof(mask), &mask);
+#endif
+}
+
+Executor::task *Executor::worker::find(void)
+{
+    task *task = local.take();
+    unsigned pos, victim;
+
+    if(task)
+        return task;
+
+    task = owner->dequeue();
+    if(task || owner->threads < 2)
+        return task;
+
+    // start stealing from a random victim so thieves spread out...
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    victim = seed % owner->threads;
+    for(pos = 0; pos < owner->threads; ++pos) {
+        worker *from = owner->workers[(victim + pos) % owner->threads];
+        if(from == this)
+            continue;
+        task = from->local.steal();
+        if(task)
+            return task;
+    }
+    return NULL;
+}
+
+void Executor::worker::execute(task *task)
+{
+    task->run();
+
+    // the task may be deleted by its joiner once it is no longer pending
+    atomic::store(&task->state, 0);
+    owner->completed();
+}
+
+void Executor::worker::run(void)
+{
+    task *task;
+    unsigned spins = 0;
+
+    map();
+    if(owner->binding)
+        bind();
+
+    for(;;) {
+        task = find();
+        if(task) {
+            execute(task);
+            spins = 0;
+            continue;
+        }
+        if(!owner->running)
+            break;
+        if(++spins < EXECUTOR_SPINS) {
+            Thread::yield();
+            continue;
+        }
+        spins = 0;
+        owner->idle();
+    }
+}
+
+Executor::task::task()
+{
+    owner = NULL;
+    next = NULL;
+    state = 0;
+}
+
+Executor::task::~task()
+{
+}
+
+bool Executor::task::is_pending(void) const
+{
+    return atomic::load(&state) != 0;
+}
+
+void Executor::task::join(void)
+{
+    worker *self;
+    task *task;
+
+    if(!is_pending())
+        return;
+
+    self = owner->current();
+    if(!self) {
+        owner->await(this, Timer::inf);
+        return;
+    }
+
+    // a worker runs other tasks until the one it joins completes...
+    while(is_pending()) {
+        task = self->find();
+        if(task)
+            self->execute(task);
+        else
+            Thread::yield();
+    }
+}
+
+bool Executor::task::join(timeout_t timeout)
+{
+    if(!is_pending())
+        return true;
+
+    return owner->await(this, timeout);
+}
+
+Executor::Executor(unsigned count, bool affinity, size_t stack) :
+Conditional()
+{
+    if(!count)
+        count = cpus();
+
+    threads = count;
+    binding = affinity;
+    running = false;
+    sleeping = joining = 0;
+    first = last = NULL;
+    workers = new worker*[count];
+    for(unsigned pos = 0; pos < count; ++pos)
+        workers[pos] = new worker(this, pos, stack);
+}
+
+Executor::~Executor()
+{
+    // tasks still pending are run before the workers go away
+    if(pending())
+        start();
+
+    stop();
+
+    for(unsigned pos = 0; pos < threads; ++pos)
+        delete workers[pos];
+
+    delete[] workers;
+    workers = NULL;
+}
+
+unsigned Executor::cpus(void)
+{
+#if defined(_MSWINDOWS_)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    if(info.dwNumberOfProcessors > 0)
+        return (unsigned)info.dwNumberOfProcessors;
+#elif defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if(count > 0)
+        return (unsigned)count;
+#endif
+    return 1;
+}
+
+void Executor::start(int priority)
+{
+    lock();
+    if(running) {
+        unlock();
+        return;
+    }
+    running = true;
+    unlock();
+
+    for(unsigned pos = 0; pos < threads; ++pos)
+        workers[pos]->start(priority);
+}
+
+void Executor::stop(void)
+{
+    lock();
+    running = false;
+    broadcast();
+    unlock();
+
+    for(unsigned pos = 0; pos < threads; ++pos)
+        workers[pos]->finish();
+}
+
+Executor::worker *Executor::current(void)
+{
+    Thread *thread = Thread::get();
+
+    if(!thread)
+        return NULL;
+
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        if(thread == static_cast<Thread *>(workers[pos]))
+            return workers[pos];
+    }
+    return NULL;
+}
+
+bool Executor::submit(task *task)
+{
+    worker *self;
+
+    if(!task || task->is_pending())
+        return false;
+
+    task->owner = this;
+    task->next = NULL;
+    task->state = 1;
+    ++outstanding;
+
+    // a task's own sub-tasks stay with its worker until stolen...
+    self = current();
+    if(self && self->local.push(task)) {
+        wakeup();
+        return true;
+    }
+
+    lock();
+    if(last)
+        last->next = task;
+    else
+        first = task;
+    last = task;
+    if(joining)
+        broadcast();
+    else if(sleeping)
+        signal();
+    unlock();
+    return true;
+}
+
+Executor::task *Executor::dequeue(void)
+{
+    task *task;
+
+    if(!first)
+        return NULL;
+
+    lock();
+    task = first;
+    if(task) {
+        first = task->next;
+        if(!first)
+            last = NULL;
+    }
+    unlock();
+    return task;
+}
+
+bool Executor::available(void)
+{
+    if(first)
+        return true;
+
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        if(!workers[pos]->local.is_empty())
+            return true;
+    }
+    return false;
+}
+
+void Executor::idle(void)
+{
+    lock();
+    ++sleeping;
+    // pairs with the fence in wakeup, so a push made before we looked is
+    // either seen here, or the pusher sees us sleeping and signals.
+    atomic::fence();
+    if(running && !available())
+        Conditional::wait();
+    --sleeping;
+    unlock();
+}
+
+void Executor::wakeup(void)
+{
+#ifdef  EXECUTOR_ATOMICS
+    atomic::fence();
+    if(!sleeping)
+        return;
+#endif
+
+    lock();
+    // joiners share the conditional, so they must not absorb the signal
+    if(joining)
+        broadcast();
+    else if(sleeping)
+        signal();
+    unlock();
+}
+
+void Executor::completed(void)
+{
+    --outstanding;
+
+#ifdef  EXECUTOR_ATOMICS
+    atomic::fence();
+    if(!joining)
+        return;
+#endif
+
+    lock();
+    if(joining)
+        broadcast();
+    unlock();
+}
+
+bool Executor::await(task *task, timeout_t timeout)
+{
+    struct timespec ts;
+    bool result = true;
+
+    if(timeout != Timer::inf)
+        Conditional::set(&ts, timeout);
+
+    lock();
+    ++joining;
+    atomic::fence();
+    while(result && (task ? task->is_pending() : pending() != 0)) {
+        if(timeout == Timer::inf)
+            Conditional::wait();
+        else
+            result = Conditional::wait(&ts);
+    }
+    result = task ? !task->is_pending() : pending() == 0;
+    --joining;
+    unlock();
+    return result;
+}
+
+void Executor::wait(void)
+{
+    await(NULL, Timer::inf);
+}
+
+} // namespace ucommon
@@ -22,9 +22,37 @@
 #include <ucommon/keydata.h>
 #include <ucommon/string.h>
 #include <ctype.h>
+#include <stdlib.h>
+#ifdef  HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#define KEY_BUCKETS 8
 
 namespace ucommon {
 
+// the text of a loaded config file, which keys and values point into...
+class __LOCAL keyfile::text
+{
+public:
+    text *next;
+    caddr_t data;
+    size_t size;
+};
+
+// an index is grown four fold when chains average two entries, for as
+// long as the index fits in half a page...
+static unsigned keygrow(unsigned buckets, unsigned count, size_t pagesize)
+{
+    if(!buckets)
+        return KEY_BUCKETS;
+
+    if(count < buckets * 2 || buckets * 4 * sizeof(void *) > pagesize / 2)
+        return 0;
+
+    return buckets * 4;
+}
+
 keydata::keyvalue::keyvalue(keyfile *allocator, keydata *section, const char *kv, const char *dv) :
 OrderedObject(&section->index)
 {
@@ -33,6 +61,7 @@ OrderedObject(&section->index)
     assert(kv != NULL);
 
     id = allocator->dup(kv);
+    chain = NULL;
 
     if(dv)
         value = allocator->dup(dv);
@@ -40,6 +69,21 @@ OrderedObject(&section->index)
         value = "";
 }
 
+keydata::keyvalue::keyvalue(keydata *section, const char *kv, const char *dv) :
+OrderedObject(&section->index)
+{
+    assert(section != NULL);
+    assert(kv != NULL);
+
+    id = kv;
+    chain = NULL;
+
+    if(dv)
+        value = dv;
+    else
+        value = "";
+}
+
 keydata::keydata(keyfile *file, const char *id) :
 OrderedObject(&file->index), index()
 {
@@ -48,6 +92,9 @@ OrderedObject(&file->index), index()
 
     name = file->dup(id);
     root = file;
+    chain = NULL;
+    hash = NULL;
+    buckets = count = 0;
 }
 
 keydata::keydata(keyfile *file) :
@@ -55,60 +102,105 @@ OrderedObject(), index()
 {
     root = file;
     name = "-";
+    chain = NULL;
+    hash = NULL;
+    buckets = count = 0;
 }
 
-const char *keydata::get(const char *key) const
+void keydata::insert(keyvalue *kv)
 {
-    assert(key != NULL);
+    unsigned size = keygrow(buckets, count, root->size());
+    unsigned path;
+
+    ++count;
+    if(!size) {
+        path = String::hash_case(kv->id) % buckets;
+        kv->chain = hash[path];
+        hash[path] = kv;
+        return;
+    }
 
-    iterator keys = begin();
+    // the new key is already in our index, and is hashed with the rest
+    hash = (keyvalue **)root->alloc(sizeof(keyvalue *) * size);
+    memset(hash, 0, sizeof(keyvalue *) * size);
+    buckets = size;
 
+    iterator keys = begin();
     while(is(keys)) {
-        if(eq_case(key, keys->id))
-            return keys->value;
+        path = String::hash_case(keys->id) % buckets;
+        keys->chain = hash[path];
+        hash[path] = *keys;
         keys.next();
     }
-    return NULL;
 }
 
-void keydata::clear(const char *key)
+void keydata::remove(const char *key)
 {
-    assert(key != NULL);
+    if(!hash)
+        return;
 
-    iterator keys = begin();
+    keyvalue **prior = &hash[String::hash_case(key) % buckets];
 
-    while(is(keys)) {
-        if(eq_case(key, keys->id)) {
-            keys->delist(&index);
+    while(*prior) {
+        keyvalue *kv = *prior;
+        if(eq_case(key, kv->id)) {
+            *prior = kv->chain;
+            kv->delist(&index);
+            --count;
             return;
         }
-        keys.next();
+        prior = &kv->chain;
     }
 }
 
-void keydata::set(const char *key, const char *value)
+const char *keydata::get(const char *key) const
 {
     assert(key != NULL);
 
-    caddr_t mem = (caddr_t)root->alloc(sizeof(keydata::keyvalue));
-    keydata::iterator keys = begin();
+    if(!hash)
+        return NULL;
 
-    while(is(keys)) {
-        if(eq_case(key, keys->id)) {
-            keys->delist(&index);
-            break;
-        }
-        keys.next();
+    keyvalue *kv = hash[String::hash_case(key) % buckets];
+
+    while(kv) {
+        if(eq_case(key, kv->id))
+            return kv->value;
+        kv = kv->chain;
     }
-    new(mem) keydata::keyvalue(root, this, key, value);
+    return NULL;
+}
+
+void keydata::clear(const char *key)
+{
+    assert(key != NULL);
+
+    remove(key);
 }
 
+void keydata::set(const char *key, const char *value)
+{
+    assert(key != NULL);
+
+    caddr_t mem = (caddr_t)root->alloc(sizeof(keydata::keyvalue));
+    remove(key);
+    insert(new(mem) keydata::keyvalue(root, this, key, value));
+}
+
+void keydata::assign(const char *key, const char *value)
+{
+    caddr_t mem = (caddr_t)root->alloc(sizeof(keydata::keyvalue));
+    remove(key);
+    insert(new(mem) keydata::keyvalue(this, key, value));
+}
 
 keyfile::keyfile(size_t pagesize) :
 memalloc(pagesize), index()
 {
     errcode = 0;
     defaults = NULL;
+    hash = NULL;
+    buckets = count = 0;
+    texts = NULL;
 }
 
 keyfile::keyfile(const char *path, size_t pagesize) :
@@ -116,6 +208,9 @@ memalloc(pagesize), index()
 {
     errcode = 0;
     defaults = NULL;
+    hash = NULL;
+    buckets = count = 0;
+    texts = NULL;
     load(path);
 }
 
@@ -124,27 +219,86 @@ memalloc(pagesize), index()
 {
     errcode = 0;
     defaults = NULL;
+    hash = NULL;
+    buckets = count = 0;
+    texts = NULL;
     load(&copy);
 }
 
+keyfile::~keyfile()
+{
+    release();
+}
+
 void keyfile::release(void)
 {
+    while(texts) {
+        ::free(texts->data);
+        texts = texts->next;
+    }
+
     defaults = NULL;
+    hash = NULL;
+    buckets = count = 0;
     index.reset();
     memalloc::purge();
 }
 
-keydata *keyfile::get(const char *key) const
+void keyfile::insert(keydata *section)
 {
-    assert(key != NULL);
+    unsigned size = keygrow(buckets, count, memalloc::size());
+    unsigned path;
+
+    ++count;
+    if(!size) {
+        path = String::hash_case(section->name) % buckets;
+        section->chain = hash[path];
+        hash[path] = section;
+        return;
+    }
 
-    iterator keys = begin();
+    hash = (keydata **)alloc(sizeof(keydata *) * size);
+    memset(hash, 0, sizeof(keydata *) * size);
+    buckets = size;
 
+    iterator keys = begin();
     while(is(keys)) {
-        if(eq_case(key, keys->name))
-            return *keys;
+        path = String::hash_case(keys->name) % buckets;
+        keys->chain = hash[path];
+        hash[path] = *keys;
         keys.next();
     }
+}
+
+void keyfile::remove(keydata *section)
+{
+    keydata **prior = &hash[String::hash_case(section->name) % buckets];
+
+    while(*prior) {
+        if(*prior == section) {
+            *prior = section->chain;
+            section->delist(&index);
+            --count;
+            return;
+        }
+        prior = &((*prior)->chain);
+    }
+}
+
+keydata *keyfile::get(const char *key) const
+{
+    assert(key != NULL);
+
+    if(!hash)
+        return NULL;
+
+    keydata *section = hash[String::hash_case(key) % buckets];
+
+    while(section) {
+        if(eq_case(key, section->name))
+            return section;
+        section = section->chain;
+    }
     return NULL;
 }
 
@@ -156,9 +310,11 @@ keydata *keyfile::create(const char *id)
     keydata *old = get(id);
 
     if(old)
-        old->delist(&index);
+        remove(old);
 
-    return new(mem) keydata(this, id);
+    keydata *section = new(mem) keydata(this, id);
+    insert(section);
+    return section;
 }
 
 #ifdef _MSWINDOWS_
@@ -360,67 +516,111 @@ void keyfile::load(const char *path)
     }
 #endif
 
-    char linebuf[1024];
-    char *lp = linebuf;
-    char *ep;
-    unsigned size = sizeof(linebuf);
+    size_t max = 4096, size = 0, len;
+    caddr_t data;
     FILE *fp = fopen(path, "r");
-    keydata *section = NULL;
-    const char *key;
-    char *value;
 
     errcode = 0;
-
     if(!fp) {
         errcode = EBADF;
         return;
     }
 
+    // the whole file is read into one buffer that is parsed in place.  A
+    // map of the file is not used, since a config file that is rewritten
+    // in place while it is mapped would fault readers of older snapshots.
+#ifdef  HAVE_SYS_STAT_H
+    struct stat ino;
+    if(!fstat(fileno(fp), &ino) && ino.st_size > 0)
+        max = (size_t)ino.st_size + 2;
+#endif
+
+    data = (caddr_t)::malloc(max);
+    while(data && (len = fread(data + size, 1, max - size - 1, fp)) > 0) {
+        size += len;
+        if(size + 1 < max)
+            continue;
+        max *= 2;
+        caddr_t more = (caddr_t)::realloc(data, max);
+        if(!more)
+            ::free(data);
+        data = more;
+    }
+    errcode = ferror(fp);
+    fclose(fp);
+    if(!data) {
+        errcode = ENOMEM;
+        return;
+    }
+    data[size] = 0;
+
     if(!defaults) {
         caddr_t mem = (caddr_t)alloc(sizeof(keydata));
         defaults = new(mem) keydata(this);
     }
 
-    for(;;) {
-        *lp = 0;
-        if(NULL == fgets(lp, size, fp)) {
-            errcode = ferror(fp);
-            lp[0] = 0;
-        }
-        else
-            String::chop(lp, "\r\n\t ");
-        ep = lp + strlen(lp);
-        if(ep != lp) {
-            --ep;
-            if(*ep == '\\') {
-                lp = ep;
-                size = (linebuf + sizeof(linebuf) - ep);
-                continue;
+    text *node = (text *)alloc(sizeof(text));
+    node->data = data;
+    node->size = size;
+    node->next = texts;
+    texts = node;
+
+    parse(data, size);
+}
+
+// lines are parsed in place, with continued lines joined over the line
+// ends, so that keys and values are left terminated in the text...
+void keyfile::parse(char *data, size_t size)
+{
+    char *cp = data, *end = data + size;
+    char *lp, *ep, *le, *wp;
+    keydata *section = NULL;
+    const char *key;
+    char *value;
+
+    while(cp < end) {
+        lp = cp;
+        wp = NULL;
+        for(;;) {
+            ep = (char *)memchr(cp, '\n', end - cp);
+            le = ep ? ep : end;
+            while(le > cp && (le[-1] == '\r' || le[-1] == '\t' || le[-1] == ' '))
+                --le;
+            if(!wp)
+                wp = le;
+            else if(le > cp) {
+                memmove(wp, cp, le - cp);
+                wp += (le - cp);
+            }
+            cp = ep ? ep + 1 : end;
+            if(wp > lp && wp[-1] == '\\') {
+                --wp;
+                if(cp < end)
+                    continue;
             }
-        }
-        if(!linebuf[0] && feof(fp))
             break;
+        }
+        *wp = 0;
 
-        lp = linebuf;
         while(isspace(*lp))
             ++lp;
 
         if(!*lp)
-            goto next;
+            continue;
 
         if(*lp == '[') {
             ep = strchr(lp, ']');
             if(!ep)
-                goto next;
+                continue;
             *ep = 0;
             lp = String::strip(++lp, " \t");
             section = get(lp);
             if (!section)
                 section = create(lp);
-            goto next;
+            continue;
         }
         else if(!isalnum(*lp) || !strchr(lp, '='))
-            goto next;
+            continue;
 
         ep = strchr(lp, '=');
         *ep = 0;
@@ -428,14 +628,70 @@ void keyfile::load(const char *path)
         value = String::strip(++ep, " \t\r\n");
         value = String::unquote(value, "\"\"\'\'{}()");
         if(section)
-            section->set(key, value);
+            section->assign(key, value);
         else
-            defaults->set(key, value);
-next:
-        lp = linebuf;
-        size = sizeof(linebuf);
+            defaults->assign(key, value);
     }
-    fclose(fp);
+}
+
+keysnapshot::keysnapshot(size_t pagesize) :
+keyfile(pagesize), SharedObject()
+{
+}
+
+keyconfig::keyconfig(const char *path, size_t pagesize) :
+shared_pointer<keysnapshot>(true), filename()
+{
+    paging = pagesize;
+    errcode = 0;
+
+    if(path)
+        load(path);
+}
+
+keyconfig::~keyconfig()
+{
+    replace(NULL);
+}
+
+bool keyconfig::load(const char *path)
+{
+    assert(path != NULL);
+
+    keysnapshot *snapshot = new keysnapshot(paging);
+
+    snapshot->load(path);
+
+    // the file name and error are changed under the same lock that
+    // publishes the snapshot, so concurrent loads stay consistent...
+    modify();
+    errcode = snapshot->err();
+    if(errcode) {
+        commit();
+        delete snapshot;
+        return false;
+    }
+
+    filename = path;
+    update(snapshot);
+    commit();
+    return true;
+}
+
+bool keyconfig::reload(void)
+{
+    String path;
+
+    modify();
+    path = filename;
+    if(!path.len())
+        errcode = EBADF;
+    commit();
+
+    if(!path.len())
+        return false;
+
+    return load(path.c_str());
 }
 
 } // namespace ucommon
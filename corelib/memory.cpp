@@ -137,6 +137,10 @@ memalloc::page_t *memalloc::pager(void)
         npage = (page_t *)addr;
         goto use;
     }
+
+    // mempager finds the page of a freed block from its alignment...
+    if(align == pagesize)
+        goto use;
 #endif
     npage = (page_t *)malloc(pagesize);
 
@@ -184,14 +188,428 @@ void *memalloc::_alloc(size_t size)
     return mem;
 }
 
+// small requests are served from size class slab pages.  A slab page
+// starts with a header whose marker sits where a carved page keeps its
+// used count, so dealloc can tell slab blocks from carved memory.
+
+#if defined(HAVE_POSIX_MEMALIGN)
+#define USE_SLABS
+#endif
+
+#if defined(USE_SLABS) && !defined(_MSTHREADS_) && !defined(__PTH__)
+#define USE_SLAB_CACHE
+#endif
+
+#define SLAB_CLASSES    20
+#define SLAB_MARKER     ((unsigned)(~0))
+#define SLAB_ENTRIES    8
+#define SLAB_BATCH      4096
+
+#ifdef  USE_SLABS
+
+static const unsigned slab_sizes[SLAB_CLASSES] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192,
+    224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+typedef struct slab {
+    struct slab *next;
+    unsigned marker;
+    unsigned index;
+} slab_t;
+
+#define SLAB_HEADER ((sizeof(slab_t) + 15) & ~((size_t)15))
+
+class __LOCAL mempager::depot
+{
+public:
+#ifdef  USE_SLAB_CACHE
+    // per thread cache of free blocks for one pager...
+    typedef struct {
+        depot *owner;
+        unsigned serial;
+        long used;
+        void *freelist[SLAB_CLASSES];
+        unsigned count[SLAB_CLASSES];
+    } cache_t;
+
+    typedef struct local {
+        struct local *next;
+        cache_t entry[SLAB_ENTRIES];
+    } local_t;
+
+    static pthread_key_t key;
+    static pthread_once_t once;
+    static pthread_mutex_t registry;
+    static depot *registered;
+    static local_t *threads;
+    static unsigned serials;
+
+    depot *next;
+#endif
+
+    mempager *pager;
+    unsigned serial;
+    unsigned classes;
+    slab_t *pages;
+    void *freelist[SLAB_CLASSES];
+    unsigned batch[SLAB_CLASSES];
+    long used;
+
+    depot(mempager *owner);
+    ~depot();
+
+    void *get(unsigned index);
+    void put(void *mem, unsigned index);
+    bool grow(unsigned index);
+    void retire(void);
+    void purge(void);
+    long inuse(void);
+
+    inline unsigned lookup(size_t size) const {
+        unsigned index = 0;
+        while(index < classes && slab_sizes[index] < size)
+            ++index;
+        return index;
+    }
+
+#ifdef  USE_SLAB_CACHE
+    cache_t *local(void);
+    void release(cache_t *cache, unsigned index, unsigned count);
+
+    static void setup(void);
+    static void evict(cache_t *cache);
+    static void cleanup(void *data);
+#endif
+};
+
+#ifdef  USE_SLAB_CACHE
+pthread_key_t mempager::depot::key;
+pthread_once_t mempager::depot::once = PTHREAD_ONCE_INIT;
+pthread_mutex_t mempager::depot::registry = PTHREAD_MUTEX_INITIALIZER;
+mempager::depot *mempager::depot::registered = NULL;
+mempager::depot::local_t *mempager::depot::threads = NULL;
+unsigned mempager::depot::serials = 0;
+
+void mempager::depot::setup(void)
+{
+    pthread_key_create(&key, &cleanup);
+}
+
+void mempager::depot::cleanup(void *data)
+{
+    local_t *tls = (local_t *)data;
+    local_t **lp;
+
+    for(unsigned pos = 0; pos < SLAB_ENTRIES; ++pos)
+        evict(&tls->entry[pos]);
+
+    pthread_mutex_lock(&registry);
+    lp = &threads;
+    while(*lp) {
+        if(*lp == tls) {
+            *lp = tls->next;
+            break;
+        }
+        lp = &((*lp)->next);
+    }
+    pthread_mutex_unlock(&registry);
+    free(tls);
+}
+
+void mempager::depot::evict(cache_t *cache)
+{
+    depot *dp;
+
+    if(!cache->owner)
+        return;
+
+    // only hand blocks back if the pager still exists and was not purged
+    pthread_mutex_lock(&registry);
+    dp = registered;
+    while(dp) {
+        if(dp == cache->owner && dp->serial == cache->serial) {
+            for(unsigned index = 0; index < dp->classes; ++index)
+                dp->release(cache, index, cache->count[index]);
+            pthread_mutex_lock(&dp->pager->mutex);
+            dp->used += cache->used;
+            pthread_mutex_unlock(&dp->pager->mutex);
+            break;
+        }
+        dp = dp->next;
+    }
+    pthread_mutex_unlock(&registry);
+    memset(cache, 0, sizeof(cache_t));
+}
+
+mempager::depot::cache_t *mempager::depot::local(void)
+{
+    local_t *tls = (local_t *)pthread_getspecific(key);
+    cache_t *cache;
+
+    if(!tls) {
+        tls = (local_t *)calloc(1, sizeof(local_t));
+        crit(tls != NULL, "mempager cache failed");
+        pthread_setspecific(key, tls);
+        pthread_mutex_lock(&registry);
+        tls->next = threads;
+        threads = tls;
+        pthread_mutex_unlock(&registry);
+    }
+
+    cache = &tls->entry[((size_t)this / sizeof(depot)) % SLAB_ENTRIES];
+    if(cache->owner == this && cache->serial == serial)
+        return cache;
+
+    evict(cache);
+    cache->owner = this;
+    cache->serial = serial;
+    return cache;
+}
+
+void mempager::depot::release(cache_t *cache, unsigned index, unsigned count)
+{
+    void *mem;
+
+    if(!count)
+        return;
+
+    pthread_mutex_lock(&pager->mutex);
+    while(count-- && NULL != (mem = cache->freelist[index])) {
+        cache->freelist[index] = *((void **)mem);
+        --cache->count[index];
+        *((void **)mem) = freelist[index];
+        freelist[index] = mem;
+    }
+    pthread_mutex_unlock(&pager->mutex);
+}
+
+long mempager::depot::inuse(void)
+{
+    long total;
+    local_t *tls;
+    cache_t *cache;
+
+    // per thread counts are a snapshot, but never lost or counted twice...
+    pthread_mutex_lock(&registry);
+    pthread_mutex_lock(&pager->mutex);
+    total = used;
+    pthread_mutex_unlock(&pager->mutex);
+    tls = threads;
+    while(tls) {
+        cache = &tls->entry[((size_t)this / sizeof(depot)) % SLAB_ENTRIES];
+        if(cache->owner == this && cache->serial == serial)
+            total += cache->used;
+        tls = tls->next;
+    }
+    pthread_mutex_unlock(&registry);
+    return total;
+}
+#else
+long mempager::depot::inuse(void)
+{
+    long total;
+
+    pthread_mutex_lock(&pager->mutex);
+    total = used;
+    pthread_mutex_unlock(&pager->mutex);
+    return total;
+}
+#endif
+
+mempager::depot::depot(mempager *owner)
+{
+    pager = owner;
+    pages = NULL;
+    classes = 0;
+    used = 0;
+
+    // a slab page must hold a reasonable number of blocks...
+    while(classes < SLAB_CLASSES && slab_sizes[classes] * 8 <= owner->pagesize - SLAB_HEADER)
+        ++classes;
+
+    for(unsigned index = 0; index < SLAB_CLASSES; ++index) {
+        freelist[index] = NULL;
+        batch[index] = SLAB_BATCH / slab_sizes[index];
+        if(batch[index] > 32)
+            batch[index] = 32;
+    }
+
+#ifdef  USE_SLAB_CACHE
+    pthread_once(&once, &setup);
+    pthread_mutex_lock(&registry);
+    serial = ++serials;
+    next = registered;
+    registered = this;
+    pthread_mutex_unlock(&registry);
+#else
+    serial = 0;
+#endif
+}
+
+mempager::depot::~depot()
+{
+#ifdef  USE_SLAB_CACHE
+    depot **dp;
+
+    pthread_mutex_lock(&registry);
+    dp = &registered;
+    while(*dp) {
+        if(*dp == this) {
+            *dp = next;
+            break;
+        }
+        dp = &((*dp)->next);
+    }
+    pthread_mutex_unlock(&registry);
+#endif
+    purge();
+}
+
+void mempager::depot::retire(void)
+{
+#ifdef  USE_SLAB_CACHE
+    // thread caches holding blocks of the old pages become stale...
+    pthread_mutex_lock(&registry);
+    serial = ++serials;
+    pthread_mutex_unlock(&registry);
+#endif
+}
+
+void mempager::depot::purge(void)
+{
+    slab_t *next;
+
+    while(pages) {
+        next = pages->next;
+        free(pages);
+        --pager->count;
+        pages = next;
+    }
+
+    for(unsigned index = 0; index < SLAB_CLASSES; ++index)
+        freelist[index] = NULL;
+
+    used = 0;
+}
+
+bool mempager::depot::grow(unsigned index)
+{
+    void *addr;
+    slab_t *page;
+    caddr_t mem;
+    size_t size = slab_sizes[index];
+    size_t offset = SLAB_HEADER;
+
+    if(pager->limit && pager->count >= pager->limit) {
+        pager->fault();
+        return false;
+    }
+
+    if(posix_memalign(&addr, pager->pagesize, pager->pagesize)) {
+        pager->fault();
+        return false;
+    }
+
+    page = (slab_t *)addr;
+    page->marker = SLAB_MARKER;
+    page->index = index;
+    page->next = pages;
+    pages = page;
+    ++pager->count;
+
+    while(offset + size <= pager->pagesize) {
+        mem = ((caddr_t)page) + offset;
+        *((void **)mem) = freelist[index];
+        freelist[index] = mem;
+        offset += size;
+    }
+    return true;
+}
+
+void *mempager::depot::get(unsigned index)
+{
+    void *mem;
+
+#ifdef  USE_SLAB_CACHE
+    cache_t *cache = local();
+
+    if(!cache->freelist[index]) {
+        pthread_mutex_lock(&pager->mutex);
+        while(cache->count[index] < batch[index]) {
+            if(!freelist[index] && !grow(index))
+                break;
+            mem = freelist[index];
+            freelist[index] = *((void **)mem);
+            *((void **)mem) = cache->freelist[index];
+            cache->freelist[index] = mem;
+            ++cache->count[index];
+        }
+        pthread_mutex_unlock(&pager->mutex);
+    }
+
+    mem = cache->freelist[index];
+    if(!mem)
+        return NULL;
+    cache->freelist[index] = *((void **)mem);
+    --cache->count[index];
+    cache->used += slab_sizes[index];
+#else
+    pthread_mutex_lock(&pager->mutex);
+    if(!freelist[index] && !grow(index)) {
+        pthread_mutex_unlock(&pager->mutex);
+        return NULL;
+    }
+    mem = freelist[index];
+    freelist[index] = *((void **)mem);
+    used += slab_sizes[index];
+    pthread_mutex_unlock(&pager->mutex);
+#endif
+
+    return mem;
+}
+
+void mempager::depot::put(void *mem, unsigned index)
+{
+#ifdef  USE_SLAB_CACHE
+    cache_t *cache = local();
+
+    cache->used -= slab_sizes[index];
+    *((void **)mem) = cache->freelist[index];
+    cache->freelist[index] = mem;
+    if(++cache->count[index] >= batch[index] * 2)
+        release(cache, index, batch[index]);
+#else
+    pthread_mutex_lock(&pager->mutex);
+    *((void **)mem) = freelist[index];
+    freelist[index] = mem;
+    used -= slab_sizes[index];
+    pthread_mutex_unlock(&pager->mutex);
+#endif
+}
+
+#endif
+
 mempager::mempager(size_t ps) :
 memalloc(ps)
 {
     pthread_mutex_init(&mutex, NULL);
+    slabs = NULL;
+
+#ifdef  USE_SLABS
+    // page aligned pages let dealloc find the page of a freed block...
+    if(align && !(pagesize & (pagesize - 1))) {
+        align = pagesize;
+        slabs = new depot(this);
+    }
+#endif
 }
 
 mempager::~mempager()
 {
+#ifdef  USE_SLABS
+    if(slabs)
+        delete slabs;
+#endif
     memalloc::purge();
     pthread_mutex_destroy(&mutex);
 }
@@ -208,23 +626,57 @@ void mempager::_unlock(void)
 
 unsigned mempager::utilization(void)
 {
-    unsigned long used;
+    unsigned long used = 0, alloc;
+    page_t *mp;
+
+#ifdef  USE_SLABS
+    if(slabs)
+        used = slabs->inuse();
+#endif
 
     pthread_mutex_lock(&mutex);
-    used = memalloc::utilization();
+    mp = page;
+    while(mp) {
+        used += mp->used;
+        mp = mp->next;
+    }
+    alloc = (unsigned long)count * pagesize;
     pthread_mutex_unlock(&mutex);
-    return used;
+
+    if(!used)
+        return 0;
+
+    alloc /= 100;
+    return used / alloc;
 }
 
 void mempager::purge(void)
 {
+#ifdef  USE_SLABS
+    if(slabs)
+        slabs->retire();
+#endif
     pthread_mutex_lock(&mutex);
+#ifdef  USE_SLABS
+    if(slabs)
+        slabs->purge();
+#endif
     memalloc::purge();
     pthread_mutex_unlock(&mutex);
 }
 
 void mempager::dealloc(void *mem)
 {
+#ifdef  USE_SLABS
+    slab_t *page;
+
+    if(!mem || !slabs)
+        return;
+
+    page = (slab_t *)((size_t)mem & ~((size_t)pagesize - 1));
+    if(page->marker == SLAB_MARKER)
+        slabs->put(mem, page->index);
+#endif
 }
 
 void *mempager::_alloc(size_t size)
@@ -232,6 +684,15 @@ void *mempager::_alloc(size_t size)
     assert(size > 0);
 
     void *mem;
+
+#ifdef  USE_SLABS
+    if(slabs) {
+        unsigned index = slabs->lookup(size);
+        if(index < slabs->classes)
+            return slabs->get(index);
+    }
+#endif
+
     pthread_mutex_lock(&mutex);
     mem = memalloc::_alloc(size);
     pthread_mutex_unlock(&mutex);
@@ -472,16 +933,8 @@ unsigned StringPager::split(const char *text, const char *string, unsigned flags
 
     // until end of string or end of matches...
     while(prior && *prior && match) {
-#if defined(_MSWINDOWS_)
-        if((flags & 0x01) == String::INSENSITIVE)
-            match = strstr(prior, text);
-#elif  defined(HAVE_STRICMP)
         if((flags & 0x01) == String::INSENSITIVE)
-            match = stristr(prior, text);
-#else
-        if((flags & 0x01) == String::INSENSITIVE)
-            match = strcasestr(prior, text);
-#endif
+            match = (char *)String::ifind(prior, text);
         else
             match = strstr(prior, text);
 
@@ -1040,6 +1493,356 @@ bool keyassoc::assign(const char *id, void *data)
     return true;
 }
 
+// a slot holds a copy of its key, prefixed by the key size, and the
+// distance from its home slot plus one, so that 0 marks an empty slot.
+class __LOCAL keyhash::slot
+{
+public:
+    uint32_t hash;
+    uint32_t dist;
+    caddr_t key;
+    void *pointer;
+
+    inline size_t size(void) const
+        {return *((size_t *)key);}
+
+    inline const char *data(void) const
+        {return key + sizeof(size_t);}
+
+    static void place(slot *table, unsigned mask, slot entry);
+    static void erase(slot *table, unsigned mask, unsigned pos);
+    static slot *probe(slot *table, unsigned mask, uint32_t hash, const void *key, size_t size);
+};
+
+#define KEYHASH_MIN     16
+#define KEYHASH_STEP    16      // old slots visited by each change
+
+// robin hood insert of an entry that is known not to be in the table
+void keyhash::slot::place(slot *table, unsigned mask, slot entry)
+{
+    unsigned pos = entry.hash & mask;
+
+    entry.dist = 1;
+    for(;;) {
+        slot *sp = &table[pos];
+        if(!sp->dist) {
+            *sp = entry;
+            return;
+        }
+        // the entry further from home takes the slot...
+        if(sp->dist < entry.dist) {
+            slot tmp = *sp;
+            *sp = entry;
+            entry = tmp;
+        }
+        pos = (pos + 1) & mask;
+        ++entry.dist;
+    }
+}
+
+// backward shift delete, keeps probe runs free of holes
+void keyhash::slot::erase(slot *table, unsigned mask, unsigned pos)
+{
+    for(;;) {
+        unsigned next = (pos + 1) & mask;
+        if(table[next].dist < 2) {
+            table[pos].dist = 0;
+            return;
+        }
+        table[pos] = table[next];
+        --table[pos].dist;
+        pos = next;
+    }
+}
+
+keyhash::slot *keyhash::slot::probe(slot *table, unsigned mask, uint32_t hash, const void *key, size_t size)
+{
+    unsigned pos = hash & mask;
+    uint32_t dist = 1;
+
+    for(;;) {
+        slot *sp = &table[pos];
+        if(sp->dist < dist)
+            return NULL;
+        if(sp->hash == hash && sp->size() == size && !memcmp(sp->data(), key, size))
+            return sp;
+        pos = (pos + 1) & mask;
+        ++dist;
+    }
+}
+
+static inline uint64_t keyhash_mix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+uint32_t keyhash::hash(const void *key, size_t size)
+{
+    const uint8_t *bp = (const uint8_t *)key;
+    uint64_t value = 0x9e3779b97f4a7c15ULL ^ (size * 0xc6a4a7935bd1e995ULL);
+    uint64_t word;
+
+    while(size >= 8) {
+        memcpy(&word, bp, 8);
+        word *= 0xc6a4a7935bd1e995ULL;
+        word ^= word >> 47;
+        value = (value ^ (word * 0xc6a4a7935bd1e995ULL)) * 0xc6a4a7935bd1e995ULL;
+        bp += 8;
+        size -= 8;
+    }
+
+    word = 0;
+    while(size--)
+        word = (word << 8) | bp[size];
+    value ^= word * 0x9e3779b97f4a7c15ULL;
+
+    value = keyhash_mix(value);
+    return (uint32_t)(value ^ (value >> 32));
+}
+
+keyhash::keyhash(unsigned size)
+{
+    table = older = NULL;
+    mask = oldmask = 0;
+    used = moving = 0;
+    cursor = 0;
+
+    if(size) {
+        unsigned limit = KEYHASH_MIN;
+        while(limit - limit / 8 < size)
+            limit <<= 1;
+        table = (slot *)cpr_memalloc(sizeof(slot) * limit);
+        memset(table, 0, sizeof(slot) * limit);
+        mask = limit - 1;
+    }
+}
+
+keyhash::~keyhash()
+{
+    purge();
+}
+
+void keyhash::purge(void)
+{
+    unsigned pos;
+
+    if(older) {
+        for(pos = 0; pos <= oldmask; ++pos) {
+            if(older[pos].dist)
+                free(older[pos].key);
+        }
+        free(older);
+    }
+
+    if(table) {
+        for(pos = 0; pos <= mask; ++pos) {
+            if(table[pos].dist)
+                free(table[pos].key);
+        }
+        free(table);
+    }
+
+    table = older = NULL;
+    mask = oldmask = 0;
+    used = moving = 0;
+    cursor = 0;
+}
+
+keyhash::slot *keyhash::find(uint32_t code, const void *key, size_t size) const
+{
+    slot *sp = NULL;
+
+    if(used)
+        sp = slot::probe(table, mask, code, key, size);
+    if(!sp && moving)
+        sp = slot::probe(older, oldmask, code, key, size);
+    return sp;
+}
+
+void keyhash::migrate(unsigned slots)
+{
+    // moving an entry shifts the rest of its run back into the cursor
+    // slot, so the cursor only advances past slots found empty.
+    while(moving && slots--) {
+        if(older[cursor].dist) {
+            slot::place(table, mask, older[cursor]);
+            slot::erase(older, oldmask, cursor);
+            ++used;
+            --moving;
+        }
+        else
+            cursor = (cursor + 1) & oldmask;
+    }
+
+    if(!moving && older) {
+        free(older);
+        older = NULL;
+        oldmask = 0;
+        cursor = 0;
+    }
+}
+
+void keyhash::grow(void)
+{
+    unsigned limit = KEYHASH_MIN;
+
+    if(table && used + moving + 1 <= mask + 1 - (mask + 1) / 8)
+        return;
+
+    // a table still being moved is finished before growing again
+    if(moving)
+        migrate(~0u);
+
+    if(table)
+        limit = (mask + 1) * 2;
+
+    older = table;
+    oldmask = mask;
+    moving = used;
+    used = 0;
+    cursor = 0;
+
+    table = (slot *)cpr_memalloc(sizeof(slot) * limit);
+    memset(table, 0, sizeof(slot) * limit);
+    mask = limit - 1;
+
+    if(!moving && older) {
+        free(older);
+        older = NULL;
+        oldmask = 0;
+    }
+}
+
+void keyhash::insert(uint32_t code, const void *key, size_t size, void *pointer)
+{
+    slot entry;
+
+    grow();
+    entry.hash = code;
+    entry.dist = 1;
+    entry.key = (caddr_t)cpr_memalloc(sizeof(size_t) + size + 1);
+    entry.pointer = pointer;
+    memcpy(entry.key, &size, sizeof(size_t));
+    memcpy(entry.key + sizeof(size_t), key, size);
+    entry.key[sizeof(size_t) + size] = 0;
+    slot::place(table, mask, entry);
+    ++used;
+}
+
+void *keyhash::locate(const void *key, size_t size) const
+{
+    assert(key != NULL || !size);
+
+    slot *sp = find(hash(key, size), key, size);
+
+    if(!sp)
+        return NULL;
+
+    return sp->pointer;
+}
+
+unsigned keyhash::locate(const char **names, void **pointers, unsigned count) const
+{
+    assert(names != NULL && pointers != NULL);
+
+    uint32_t codes[16];
+    size_t sizes[16];
+    unsigned found = 0, batch, pos;
+    slot *sp;
+
+    while(count) {
+        batch = count;
+        if(batch > 16)
+            batch = 16;
+
+        for(pos = 0; pos < batch; ++pos) {
+            sizes[pos] = strlen(names[pos]);
+            codes[pos] = hash(names[pos], sizes[pos]);
+#ifdef  __GNUC__
+            if(used)
+                __builtin_prefetch(&table[codes[pos] & mask]);
+#endif
+        }
+
+        for(pos = 0; pos < batch; ++pos) {
+            sp = find(codes[pos], names[pos], sizes[pos]);
+            if(sp) {
+                pointers[pos] = sp->pointer;
+                ++found;
+            }
+            else
+                pointers[pos] = NULL;
+        }
+
+        names += batch;
+        pointers += batch;
+        count -= batch;
+    }
+    return found;
+}
+
+void keyhash::assign(const void *key, size_t size, void *pointer)
+{
+    assert(key != NULL || !size);
+
+    uint32_t code = hash(key, size);
+    slot *sp;
+
+    migrate(KEYHASH_STEP);
+    sp = find(code, key, size);
+    if(sp)
+        sp->pointer = pointer;
+    else
+        insert(code, key, size, pointer);
+}
+
+bool keyhash::create(const void *key, size_t size, void *pointer)
+{
+    assert(key != NULL || !size);
+
+    uint32_t code = hash(key, size);
+
+    migrate(KEYHASH_STEP);
+    if(find(code, key, size))
+        return false;
+
+    insert(code, key, size, pointer);
+    return true;
+}
+
+void *keyhash::remove(const void *key, size_t size)
+{
+    assert(key != NULL || !size);
+
+    uint32_t code = hash(key, size);
+    void *pointer;
+    slot *sp;
+
+    migrate(KEYHASH_STEP);
+    if(used && NULL != (sp = slot::probe(table, mask, code, key, size))) {
+        pointer = sp->pointer;
+        free(sp->key);
+        slot::erase(table, mask, (unsigned)(sp - table));
+        --used;
+        return pointer;
+    }
+
+    if(moving && NULL != (sp = slot::probe(older, oldmask, code, key, size))) {
+        pointer = sp->pointer;
+        free(sp->key);
+        slot::erase(older, oldmask, (unsigned)(sp - older));
+        --moving;
+        migrate(0);
+        return pointer;
+    }
+    return NULL;
+}
+
 chartext::chartext() :
 CharacterProtocol()
 {
@@ -21,11 +21,27 @@
 #include <ucommon-config.h>
 #include <ucommon/export.h>
 #include <ucommon/persist.h>
+#include <stdlib.h>
+#ifdef  HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef  HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if defined(HAVE_SYS_MMAN_H) && !defined(_MSWINDOWS_)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define PERSIST_MAPPED
+#endif
 
 namespace ucommon {
 
 const uint32_t NullObject = 0xffffffff;
 
+// primitives are collected in this much buffer before they are written
+// to the stream, and an archive written into memory starts this size...
+const size_t BufferSize = 4096;
+
 PersistException::PersistException(const std::string& reason) :
 _what(reason)
 {
@@ -100,6 +116,16 @@ PersistObject* TypeManager::createInstanceOf(const char* name)
   return (_internal_GetMap()[std::string(name)])();
 }
 
+NewPersistObjectFunction TypeManager::find(const char* name)
+{
+  if (!refCount)
+    return NULL;
+  StringFunctionMap::const_iterator itor = _internal_GetMap().find(std::string(name));
+  if (itor == _internal_GetMap().end())
+    return NULL;
+  return itor->second;
+}
+
 TypeManager::registration::registration(const char *name, NewPersistObjectFunction func) :
 myName(name)
 {
@@ -112,29 +138,198 @@ TypeManager::registration::~registration()
 }
 
 PersistEngine::PersistEngine(std::iostream& stream, EngineMode mode) throw(PersistException) :
-myUnderlyingStream(stream), myOperationalMode(mode)
+myUnderlyingStream(&stream), myOperationalMode(mode)
+{
+  bufsize = bufpos = buflimit = 0;
+  buffer = NULL;
+  input = limit = NULL;
+  archive = NULL;
+  archiveSize = 0;
+  archiveMapped = false;
+  depth = 0;
+
+  if (mode == modeWrite) {
+    buffer = (uint8_t *)malloc(BufferSize);
+    if (!buffer)
+      throw(PersistException("Unable to allocate buffer"));
+    bufsize = BufferSize;
+  }
+}
+
+PersistEngine::PersistEngine() :
+myUnderlyingStream(NULL), myOperationalMode(modeWrite)
+{
+  buffer = (uint8_t *)malloc(BufferSize);
+  bufsize = buflimit = buffer ? BufferSize : 0;
+  bufpos = 0;
+  input = limit = NULL;
+  archive = NULL;
+  archiveSize = 0;
+  archiveMapped = false;
+  depth = 0;
+}
+
+PersistEngine::PersistEngine(const void *data, size_t size) :
+myUnderlyingStream(NULL), myOperationalMode(modeRead)
+{
+  buffer = NULL;
+  bufsize = bufpos = buflimit = 0;
+  input = (const uint8_t *)data;
+  limit = input + size;
+  archive = NULL;
+  archiveSize = 0;
+  archiveMapped = false;
+  depth = 0;
+}
+
+PersistEngine::PersistEngine(const char *path) throw(PersistException) :
+myUnderlyingStream(NULL), myOperationalMode(modeRead)
 {
+  buffer = NULL;
+  bufsize = bufpos = buflimit = 0;
+  input = limit = NULL;
+  archive = NULL;
+  archiveSize = 0;
+  archiveMapped = false;
+  depth = 0;
+
+#ifdef  PERSIST_MAPPED
+  struct stat ino;
+  int fd = ::open(path, O_RDONLY);
+
+  if (fd < 0)
+    throw(PersistException(std::string("Unable to open archive ") + path));
+
+  if (!fstat(fd, &ino) && ino.st_size > 0) {
+    void *map = mmap(NULL, (size_t)ino.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+#ifdef  MADV_SEQUENTIAL
+      madvise(map, (size_t)ino.st_size, MADV_SEQUENTIAL);
+#endif
+      archive = map;
+      archiveSize = (size_t)ino.st_size;
+      archiveMapped = true;
+    }
+  }
+  ::close(fd);
+#endif
+
+  if (!archive) {
+    size_t max = BufferSize, len;
+    FILE *fp = fopen(path, "rb");
+
+    if (!fp)
+      throw(PersistException(std::string("Unable to open archive ") + path));
+
+    uint8_t *data = (uint8_t *)malloc(max);
+    while (data && (len = fread(data + archiveSize, 1, max - archiveSize, fp)) > 0) {
+      archiveSize += len;
+      if (archiveSize < max)
+        continue;
+      max *= 2;
+      uint8_t *more = (uint8_t *)realloc(data, max);
+      if (!more)
+        free(data);
+      data = more;
+    }
+    fclose(fp);
+    if (!data)
+      throw(PersistException("Unable to allocate archive"));
+    archive = data;
+  }
+
+  input = (const uint8_t *)archive;
+  limit = input + archiveSize;
 }
 
 PersistEngine::~PersistEngine()
 {
-    if (myUnderlyingStream.good())
-        myUnderlyingStream.sync();
+  if (myUnderlyingStream) {
+    flush();
+    if (myUnderlyingStream->good())
+      myUnderlyingStream->sync();
+  }
+
+#ifdef  PERSIST_MAPPED
+  if (archiveMapped)
+    munmap(archive, archiveSize);
+  else
+#endif
+  if (archive)
+    free(archive);
+
+  if (buffer)
+    free(buffer);
 }
 
-void PersistEngine::writeBinary(const uint8_t* data, const uint32_t size) throw(PersistException)
+void PersistEngine::flush(void)
 {
-  if(myOperationalMode != modeWrite)
-    throw("Cannot write to an input Engine");
-  myUnderlyingStream.write((const char *)data,size);
+  if (myUnderlyingStream && bufpos) {
+    myUnderlyingStream->write((const char *)buffer, bufpos);
+    bufpos = 0;
+  }
 }
 
+void PersistEngine::writeBuffer(const uint8_t* data, uint32_t size) throw(PersistException)
+{
+  if (myOperationalMode != modeWrite)
+    throw(PersistException("Cannot write to an input Engine"));
+
+  // an archive in memory grows, while a stream is written thru...
+  if (!myUnderlyingStream) {
+    size_t max = bufsize ? bufsize : BufferSize;
+    while (max - bufpos < size)
+      max *= 2;
+    uint8_t *more = (uint8_t *)realloc(buffer, max);
+    if (!more)
+      throw(PersistException("Unable to grow archive"));
+    buffer = more;
+    bufsize = buflimit = max;
+    memcpy(buffer + bufpos, data, size);
+    bufpos += size;
+    return;
+  }
+
+  flush();
+  if (size < buflimit) {
+    memcpy(buffer, data, size);
+    bufpos = size;
+  }
+  else
+    myUnderlyingStream->write((const char *)data, size);
+}
 
-void PersistEngine::readBinary(uint8_t* data, uint32_t size) throw(PersistException)
+void PersistEngine::readBuffer(uint8_t* data, uint32_t size) throw(PersistException)
 {
-  if(myOperationalMode != modeRead)
-    throw("Cannot read from an output Engine");
-  myUnderlyingStream.read((char *)data,size);
+  if (myOperationalMode != modeRead)
+    throw(PersistException("Cannot read from an output Engine"));
+
+  if (!myUnderlyingStream)
+    throw(PersistException("Read past end of archive"));
+
+  // read straight from the stream buffer, rather than thru a sentry...
+  std::streamsize count = myUnderlyingStream->rdbuf()->sgetn((char *)data, size);
+  if (count < (std::streamsize)size)
+    myUnderlyingStream->setstate(std::ios::eofbit | std::ios::failbit);
+}
+
+void PersistEngine::writeMarker(const char *marker) throw(PersistException)
+{
+  uint32_t len = 4;
+  write(len);
+  writeBinary((const uint8_t *)marker, 4);
+}
+
+void PersistEngine::readMarker(const char *marker, const char *reason) throw(PersistException)
+{
+  uint32_t len = 0;
+  uint8_t text[4];
+  read(len);
+  if (len != 4)
+    throw(PersistException(reason));
+  readBinary(text, 4);
+  if (memcmp(text, marker, 4))
+    throw(PersistException(reason));
 }
 
 void PersistEngine::write(const PersistObject *object) throw(PersistException)
@@ -148,29 +343,46 @@ void PersistEngine::write(const PersistObject *object) throw(PersistException)
     return;
   }
 
-  // First off - has this Object been serialized already?
-  ArchiveMap::const_iterator itor = myArchiveMap.find(object);
-  if (itor == myArchiveMap.end()) {
+  // First off - has this Object been serialized already?  The search
+  // also finds where a new object is to be inserted.
+  ArchiveMap::iterator itor = myArchiveMap.lower_bound(object);
+  if (itor == myArchiveMap.end() || itor->first != object) {
     // Unfortunately we need to serialize it - here we go ....
+    // the object is collected in the buffer until it is complete
+    if (depth++ == 0)
+      buflimit = bufsize;
     uint32_t id = (uint32_t)myArchiveMap.size();
-    myArchiveMap[object] = id; // bumps id automatically for next one
+    myArchiveMap.insert(itor, ArchiveMap::value_type(object, id)); // bumps id automatically for next one
     write(id);
-    ClassMap::const_iterator classItor = myClassMap.find(object->getPersistenceID());
-    if (classItor == myClassMap.end()) {
-      uint32_t classId = (uint32_t)myClassMap.size();
-      myClassMap[object->getPersistenceID()] = classId;
-      write(classId);
-      write(static_cast<std::string>(object->getPersistenceID()));
-        }
+
+    // a class is usually found by the address of its persistence id, and
+    // only by name the first time that address is seen
+    const char *persistenceID = object->getPersistenceID();
+    IdentityMap::const_iterator identityItor = myIdentityMap.find(persistenceID);
+    if (identityItor != myIdentityMap.end()) {
+      write(identityItor->second);
+    }
     else {
-      write(classItor->second);
-        }
-    std::string majik;
-    majik = "OBST";
-    write(majik);
+      ClassMap::const_iterator classItor = myClassMap.find(persistenceID);
+      if (classItor == myClassMap.end()) {
+        uint32_t classId = (uint32_t)myClassMap.size();
+        myClassMap[persistenceID] = classId;
+        myIdentityMap[persistenceID] = classId;
+        write(classId);
+        write(static_cast<std::string>(persistenceID));
+      }
+      else {
+        myIdentityMap[persistenceID] = classItor->second;
+        write(classItor->second);
+      }
+    }
+    writeMarker("OBST");
     object->write(*this);
-    majik = "OBEN";
-    write(majik);
+    writeMarker("OBEN");
+    if (--depth == 0 && myUnderlyingStream) {
+      flush();
+      buflimit = 0;
+    }
   }
   else {
     // This object has been serialized, so just pop its ID out
@@ -183,7 +395,7 @@ void PersistEngine::read(PersistObject &object) throw(PersistException)
   uint32_t id = 0;
   read(id);
   if (id == NullObject)
-    throw("Object Id should not be NULL when un-persisting to a reference");
+    throw(PersistException("Object Id should not be NULL when un-persisting to a reference"));
 
   // Do we already have this object in memory?
   if (id < myArchiveVector.size()) {
@@ -216,7 +428,7 @@ void PersistEngine::read(PersistObject *&object) throw(PersistException)
   }
 
   // Okay - read the identifier for the class in...
-  std::string className = readClass();
+  uint32_t classId = readClass();
 
   // is the pointer already initialized? if so then no need to reallocate
   if (object != NULL) {
@@ -224,64 +436,73 @@ void PersistEngine::read(PersistObject *&object) throw(PersistException)
     return;
   }
 
-  // Create the object (of the relevant type)
-  object = TypeManager::createInstanceOf(className.c_str());
+  // Create the object (of the relevant type), finding the type only the
+  // first time the class is used in this stream
+  NewPersistObjectFunction construction = myFactoryVector[classId];
+  if (!construction) {
+    construction = TypeManager::find(myClassVector[classId].c_str());
+    myFactoryVector[classId] = construction;
+  }
+  if (construction)
+    object = construction();
   if (object) {
     // Okay then - we can make this object
     readObject(object);
   }
   else
-    throw(PersistException(std::string("Unable to instantiate object of class ")+className));
+    throw(PersistException(std::string("Unable to instantiate object of class ")+myClassVector[classId]));
 }
 
 void PersistEngine::readObject(PersistObject* object) throw(PersistException)
 {
   // Okay then - we can make this object
   myArchiveVector.push_back(object);
-  std::string majik;
-  read(majik);
-  if(majik != std::string("OBST"))
-    throw( PersistException("Missing Start-of-Object marker"));
+  readMarker("OBST", "Missing Start-of-Object marker");
   object->read(*this);
-  read(majik);
-  if(majik != std::string("OBEN"))
-    throw( PersistException("Missing End-of-Object marker"));
+  readMarker("OBEN", "Missing End-of-Object marker");
 }
 
-const std::string PersistEngine::readClass() throw(PersistException)
+uint32_t PersistEngine::readClass() throw(PersistException)
 {
   // Okay - read the identifier for the class in...
   uint32_t classId = 0;
   read(classId);
-  std::string className;
-  if (classId < myClassVector.size()) {
-    className = myClassVector[classId];
-  }
-  else {
-    // Okay the class wasn't known yet - save its name
-    read(className);
-    myClassVector.push_back(className);
-  }
+  if (classId < myClassVector.size())
+    return classId;
+
+  if (classId != myClassVector.size())
+    throw(PersistException("Invalid class id"));
 
-  return className;
+  // Okay the class wasn't known yet - save its name
+  std::string className;
+  read(className);
+  myClassVector.push_back(className);
+  myFactoryVector.push_back(NULL);
+  return classId;
 }
 
 void PersistEngine::write(const std::string& str) throw(PersistException)
 {
   uint32_t len = (uint32_t)str.length();
   write(len);
-  writeBinary((uint8_t*)str.c_str(),len);
+  writeBinary((const uint8_t*)str.data(),len);
 }
 
 void PersistEngine::read(std::string& str) throw(PersistException)
 {
   uint32_t len = 0;
   read(len);
-  uint8_t *buffer = new uint8_t[len+1];
-  readBinary(buffer,len);
-  buffer[len] = 0;
-  str = (char*)buffer;
-  delete[] buffer;
+
+  // a string in memory is assigned directly from the archive...
+  if (len <= (size_t)(limit - input)) {
+    str.assign((const char *)input, len);
+    input += len;
+    return;
+  }
+
+  str.resize(len);
+  if (len)
+    readBinary((uint8_t *)&str[0], len);
 }
 
 } // namespace ucommon
@@ -177,6 +177,7 @@ size_t BufferProtocol::put(const void *address, size_t size)
         return 0;
 
     const char *cp = (const char *)address;
+    size_t chunk;
 
     while(count < size) {
         if(outsize == bufsize) {
@@ -187,7 +188,12 @@ size_t BufferProtocol::put(const void *address, size_t size)
                 return count;
             }
         }
-        output[outsize++] = cp[count++];
+        chunk = bufsize - outsize;
+        if(chunk > size - count)
+            chunk = size - count;
+        memcpy(output + outsize, cp + count, chunk);
+        outsize += chunk;
+        count += chunk;
     }
     return count;
 }
@@ -200,6 +206,7 @@ size_t BufferProtocol::get(void *address, size_t size)
         return 0;
 
     char *cp = (char *)address;
+    size_t chunk;
 
     while(count < size) {
         if(bufpos == insize) {
@@ -216,7 +223,12 @@ size_t BufferProtocol::get(void *address, size_t size)
             if(!insize)
                 return count;
         }
-        cp[count++] = input[bufpos++];
+        chunk = insize - bufpos;
+        if(chunk > size - count)
+            chunk = size - count;
+        memcpy(cp + count, input + bufpos, chunk);
+        bufpos += chunk;
+        count += chunk;
     }
     return count;
 }
@@ -342,6 +354,27 @@ bool BufferProtocol::_flush(void)
     return false;
 }
 
+const char *BufferProtocol::drain(size_t *size)
+{
+    assert(size != NULL);
+
+    *size = outsize;
+    if(!output || !outsize)
+        return NULL;
+
+    outsize = 0;
+    return output;
+}
+
+void BufferProtocol::restore(size_t size, size_t sent)
+{
+    if(!output || sent >= size)
+        return;
+
+    memmove(output, output + sent, size - sent);
+    outsize = size - sent;
+}
+
 char *BufferProtocol::gather(size_t size)
 {
     if(!input || size > bufsize)
@@ -0,0 +1,542 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <ucommon-config.h>
+#include <ucommon/export.h>
+#include <ucommon/reactor.h>
+#ifdef  HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#include <string.h>
+#include <errno.h>
+
+#if defined(HAVE_SYS_EPOLL_H) && !defined(__PTH__)
+#include <sys/epoll.h>
+#define USE_EPOLL
+#elif defined(HAVE_POLL_H)
+#include <poll.h>
+#elif defined(HAVE_SYS_POLL_H)
+#include <sys/poll.h>
+#endif
+
+#if defined(_MSWINDOWS_)
+#define _poll_(fds, cnt, timeout) WSAPoll(fds, cnt, timeout)
+#elif defined(__PTH__)
+#define _poll_(fds, cnt, timeout) pth_poll(fds, cnt, timeout)
+#else
+#define _poll_(fds, cnt, timeout) ::poll(fds, cnt, timeout)
+#endif
+
+#ifndef EPOLLRDHUP
+#define EPOLLRDHUP  0
+#endif
+
+namespace ucommon {
+
+#define REACTOR_EVENTS  64
+#define REACTOR_HANGUP  0x80
+
+static inline Timer::tick_t clock_ms(void)
+{
+    return Timer::ticks() / 10000;
+}
+
+class __LOCAL Reactor::worker : public JoinableThread
+{
+public:
+    Reactor *reactor;
+    Mutex lock;
+    OrderedIndex handlers, pending, retired;
+    volatile bool serving;
+    Timer::tick_t sweeping;
+    unsigned count;
+#ifdef  USE_EPOLL
+    int efd;
+#else
+    struct pollfd *pfd;
+    handler **map;
+    unsigned limit;
+#endif
+#ifndef _MSWINDOWS_
+    int wake[2];
+#endif
+
+    worker(Reactor *owner);
+    ~worker();
+
+    void run(void);
+    void adopt(void);
+    void enable(handler *h);
+    void retire(handler *h);
+    void notify(void);
+    void dispatch(handler *h, unsigned events);
+    void sweep(void);
+    void reap(void);
+    void wait(timeout_t timeout);
+    void release(void);
+
+    inline void finish(void)
+        {join();}
+};
+
+Reactor::worker::worker(Reactor *owner) : JoinableThread()
+{
+    reactor = owner;
+    serving = false;
+    sweeping = 0;
+    count = 0;
+
+#ifdef  _MSWINDOWS_
+#else
+    if(::pipe(wake)) {
+        wake[0] = wake[1] = -1;
+    }
+    else {
+        fcntl(wake[0], F_SETFL, fcntl(wake[0], F_GETFL) | O_NONBLOCK);
+        fcntl(wake[1], F_SETFL, fcntl(wake[1], F_GETFL) | O_NONBLOCK);
+    }
+#endif
+
+#ifdef  USE_EPOLL
+    efd = epoll_create(REACTOR_EVENTS);
+    crit(efd > -1, "reactor epoll failed");
+    if(wake[0] > -1) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;
+        epoll_ctl(efd, EPOLL_CTL_ADD, wake[0], &ev);
+    }
+#else
+    pfd = NULL;
+    map = NULL;
+    limit = 0;
+#endif
+}
+
+Reactor::worker::~worker()
+{
+    release();
+
+#ifdef  USE_EPOLL
+    if(efd > -1)
+        ::close(efd);
+#else
+    if(pfd)
+        free(pfd);
+    if(map)
+        free(map);
+#endif
+
+#ifndef _MSWINDOWS_
+    if(wake[0] > -1)
+        ::close(wake[0]);
+    if(wake[1] > -1)
+        ::close(wake[1]);
+#endif
+}
+
+void Reactor::worker::release(void)
+{
+    handler *h;
+
+    // move everything to retired so it is all reaped the same way...
+    lock.acquire();
+    while(NULL != (h = static_cast<handler *>(pending.begin()))) {
+        h->detaching = true;
+        h->enlist(&retired);
+        --reactor->attached;
+    }
+    lock.release();
+
+    while(NULL != (h = static_cast<handler *>(handlers.begin())))
+        retire(h);
+
+    reap();
+}
+
+void Reactor::worker::notify(void)
+{
+#ifndef _MSWINDOWS_
+    char buf = 0;
+    if(wake[1] > -1 && ::write(wake[1], &buf, 1) < 1)
+        return;
+#endif
+}
+
+void Reactor::worker::adopt(void)
+{
+    handler *h;
+
+    lock.acquire();
+    while(NULL != (h = static_cast<handler *>(pending.begin()))) {
+        h->enlist(&handlers);
+        ++count;
+#ifdef  USE_EPOLL
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLRDHUP | EPOLLET;
+        if(h->mask & INPUT)
+            ev.events |= EPOLLIN;
+        if(h->mask & OUTPUT)
+            ev.events |= EPOLLOUT;
+        ev.data.ptr = h;
+        if(epoll_ctl(efd, EPOLL_CTL_ADD, h->so, &ev)) {
+            // cannot monitor, so treat as a disconnected socket...
+            lock.release();
+            h->disconnect();
+            lock.acquire();
+            continue;
+        }
+#endif
+    }
+    lock.release();
+}
+
+void Reactor::worker::enable(handler *h)
+{
+#ifdef  USE_EPOLL
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLRDHUP | EPOLLET;
+    if(h->mask & INPUT)
+        ev.events |= EPOLLIN;
+    if(h->mask & OUTPUT)
+        ev.events |= EPOLLOUT;
+    ev.data.ptr = h;
+    epoll_ctl(efd, EPOLL_CTL_MOD, h->so, &ev);
+#else
+    notify();
+#endif
+}
+
+void Reactor::worker::retire(handler *h)
+{
+#ifdef  USE_EPOLL
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    epoll_ctl(efd, EPOLL_CTL_DEL, h->so, &ev);
+#endif
+    h->detaching = true;
+    h->enlist(&retired);
+    --count;
+    --reactor->attached;
+}
+
+void Reactor::worker::reap(void)
+{
+    handler *h;
+
+    while(NULL != (h = static_cast<handler *>(retired.begin()))) {
+        h->delist();
+        h->loop = NULL;
+        h->detached();
+    }
+}
+
+void Reactor::worker::dispatch(handler *h, unsigned events)
+{
+    if(h->detaching)
+        return;
+
+    if(events & INPUT)
+        h->input();
+
+    if(!h->detaching && (events & OUTPUT))
+        h->output();
+
+    if(!h->detaching && (events & REACTOR_HANGUP))
+        h->disconnect();
+}
+
+void Reactor::worker::sweep(void)
+{
+    Timer::tick_t now = clock_ms();
+    linked_pointer<handler> hp = handlers.begin();
+    handler *h;
+
+    if(now < sweeping)
+        return;
+
+    sweeping = now + reactor->granularity;
+    while(is(hp)) {
+        h = *hp;
+        hp.next();
+        if(h->deadline && h->deadline <= now && !h->detaching) {
+            h->deadline = 0;
+            h->expired();
+        }
+    }
+}
+
+void Reactor::worker::wait(timeout_t timeout)
+{
+#ifdef  USE_EPOLL
+    struct epoll_event events[REACTOR_EVENTS];
+    unsigned mask;
+    handler *h;
+
+    int result = epoll_wait(efd, events, REACTOR_EVENTS, (int)timeout);
+    for(int pos = 0; pos < result; ++pos) {
+        h = static_cast<handler *>(events[pos].data.ptr);
+        if(!h) {
+            char buf[32];
+            while(::read(wake[0], buf, sizeof(buf)) > 0)
+                ;
+            continue;
+        }
+        mask = 0;
+        if(events[pos].events & (EPOLLIN | EPOLLPRI))
+            mask |= INPUT;
+        if(events[pos].events & EPOLLOUT)
+            mask |= OUTPUT;
+        if(events[pos].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+            mask |= REACTOR_HANGUP;
+        dispatch(h, mask);
+    }
+#else
+    unsigned total = 0, mask;
+    linked_pointer<handler> hp;
+
+    if(count + 1 > limit) {
+        limit = count + 32;
+        pfd = (struct pollfd *)realloc(pfd, sizeof(struct pollfd) * limit);
+        map = (handler **)realloc(map, sizeof(handler *) * limit);
+        crit(pfd != NULL && map != NULL, "reactor poll alloc failed");
+    }
+
+#ifndef _MSWINDOWS_
+    if(wake[0] > -1) {
+        pfd[total].fd = wake[0];
+        pfd[total].events = POLLIN;
+        pfd[total].revents = 0;
+        map[total++] = NULL;
+    }
+#endif
+
+    lock.acquire();
+    hp = handlers.begin();
+    while(is(hp) && total < limit) {
+        pfd[total].fd = hp->so;
+        pfd[total].events = 0;
+        pfd[total].revents = 0;
+        if(hp->mask & INPUT)
+            pfd[total].events |= POLLIN;
+        if(hp->mask & OUTPUT)
+            pfd[total].events |= POLLOUT;
+        map[total++] = *hp;
+        hp.next();
+    }
+    lock.release();
+
+    int result = _poll_(pfd, total, (int)timeout);
+    for(unsigned pos = 0; result > 0 && pos < total; ++pos) {
+        if(!pfd[pos].revents)
+            continue;
+        --result;
+        if(!map[pos]) {
+#ifndef _MSWINDOWS_
+            char buf[32];
+            while(::read(wake[0], buf, sizeof(buf)) > 0)
+                ;
+#endif
+            continue;
+        }
+        mask = 0;
+        if(pfd[pos].revents & POLLIN)
+            mask |= INPUT;
+        if(pfd[pos].revents & POLLOUT)
+            mask |= OUTPUT;
+        if(pfd[pos].revents & (POLLERR | POLLHUP | POLLNVAL))
+            mask |= REACTOR_HANGUP;
+        dispatch(map[pos], mask);
+    }
+#endif
+}
+
+void Reactor::worker::run(void)
+{
+    while(serving) {
+        adopt();
+        wait(reactor->granularity);
+        sweep();
+        reap();
+    }
+}
+
+Reactor::handler::handler(socket_t socket) : LinkedList()
+{
+    loop = NULL;
+    deadline = 0;
+    mask = 0;
+    detaching = false;
+    so = socket;
+}
+
+Reactor::handler::~handler()
+{
+}
+
+void Reactor::handler::input(void)
+{
+}
+
+void Reactor::handler::output(void)
+{
+    writing(false);
+}
+
+void Reactor::handler::expired(void)
+{
+    disconnect();
+}
+
+void Reactor::handler::disconnect(void)
+{
+    detach();
+}
+
+void Reactor::handler::detached(void)
+{
+}
+
+void Reactor::handler::arm(timeout_t timeout)
+{
+    if(timeout == Timer::inf)
+        deadline = 0;
+    else
+        deadline = clock_ms() + timeout;
+}
+
+void Reactor::handler::disarm(void)
+{
+    deadline = 0;
+}
+
+void Reactor::handler::writing(bool enable)
+{
+    worker *w = loop;
+
+    if(w)
+        w->lock.acquire();
+
+    if(enable)
+        mask |= OUTPUT;
+    else
+        mask &= ~OUTPUT;
+
+    if(w) {
+        if(!detaching)
+            w->enable(this);
+        w->lock.release();
+    }
+}
+
+void Reactor::handler::detach(void)
+{
+    if(!loop || detaching)
+        return;
+
+    loop->retire(this);
+}
+
+void Reactor::handler::cancel(void)
+{
+    Socket::cancel(so);
+}
+
+Reactor::Reactor(unsigned count, timeout_t resolution)
+{
+    if(!count)
+        count = 1;
+
+    if(!resolution || resolution == Timer::inf)
+        resolution = 250;
+
+    threads = count;
+    rotor = 0;
+    granularity = resolution;
+    workers = new worker*[count];
+    for(unsigned pos = 0; pos < count; ++pos)
+        workers[pos] = new worker(this);
+}
+
+Reactor::~Reactor()
+{
+    stop();
+
+    for(unsigned pos = 0; pos < threads; ++pos)
+        delete workers[pos];
+
+    delete[] workers;
+    workers = NULL;
+}
+
+bool Reactor::is_edge(void)
+{
+#ifdef  USE_EPOLL
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Reactor::start(int priority)
+{
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        if(workers[pos]->serving)
+            continue;
+        workers[pos]->serving = true;
+        workers[pos]->start(priority);
+    }
+}
+
+void Reactor::stop(void)
+{
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        workers[pos]->serving = false;
+        workers[pos]->notify();
+    }
+
+    for(unsigned pos = 0; pos < threads; ++pos)
+        workers[pos]->finish();
+}
+
+bool Reactor::attach(handler *h, unsigned events)
+{
+    worker *w;
+
+    if(!h || h->loop || h->so == INVALID_SOCKET)
+        return false;
+
+    Socket::blocking(h->so, false);
+
+    // round robin assignment, a race on rotor is harmless...
+    w = workers[rotor++ % threads];
+
+    w->lock.acquire();
+    h->mask = events;
+    h->detaching = false;
+    h->loop = w;
+    h->enlist(&w->pending);
+    ++attached;
+    w->lock.release();
+    w->notify();
+    return true;
+}
+
+} // namespace ucommon
@@ -20,6 +20,7 @@
 #include <ucommon/socket.h>
 #include <ucommon/string.h>
 #include <ucommon/thread.h>
+#include <ucommon/memory.h>
 #include <ucommon/fsys.h>
 #ifndef _MSWINDOWS_
 #include <net/if.h>
@@ -906,7 +907,7 @@ void cidr::set(const char *cp)
         memset(&Netmask.ipv6, 0, sizeof(Netmask));
         bitset((bit_t *)&Netmask.ipv6, mask(cp));
         String::set(cbuf, sizeof(cbuf), cp);
-        ep = (char *)strchr(cp, '/');
+        ep = (char *)strchr(cbuf, '/');
         if(ep)
             *ep = 0;
 #ifdef  _MSWINDOWS_
@@ -925,6 +926,281 @@ void cidr::set(const char *cp)
     }
 }
 
+static inline unsigned cidr_bit(const uint8_t *key, unsigned pos)
+{
+    return (key[pos >> 3] >> (7 - (pos & 7))) & 1;
+}
+
+// count leading bits two keys have in common, up to a limit
+static unsigned cidr_common(const uint8_t *k1, const uint8_t *k2, unsigned max)
+{
+    unsigned bits = 0;
+    uint8_t diff;
+
+    while(bits + 8 <= max && k1[bits >> 3] == k2[bits >> 3])
+        bits += 8;
+
+    if(bits >= max)
+        return max;
+
+    diff = k1[bits >> 3] ^ k2[bits >> 3];
+    while(bits < max && !(diff & (0x80 >> (bits & 7))))
+        ++bits;
+    return bits;
+}
+
+static bool cidr_prefixed(const uint8_t *addr, const uint8_t *key, unsigned bits)
+{
+    unsigned bytes = bits >> 3;
+
+    if(memcmp(addr, key, bytes))
+        return false;
+
+    if(bits & 7) {
+        uint8_t mask = (uint8_t)(0xff << (8 - (bits & 7)));
+        if((addr[bytes] ^ key[bytes]) & mask)
+            return false;
+    }
+    return true;
+}
+
+class __LOCAL cidrmap::snapshot : public memalloc
+{
+public:
+    class node
+    {
+    public:
+        node *child[2];
+        const cidr *entry;
+        unsigned bits;
+        uint8_t key[16];
+    };
+
+    node *ipv4, *ipv6;
+    unsigned entries;
+
+    snapshot(const cidr::policy *policy);
+
+    node *create(const uint8_t *key, unsigned bits, const cidr *entry);
+    void insert(node **root, const uint8_t *key, unsigned bits, const cidr *entry);
+
+    static const node *root(const snapshot *snap, const struct sockaddr *address, const uint8_t **key, unsigned *max);
+};
+
+cidrmap::snapshot::snapshot(const cidr::policy *policy) :
+memalloc()
+{
+    ipv4 = ipv6 = NULL;
+    entries = 0;
+
+    // entries are added in chain order, so the first of identical prefixes
+    // is kept, as when the chain is searched.
+    linked_pointer<const cidr> cp = policy;
+    while(cp) {
+        inethostaddr_t network = cp->getNetwork();
+        unsigned bits = cp->getMask();
+
+        switch(cp->getFamily()) {
+        case AF_INET:
+            if(bits > 32)
+                bits = 32;
+            insert(&ipv4, (const uint8_t *)&network.ipv4, bits, *cp);
+            break;
+#ifdef  AF_INET6
+        case AF_INET6:
+            if(bits > 128)
+                bits = 128;
+            insert(&ipv6, (const uint8_t *)&network.ipv6, bits, *cp);
+            break;
+#endif
+        default:
+            break;
+        }
+        cp.next();
+    }
+}
+
+cidrmap::snapshot::node *cidrmap::snapshot::create(const uint8_t *key, unsigned bits, const cidr *entry)
+{
+    node *np = (node *)_alloc(sizeof(node));
+    unsigned bytes = (bits + 7) >> 3;
+
+    np->child[0] = np->child[1] = NULL;
+    np->entry = entry;
+    np->bits = bits;
+    memset(np->key, 0, sizeof(np->key));
+    memcpy(np->key, key, bytes);
+    if(bits & 7)
+        np->key[bytes - 1] &= (uint8_t)(0xff << (8 - (bits & 7)));
+    if(entry)
+        ++entries;
+    return np;
+}
+
+void cidrmap::snapshot::insert(node **root, const uint8_t *key, unsigned bits, const cidr *entry)
+{
+    node *np, *branch;
+    unsigned common;
+
+    for(;;) {
+        np = *root;
+        if(!np) {
+            *root = create(key, bits, entry);
+            return;
+        }
+
+        common = cidr_common(key, np->key, bits < np->bits ? bits : np->bits);
+        if(common == np->bits) {
+            if(bits == np->bits) {
+                if(!np->entry) {
+                    np->entry = entry;
+                    ++entries;
+                }
+                return;
+            }
+            root = &np->child[cidr_bit(key, np->bits)];
+            continue;
+        }
+
+        // the new prefix covers the node, or they part at a branch
+        if(common == bits) {
+            branch = create(key, bits, entry);
+            branch->child[cidr_bit(np->key, bits)] = np;
+        }
+        else {
+            branch = create(key, common, NULL);
+            branch->child[cidr_bit(np->key, common)] = np;
+            branch->child[cidr_bit(key, common)] = create(key, bits, entry);
+        }
+        *root = branch;
+        return;
+    }
+}
+
+const cidrmap::snapshot::node *cidrmap::snapshot::root(const snapshot *snap, const struct sockaddr *s, const uint8_t **key, unsigned *max)
+{
+    const struct sockaddr_internet *addr = (const struct sockaddr_internet *)s;
+
+    if(!snap)
+        return NULL;
+
+    switch(addr->address.sa_family) {
+    case AF_INET:
+        *key = (const uint8_t *)&addr->ipv4.sin_addr;
+        *max = 32;
+        return snap->ipv4;
+#ifdef  AF_INET6
+    case AF_INET6:
+        *key = (const uint8_t *)&addr->ipv6.sin6_addr;
+        *max = 128;
+        return snap->ipv6;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+cidrmap::cidrmap()
+{
+    current = NULL;
+}
+
+cidrmap::cidrmap(const cidr::policy *policy)
+{
+    current = NULL;
+    if(policy)
+        current = new snapshot(policy);
+}
+
+cidrmap::~cidrmap()
+{
+    delete (snapshot *)current;
+}
+
+void cidrmap::set(const cidr::policy *policy)
+{
+    snapshot *snap = NULL, *prior;
+
+    if(policy)
+        snap = new snapshot(policy);
+
+    // rebuilds are serialized by a lock lookups never take, since we
+    // hold it while waiting for them...
+    while(!writer.acquire())
+        Thread::yield();
+
+    prior = (snapshot *)current;
+    atomic::store(&current, snap);
+
+    // lookups in the old epoch may still be using the prior snapshot
+    readers.synchronize();
+    writer.release();
+
+    delete prior;
+}
+
+unsigned cidrmap::count(void) const
+{
+    unsigned reader = readers.enter();
+    snapshot *snap = (snapshot *)atomic::load(&current);
+    unsigned total = 0;
+
+    if(snap)
+        total = snap->entries;
+    readers.leave(reader);
+    return total;
+}
+
+const cidr *cidrmap::find(const struct sockaddr *s) const
+{
+    assert(s != NULL);
+
+    unsigned reader = readers.enter();
+    const uint8_t *key = NULL;
+    unsigned max = 0;
+    const cidr *member = NULL;
+    const snapshot::node *np = snapshot::root((const snapshot *)atomic::load(&current), s, &key, &max);
+
+    // the deepest entry on the path is the smallest match, but like
+    // cidr::find, a 0 bit cidr is never a match...
+    while(np && cidr_prefixed(key, np->key, np->bits)) {
+        if(np->entry && np->bits)
+            member = np->entry;
+        if(np->bits >= max)
+            break;
+        np = np->child[cidr_bit(key, np->bits)];
+    }
+
+    readers.leave(reader);
+    return member;
+}
+
+const cidr *cidrmap::container(const struct sockaddr *s) const
+{
+    assert(s != NULL);
+
+    unsigned reader = readers.enter();
+    const uint8_t *key = NULL;
+    unsigned max = 0;
+    const cidr *member = NULL;
+    const snapshot::node *np = snapshot::root((const snapshot *)atomic::load(&current), s, &key, &max);
+
+    // the first entry on the path is the largest, and like cidr::container
+    // a 128 bit cidr is never a container...
+    while(np && cidr_prefixed(key, np->key, np->bits)) {
+        if(np->entry && np->bits < 128) {
+            member = np->entry;
+            break;
+        }
+        if(np->bits >= max)
+            break;
+        np = np->child[cidr_bit(key, np->bits)];
+    }
+
+    readers.leave(reader);
+    return member;
+}
+
 Socket::address::address(int family, const char *a, int type, int protocol)
 {
     assert(a != NULL && *a != 0);
@@ -1635,6 +1911,7 @@ size_t Socket::address::print(const sockaddr* addr, char *dst, size_t dst_sz, bo
 
 Socket::Socket(const Socket &s)
 {
+    reader = NULL;
 #ifdef  _MSWINDOWS_
     HANDLE pidH = GetCurrentProcess();
     HANDLE dupH;
@@ -1653,6 +1930,7 @@ Socket::Socket(const Socket &s)
 
 Socket::Socket()
 {
+    reader = NULL;
     so = INVALID_SOCKET;
     iowait = Timer::inf;
     ioerr = 0;
@@ -1660,6 +1938,7 @@ Socket::Socket()
 
 Socket::Socket(const socket_t s)
 {
+    reader = NULL;
     so = s;
     iowait = Timer::inf;
     ioerr = 0;
@@ -1667,6 +1946,7 @@ Socket::Socket(const socket_t s)
 
 Socket::Socket(const struct addrinfo *addr)
 {
+    reader = NULL;
 #ifdef  _MSWINDOWS_
     init();
 #endif
@@ -1688,6 +1968,7 @@ Socket::Socket(const struct addrinfo *addr)
 
 Socket::Socket(int family, int type, int protocol)
 {
+    reader = NULL;
     so = create(family, type, protocol);
     iowait = Timer::inf;
     ioerr = 0;
@@ -1695,6 +1976,7 @@ Socket::Socket(int family, int type, int protocol)
 
 Socket::Socket(const char *iface, const char *port, int family, int type, int protocol)
 {
+    reader = NULL;
     assert(iface != NULL && *iface != 0);
     assert(port != NULL && *port != 0);
 
@@ -1792,6 +2074,10 @@ socket_t Socket::create(const char *iface, const char *port, int family, int typ
 Socket::~Socket()
 {
     release();
+    if(reader) {
+        delete reader;
+        reader = NULL;
+    }
 }
 
 socket_t Socket::create(int family, int type, int protocol)
@@ -1829,6 +2115,9 @@ void Socket::release(socket_t so)
 
 void Socket::release(void)
 {
+    if(reader)
+        reader->clear();
+
     if(so != INVALID_SOCKET) {
 #ifdef  _MSWINDOWS_
         ::closesocket(so);
@@ -1944,6 +2233,9 @@ size_t Socket::peek(void *data, size_t len) const
     assert(data != NULL);
     assert(len > 0);
 
+    if(reader && reader->pending())
+        return reader->peek(data, len);
+
     if(iowait && iowait != Timer::inf && !Socket::wait(so, iowait))
         return 0;
 
@@ -1976,6 +2268,13 @@ size_t Socket::readfrom(void *data, size_t len, struct sockaddr_storage *from)
     assert(data != NULL);
     assert(len > 0);
 
+    // line read ahead comes first, and came from our connected peer...
+    if(reader && reader->pending()) {
+        if(from)
+            Socket::remote(so, from);
+        return (size_t)reader->read(so, data, len);
+    }
+
     // wait for input by timer if possible...
     if(iowait && iowait != Timer::inf && !Socket::wait(so, iowait))
         return 0;
@@ -2019,6 +2318,33 @@ ssize_t Socket::sendto(socket_t so, const void *data, size_t dlen, int flags, co
     return _sendto_(so, (caddr_t)data, dlen, MSG_NOSIGNAL | flags, dest, slen);
 }
 
+ssize_t Socket::sendv(socket_t so, const struct iovec *vector, unsigned count, int flags)
+{
+    assert(vector != NULL);
+
+#if defined(_MSWINDOWS_) || defined(HAVE_SOCKS) || defined(__PTH__)
+    ssize_t total = 0, result;
+
+    while(count--) {
+        result = _sendto_(so, (caddr_t)vector->iov_base, vector->iov_len, MSG_NOSIGNAL | flags, NULL, 0);
+        if(result < 0)
+            return total ? total : -1;
+        total += result;
+        if((size_t)result < vector->iov_len)
+            break;
+        ++vector;
+    }
+    return total;
+#else
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = (struct iovec *)vector;
+    msg.msg_iovlen = count;
+    return ::sendmsg(so, &msg, MSG_NOSIGNAL | flags);
+#endif
+}
+
 size_t Socket::writes(const char *str)
 {
     if(!str)
@@ -2030,19 +2356,45 @@ size_t Socket::writes(const char *str)
     return writeto(str, strlen(str), NULL);
 }
 
+// copy a buffered line, dropping its newline like the peeking readline
+static size_t lineout(char *data, const char *line, size_t size)
+{
+    size_t len = size;
+
+    if(len && line[len - 1] == '\n') {
+        --len;
+        if(len && line[len - 1] == '\r') {
+            --len;
+            --size;
+        }
+    }
+    memcpy(data, line, len);
+    data[len] = 0;
+    return size;
+}
+
 size_t Socket::readline(char *data, size_t max)
 {
     assert(data != NULL);
     assert(max > 0);
 
+    const char *line;
+
     *data = 0;
+    if(max < 2)
+        return 0;
 
-    ssize_t result = Socket::readline(so, data, max, iowait);
+    if(!reader)
+        reader = new LineReader(max > 2048 ? max : 2048);
+    else
+        reader->reserve(max);
+
+    ssize_t result = reader->getline(so, &line, max - 1, iowait);
     if(result < 0) {
         ioerr = Socket::error();
         return 0;
     }
-    return (size_t)result;
+    return lineout(data, line, (size_t)result);
 }
 
 size_t Socket::readline(String& s)
@@ -2050,14 +2402,131 @@ size_t Socket::readline(String& s)
     if(!s.c_mem())
         return 0;
 
-    ssize_t result = Socket::readline(so, s.c_mem(), s.size() + 1, iowait);
-    if(result < 0) {
-        ioerr = Socket::error();
-        s.clear();
-        return 0;
-    }
+    size_t result = readline(s.c_mem(), s.size() + 1);
     String::fix(s);
-    return (size_t)result;
+    return result;
+}
+
+LineReader::LineReader(size_t size)
+{
+    assert(size > 0);
+
+    bufsize = size;
+    buffer = (char *)cpr_memalloc(size);
+    head = tail = scan = 0;
+}
+
+LineReader::~LineReader()
+{
+    if(buffer) {
+        free(buffer);
+        buffer = NULL;
+    }
+}
+
+void LineReader::reserve(size_t size)
+{
+    if(size <= bufsize)
+        return;
+
+    char *grow = (char *)cpr_memalloc(size);
+    memcpy(grow, buffer + head, tail - head);
+    free(buffer);
+    buffer = grow;
+    tail -= head;
+    scan -= head;
+    head = 0;
+    bufsize = size;
+}
+
+ssize_t LineReader::take(const char **line, size_t size)
+{
+    *line = buffer + head;
+    head += size;
+    if(scan < head)
+        scan = head;
+    if(head == tail)
+        head = tail = scan = 0;
+    return (ssize_t)size;
+}
+
+ssize_t LineReader::getline(socket_t so, const char **line, size_t max, timeout_t timeout, char delim)
+{
+    assert(line != NULL);
+
+    size_t end;
+    ssize_t result;
+    const char *found;
+
+    *line = NULL;
+    if(!max || max > bufsize)
+        max = bufsize;
+
+    for(;;) {
+        // only search what has arrived since the last search
+        end = tail;
+        if(end > head + max)
+            end = head + max;
+        if(scan < end) {
+            found = (const char *)memchr(buffer + scan, delim, end - scan);
+            if(found)
+                return take(line, (size_t)(found - (buffer + head)) + 1);
+            scan = end;
+        }
+
+        if(tail - head >= max)
+            return take(line, max);
+
+        if(tail >= bufsize) {
+            memmove(buffer, buffer + head, tail - head);
+            tail -= head;
+            scan -= head;
+            head = 0;
+        }
+
+        if(timeout && !Socket::wait(so, timeout))
+            return 0;
+
+        result = _recv_(so, buffer + tail, bufsize - tail, 0);
+        if(result < 0)
+            return -1;
+
+        if(!result) {
+            if(tail > head)
+                return take(line, tail - head);
+            return 0;
+        }
+        tail += (size_t)result;
+    }
+}
+
+ssize_t LineReader::read(socket_t so, void *data, size_t size)
+{
+    assert(data != NULL);
+
+    size_t avail = tail - head;
+
+    if(!avail)
+        return _recv_(so, (caddr_t)data, size, 0);
+
+    if(size > avail)
+        size = avail;
+
+    const char *from;
+    memcpy(data, buffer + head, size);
+    take(&from, size);
+    return (ssize_t)size;
+}
+
+size_t LineReader::peek(void *data, size_t size) const
+{
+    assert(data != NULL);
+
+    if(size > tail - head)
+        size = tail - head;
+
+    memcpy(data, buffer + head, size);
+    return size;
 }
 
 ssize_t Socket::readline(socket_t so, char *data, size_t max, timeout_t timeout)
@@ -2723,9 +3192,20 @@ socket_t Socket::acceptfrom(socket_t so, struct sockaddr_storage *addr)
 
 bool Socket::wait(timeout_t timeout) const
 {
+    if(reader && reader->pending())
+        return true;
+
     return wait(so, timeout);
 }
 
+unsigned Socket::pending(void) const
+{
+    if(reader)
+        return pending(so) + (unsigned)reader->pending();
+
+    return pending(so);
+}
+
 bool Socket::wait(socket_t so, timeout_t timeout)
 {
     int status;
@@ -3545,6 +4025,207 @@ String str(Socket& so, strsize_t size)
     return s;
 }
 
+#if defined(HAVE_RECVMMSG) && defined(HAVE_SENDMMSG) && !defined(HAVE_SOCKS) && !defined(__PTH__) && !defined(_MSWINDOWS_)
+#define MMSG_BATCH
+#endif
+
+static size_t batch_align(size_t size)
+{
+    return (size + 15) & ~((size_t)15);
+}
+
+DatagramBatch::DatagramBatch(unsigned count, size_t size)
+{
+    assert(count > 0);
+    assert(size > 0);
+
+    size_t offset = 0, total = batch_align(sizeof(struct sockaddr_storage) * count) +
+        batch_align(sizeof(size_t) * count) + size * count;
+
+#ifdef  MMSG_BATCH
+    total += batch_align(sizeof(struct mmsghdr) * count) +
+        batch_align(sizeof(struct iovec) * count);
+#endif
+
+    limit = count;
+    used = 0;
+    bufsize = size;
+    arena = (caddr_t)cpr_memalloc(total);
+
+    peers = (struct sockaddr_storage *)arena;
+    offset += batch_align(sizeof(struct sockaddr_storage) * count);
+    sizes = (size_t *)(arena + offset);
+    offset += batch_align(sizeof(size_t) * count);
+    headers = NULL;
+
+#ifdef  MMSG_BATCH
+    struct mmsghdr *msgs = (struct mmsghdr *)(arena + offset);
+    offset += batch_align(sizeof(struct mmsghdr) * count);
+    struct iovec *vector = (struct iovec *)(arena + offset);
+    offset += batch_align(sizeof(struct iovec) * count);
+    headers = msgs;
+#endif
+
+    buffers = arena + offset;
+
+#ifdef  MMSG_BATCH
+    memset(msgs, 0, sizeof(struct mmsghdr) * count);
+    for(unsigned index = 0; index < count; ++index) {
+        vector[index].iov_base = data(index);
+        msgs[index].msg_hdr.msg_iov = &vector[index];
+        msgs[index].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+}
+
+DatagramBatch::~DatagramBatch()
+{
+    if(arena) {
+        free(arena);
+        arena = NULL;
+    }
+}
+
+void DatagramBatch::remove(unsigned count)
+{
+    if(count >= used) {
+        used = 0;
+        return;
+    }
+
+    used -= count;
+    memmove(buffers, data(count), used * bufsize);
+    memmove(sizes, sizes + count, used * sizeof(size_t));
+    memmove(peers, peers + count, used * sizeof(struct sockaddr_storage));
+}
+
+const struct sockaddr *DatagramBatch::peer(unsigned index) const
+{
+    assert(index < used);
+
+    if(peers[index].ss_family == AF_UNSPEC)
+        return NULL;
+
+    return (const struct sockaddr *)&peers[index];
+}
+
+void DatagramBatch::set(unsigned index, const struct sockaddr *address)
+{
+    assert(index < used);
+
+    if(!address)
+        peers[index].ss_family = AF_UNSPEC;
+    else
+        memcpy(&peers[index], address, Socket::len(address));
+}
+
+void DatagramBatch::resize(unsigned index, size_t size)
+{
+    assert(index < used);
+    assert(size <= bufsize);
+
+    sizes[index] = size;
+}
+
+bool DatagramBatch::put(const void *buffer, size_t size, const struct sockaddr *address)
+{
+    assert(buffer != NULL || !size);
+
+    if(used >= limit || size > bufsize)
+        return false;
+
+    memcpy(data(used), buffer, size);
+    sizes[used++] = size;
+    set(used - 1, address);
+    return true;
+}
+
+unsigned DatagramBatch::receive(socket_t so, int flags)
+{
+    used = 0;
+
+#ifdef  MMSG_BATCH
+    struct mmsghdr *msgs = (struct mmsghdr *)headers;
+
+    for(unsigned index = 0; index < limit; ++index) {
+        msgs[index].msg_hdr.msg_name = &peers[index];
+        msgs[index].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+        msgs[index].msg_hdr.msg_iov->iov_len = bufsize;
+        msgs[index].msg_hdr.msg_flags = 0;
+    }
+
+    // wait for the first datagram only, then take what is queued
+    int result = ::recvmmsg(so, msgs, limit, MSG_WAITFORONE | flags, NULL);
+    if(result < 1)
+        return 0;
+
+    while(used < (unsigned)result) {
+        sizes[used] = msgs[used].msg_len;
+        if(!msgs[used].msg_hdr.msg_namelen)
+            peers[used].ss_family = AF_UNSPEC;
+        ++used;
+    }
+#else
+    socklen_t slen;
+    ssize_t result;
+
+    while(used < limit) {
+        slen = sizeof(struct sockaddr_storage);
+        result = _recvfrom_(so, data(used), bufsize, flags, (struct sockaddr *)&peers[used], &slen);
+        if(result < 0)
+            break;
+        if(!slen)
+            peers[used].ss_family = AF_UNSPEC;
+        sizes[used++] = (size_t)result;
+#ifdef  MSG_DONTWAIT
+        flags |= MSG_DONTWAIT;
+#else
+        break;
+#endif
+    }
+#endif
+    return used;
+}
+
+unsigned DatagramBatch::send(socket_t so, int flags, const struct sockaddr *address)
+{
+    const struct sockaddr *dest;
+    unsigned sent = 0;
+
+#ifdef  MMSG_BATCH
+    struct mmsghdr *msgs = (struct mmsghdr *)headers;
+    int result;
+
+    for(unsigned index = 0; index < used; ++index) {
+        dest = peer(index);
+        if(!dest)
+            dest = address;
+        msgs[index].msg_hdr.msg_name = (void *)dest;
+        msgs[index].msg_hdr.msg_namelen = Socket::len(dest);
+        msgs[index].msg_hdr.msg_iov->iov_len = sizes[index];
+        msgs[index].msg_hdr.msg_flags = 0;
+    }
+
+    while(sent < used) {
+        result = ::sendmmsg(so, msgs + sent, used - sent, MSG_NOSIGNAL | flags);
+        if(result < 1)
+            break;
+        sent += (unsigned)result;
+    }
+#else
+    while(sent < used) {
+        dest = peer(sent);
+        if(!dest)
+            dest = address;
+        if(_sendto_(so, data(sent), sizes[sent], MSG_NOSIGNAL | flags, dest, Socket::len(dest)) < 0)
+            break;
+        ++sent;
+    }
+#endif
+    remove(sent);
+    return sent;
+}
+
 struct sockaddr *_getaddrinfo(struct addrinfo *list)
 {
     return list->ai_addr;
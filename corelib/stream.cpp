@@ -191,6 +191,11 @@ ssize_t tcpstream::_write(const char *buffer, size_t size)
     return Socket::sendto(so, buffer, size);
 }
 
+ssize_t tcpstream::_writev(const struct iovec *vector, unsigned count)
+{
+    return Socket::sendv(so, vector, count);
+}
+
 int tcpstream::underflow(void)
 {
     ssize_t rlen = 1;
@@ -351,6 +356,55 @@ void tcpstream::close(void)
     Socket::disconnect(so);
 }
 
+std::streamsize tcpstream::xsputn(const char *data, std::streamsize size)
+{
+    struct iovec vector[2];
+    size_t pending = 0, total = 0;
+    ssize_t rlen;
+    unsigned count;
+
+    if(!bufsize)
+        return 0;
+
+    if(pbase()) {
+        pending = (size_t)(pptr() - pbase());
+        if(size < (std::streamsize)(epptr() - pptr()))
+            return std::streambuf::xsputn(data, size);
+    }
+
+    while(total < (size_t)size) {
+        count = 0;
+        if(pending) {
+            vector[count].iov_base = pbuf;
+            vector[count++].iov_len = pending;
+        }
+        vector[count].iov_base = (void *)(data + total);
+        vector[count++].iov_len = (size_t)size - total;
+
+        rlen = _writev(vector, count);
+        if(rlen < 1) {
+            if(rlen < 0)
+                reset();
+            break;
+        }
+
+        // partial write of pending output, rebuffer the remainder
+        if((size_t)rlen < pending) {
+            memmove(pbuf, pbuf + rlen, pending - rlen);
+            pending -= rlen;
+            continue;
+        }
+        total += (size_t)rlen - pending;
+        pending = 0;
+    }
+
+    if(pbuf) {
+        setp(pbuf, pbuf + bufsize);
+        pbump((int)pending);
+    }
+    return (std::streamsize)total;
+}
+
 void tcpstream::allocate(unsigned mss)
 {
     unsigned size = mss;
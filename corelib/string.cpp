@@ -26,6 +26,19 @@
 #endif
 #include <limits.h>
 
+// character lists are scanned a whole vector at a time where the cpu
+// supports it, rather than searching the list for every character...
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define STRING_SSE2
+#endif
+#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#include <immintrin.h>
+#define STRING_AVX2
+#endif
+#endif
+
 namespace ucommon {
 
 #if _MSC_VER > 1400        // windows broken dll linkage issue...
@@ -34,6 +47,344 @@ const strsize_t String::npos = (strsize_t)(-1);
 const size_t memstring::header = sizeof(cstring);
 #endif
 
+// a cstring held within the string object that owns it, which is never
+// shared, and so is never deleted when released...
+class __LOCAL smallstring : public String::cstring
+{
+public:
+    inline smallstring(strsize_t size) : String::cstring(size) {}
+
+    inline smallstring(strsize_t size, char fill) : String::cstring(size, fill) {}
+
+protected:
+    void dealloc(void) {}
+};
+
+// a character list as a membership bitmap, and as a table of which high
+// nibbles each low nibble is a member with, for vector lookup of ascii...
+class __LOCAL charset
+{
+public:
+    uint8_t map[32];
+    uint8_t nibbles[16];
+    char chars[4];
+    unsigned size;
+    bool ascii;
+
+    charset(const char *list);
+
+    inline bool is(char ch) const
+        {return ((map[(uint8_t)ch >> 3] >> ((uint8_t)ch & 7)) & 1) != 0;}
+};
+
+charset::charset(const char *list)
+{
+    memset(map, 0, sizeof(map));
+    memset(nibbles, 0, sizeof(nibbles));
+    size = 0;
+    ascii = true;
+
+    while(list && *list) {
+        uint8_t ch = (uint8_t)*(list++);
+        if(is((char)ch))
+            continue;
+        map[ch >> 3] |= (uint8_t)(1 << (ch & 7));
+        if(ch & 0x80)
+            ascii = false;
+        else
+            nibbles[ch & 0x0f] |= (uint8_t)(1 << (ch >> 4));
+        if(size < 4)
+            chars[size] = (char)ch;
+        ++size;
+    }
+}
+
+#ifdef  STRING_AVX2
+static const uint8_t highbits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 0, 0, 0, 0, 0, 0, 0, 0};
+
+static bool avx2_cpu(void)
+{
+    static volatile int detected = -1;
+
+    if(detected < 0) {
+        __builtin_cpu_init();
+        detected = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return detected > 0;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i avx2_table(const uint8_t *table)
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+}
+
+__attribute__((target("avx2")))
+static inline unsigned avx2_mask(__m256i v, __m256i lo, __m256i hi)
+{
+    __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i low = _mm256_and_si256(v, nibble);
+    __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+    __m256i bits = _mm256_and_si256(_mm256_shuffle_epi8(lo, low), _mm256_shuffle_epi8(hi, high));
+
+    return ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bits, _mm256_setzero_si256()));
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_scan(const char *text, size_t len, const charset& set, bool want)
+{
+    __m256i lo = avx2_table(set.nibbles), hi = avx2_table(highbits);
+    unsigned flip = want ? 0 : ~0u, mask;
+    size_t pos = 0;
+
+    while(pos + 32 <= len) {
+        mask = avx2_mask(_mm256_loadu_si256((const __m256i *)(text + pos)), lo, hi) ^ flip;
+        if(mask)
+            return pos + __builtin_ctz(mask);
+        pos += 32;
+    }
+    while(pos < len && set.is(text[pos]) != want)
+        ++pos;
+    return pos;
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_rscan(const char *text, size_t len, const charset& set, bool want)
+{
+    __m256i lo = avx2_table(set.nibbles), hi = avx2_table(highbits);
+    unsigned flip = want ? 0 : ~0u, mask;
+
+    while(len >= 32) {
+        mask = avx2_mask(_mm256_loadu_si256((const __m256i *)(text + len - 32)), lo, hi) ^ flip;
+        if(mask)
+            return len - __builtin_clz(mask);
+        len -= 32;
+    }
+    while(len && set.is(text[len - 1]) != want)
+        --len;
+    return len;
+}
+
+// aligned loads never cross into a page the string does not touch
+__attribute__((target("avx2")))
+static const char *avx2_zscan(const char *text, const charset& set, bool want)
+{
+    __m256i lo = avx2_table(set.nibbles), hi = avx2_table(highbits);
+    __m256i zero = _mm256_setzero_si256(), v;
+    unsigned flip = want ? 0 : ~0u, mask;
+    unsigned offset = (unsigned)((size_t)text & 31);
+    const char *block = text - offset;
+
+    for(;;) {
+        v = _mm256_load_si256((const __m256i *)block);
+        mask = (avx2_mask(v, lo, hi) ^ flip) | (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+        mask &= ~0u << offset;
+        if(mask)
+            return block + __builtin_ctz(mask);
+        block += 32;
+        offset = 0;
+    }
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_tally(const char *text, size_t len, const charset& set)
+{
+    __m256i lo = avx2_table(set.nibbles), hi = avx2_table(highbits);
+    size_t pos = 0, count = 0;
+
+    while(pos + 32 <= len) {
+        count += __builtin_popcount(avx2_mask(_mm256_loadu_si256((const __m256i *)(text + pos)), lo, hi));
+        pos += 32;
+    }
+    while(pos < len) {
+        if(set.is(text[pos++]))
+            ++count;
+    }
+    return count;
+}
+#endif
+
+#ifdef  STRING_SSE2
+// without a byte shuffle, only short lists are compared a vector at a time
+static inline unsigned sse2_mask(__m128i v, const __m128i *chars, unsigned size)
+{
+    __m128i match = _mm_cmpeq_epi8(v, chars[0]);
+
+    for(unsigned pos = 1; pos < size; ++pos)
+        match = _mm_or_si128(match, _mm_cmpeq_epi8(v, chars[pos]));
+    return (unsigned)_mm_movemask_epi8(match);
+}
+
+static inline void sse2_chars(__m128i *chars, const charset& set)
+{
+    for(unsigned pos = 0; pos < set.size; ++pos)
+        chars[pos] = _mm_set1_epi8(set.chars[pos]);
+}
+
+static size_t sse2_scan(const char *text, size_t len, const charset& set, bool want)
+{
+    __m128i chars[4];
+    unsigned flip = want ? 0 : 0xffff, mask;
+    size_t pos = 0;
+
+    sse2_chars(chars, set);
+    while(pos + 16 <= len) {
+        mask = sse2_mask(_mm_loadu_si128((const __m128i *)(text + pos)), chars, set.size) ^ flip;
+        if(mask)
+            return pos + __builtin_ctz(mask);
+        pos += 16;
+    }
+    while(pos < len && set.is(text[pos]) != want)
+        ++pos;
+    return pos;
+}
+
+static size_t sse2_rscan(const char *text, size_t len, const charset& set, bool want)
+{
+    __m128i chars[4];
+    unsigned flip = want ? 0 : 0xffff, mask;
+
+    sse2_chars(chars, set);
+    while(len >= 16) {
+        mask = sse2_mask(_mm_loadu_si128((const __m128i *)(text + len - 16)), chars, set.size) ^ flip;
+        if(mask)
+            return len + 16 - __builtin_clz(mask);
+        len -= 16;
+    }
+    while(len && set.is(text[len - 1]) != want)
+        --len;
+    return len;
+}
+
+static const char *sse2_zscan(const char *text, const charset& set, bool want)
+{
+    __m128i chars[4], zero = _mm_setzero_si128(), v;
+    unsigned flip = want ? 0 : 0xffff, mask;
+    unsigned offset = (unsigned)((size_t)text & 15);
+    const char *block = text - offset;
+
+    sse2_chars(chars, set);
+    for(;;) {
+        v = _mm_load_si128((const __m128i *)block);
+        mask = (sse2_mask(v, chars, set.size) ^ flip) | (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        mask &= 0xffff << offset;
+        if(mask)
+            return block + __builtin_ctz(mask);
+        block += 16;
+        offset = 0;
+    }
+}
+
+static size_t sse2_tally(const char *text, size_t len, const charset& set)
+{
+    __m128i chars[4];
+    size_t pos = 0, count = 0;
+
+    sse2_chars(chars, set);
+    while(pos + 16 <= len) {
+        count += __builtin_popcount(sse2_mask(_mm_loadu_si128((const __m128i *)(text + pos)), chars, set.size));
+        pos += 16;
+    }
+    while(pos < len) {
+        if(set.is(text[pos++]))
+            ++count;
+    }
+    return count;
+}
+#endif
+
+// offset of first character that is (or is not) in the set, or len
+static size_t scan(const char *text, size_t len, const charset& set, bool want)
+{
+    size_t pos = 0;
+
+#ifdef  STRING_AVX2
+    if(len >= 32 && set.ascii && avx2_cpu())
+        return avx2_scan(text, len, set, want);
+#endif
+#ifdef  STRING_SSE2
+    if(len >= 16 && set.size && set.size <= 4)
+        return sse2_scan(text, len, set, want);
+#endif
+    while(pos < len && set.is(text[pos]) != want)
+        ++pos;
+    return pos;
+}
+
+// one past the offset of the last character that is (or is not) in the
+// set, or 0 if there is none
+static size_t rscan(const char *text, size_t len, const charset& set, bool want)
+{
+#ifdef  STRING_AVX2
+    if(len >= 32 && set.ascii && avx2_cpu())
+        return avx2_rscan(text, len, set, want);
+#endif
+#ifdef  STRING_SSE2
+    if(len >= 16 && set.size && set.size <= 4)
+        return sse2_rscan(text, len, set, want);
+#endif
+    while(len && set.is(text[len - 1]) != want)
+        --len;
+    return len;
+}
+
+// first character that is (or is not) in the set, or the end of string
+static const char *zscan(const char *text, const charset& set, bool want)
+{
+#ifdef  STRING_AVX2
+    if(set.ascii && avx2_cpu())
+        return avx2_zscan(text, set, want);
+#endif
+#ifdef  STRING_SSE2
+    if(set.size && set.size <= 4)
+        return sse2_zscan(text, set, want);
+#endif
+    while(*text && set.is(*text) != want)
+        ++text;
+    return text;
+}
+
+static size_t tally(const char *text, size_t len, const charset& set)
+{
+    size_t count = 0;
+
+#ifdef  STRING_AVX2
+    if(len >= 32 && set.ascii && avx2_cpu())
+        return avx2_tally(text, len, set);
+#endif
+#ifdef  STRING_SSE2
+    if(len >= 16 && set.size && set.size <= 4)
+        return sse2_tally(text, len, set);
+#endif
+    while(len--) {
+        if(set.is(*(text++)))
+            ++count;
+    }
+    return count;
+}
+
+// case insensitive search, scanning for either case of the first character
+static const char *isearch(const char *text, const char *key)
+{
+    size_t len = strlen(key);
+    char first[3];
+
+    if(!len)
+        return text;
+
+    first[0] = (char)tolower((uint8_t)*key);
+    first[1] = (char)toupper((uint8_t)*key);
+    first[2] = 0;
+
+    charset set(first);
+    while(*(text = zscan(text, set, true))) {
+        if(!String::case_compare(text, key, len))
+            return text;
+        ++text;
+    }
+    return NULL;
+}
+
 String::cstring::cstring(strsize_t size) :
 CountedObject()
 {
@@ -54,6 +405,7 @@ CountedObject()
         memset(text, fill, max);
         len = max;
     }
+    text[len] = 0;
 }
 
 void String::cstring::fix(void)
@@ -242,7 +594,7 @@ String::String(const char *s, const char *end)
         size = strlen(s);
     else if(end > s)
         size = (strsize_t)(end - s);
-    str = create(size);
+    str = make(size);
     str->retain();
     str->set(s);
 }
@@ -252,7 +604,7 @@ String::String(const char *s)
     strsize_t size = count(s);
     if(!s)
         s = "";
-    str = create(size);
+    str = make(size);
     str->retain();
     str->set(s);
 }
@@ -263,20 +615,20 @@ String::String(const char *s, strsize_t size)
         s = "";
     if(!size)
         size = strlen(s);
-    str = create(size);
+    str = make(size);
     str->retain();
     str->set(s);
 }
 
 String::String(strsize_t size)
 {
-    str = create(size);
+    str = make(size);
     str->retain();
 }
 
 String::String(long value)
 {
-    str = create(20);
+    str = make(20);
     str->retain();
     snprintf(&str->text[0], 20, "%ld", value);
     str->len = strlen(str->text);
@@ -285,7 +637,7 @@ String::String(long value)
 
 String::String(double value)
 {
-    str = create(32);
+    str = make(32);
     str->retain();
     snprintf(&str->text[0], 32, "%f", value);
     str->len = strlen(str->text);
@@ -294,7 +646,7 @@ String::String(double value)
 
 String::String(strsize_t size, char fill)
 {
-    str = create(size, fill);
+    str = make(size, fill);
     str->retain();
 }
 
@@ -305,7 +657,7 @@ String::String(strsize_t size, const char *format, ...)
     va_list args;
     va_start(args, format);
 
-    str = create(size);
+    str = make(size);
     str->retain();
     vsnprintf(str->text, size + 1, format, args);
     va_end(args);
@@ -314,6 +666,8 @@ String::String(strsize_t size, const char *format, ...)
 String::String(const String &dup)
 {
     str = dup.c_copy();
+    if(str && dup.is_small())
+        str = clone(str);
     if(str)
         str->retain();
 }
@@ -346,6 +700,47 @@ String::cstring *String::create(strsize_t size, char fill) const
         return new((size_t)size) cstring(size);
 }
 
+String::cstring *String::make(strsize_t size, char fill)
+{
+    // our own storage may still hold the cstring being replaced...
+    if(size > SMALL || is_small())
+        return create(size, fill);
+
+    if(fill)
+        return new((caddr_t)(local.data)) smallstring(size, fill);
+    else
+        return new((caddr_t)(local.data)) smallstring(size);
+}
+
+String::cstring *String::clone(const cstring *from)
+{
+    cstring *s = make(from->max);
+    memcpy(s->text, from->text, from->len + 1);
+    s->len = from->len;
+    s->fill = from->fill;
+    return s;
+}
+
+void String::take(String& from)
+{
+    cstring *s = from.c_copy();
+
+    if(!s)
+        return;
+
+    if(s != from.str || from.is_small()) {
+        if(s == from.str)
+            s = clone(s);
+        str = s;
+        str->retain();
+        return;
+    }
+
+    // we inherit the reference the other object held...
+    str = s;
+    from.str = NULL;
+}
+
 void String::retain(void)
 {
     if(str)
@@ -450,11 +845,10 @@ const char *String::skip(const char *clist, strsize_t offset) const
     if(!str || !clist || !*clist || !str->len || offset > str->len)
         return NULL;
 
-    while(offset < str->len) {
-        if(!strchr(clist, str->text[offset]))
-            return str->text + offset;
-        ++offset;
-    }
+    charset set(clist);
+    offset += (strsize_t)scan(str->text + offset, str->len - offset, set, false);
+    if(offset < str->len)
+        return str->text + offset;
     return NULL;
 }
 
@@ -469,10 +863,10 @@ const char *String::rskip(const char *clist, strsize_t offset) const
     if(offset > str->len)
         offset = str->len;
 
-    while(offset--) {
-        if(!strchr(clist, str->text[offset]))
-            return str->text + offset;
-    }
+    charset set(clist);
+    offset = (strsize_t)rscan(str->text, offset, set, false);
+    if(offset)
+        return str->text + offset - 1;
     return NULL;
 }
 
@@ -487,10 +881,10 @@ const char *String::rfind(const char *clist, strsize_t offset) const
     if(offset > str->len)
         offset = str->len;
 
-    while(offset--) {
-        if(strchr(clist, str->text[offset]))
-            return str->text + offset;
-    }
+    charset set(clist);
+    offset = (strsize_t)rscan(str->text, offset, set, true);
+    if(offset)
+        return str->text + offset - 1;
     return NULL;
 }
 
@@ -504,12 +898,8 @@ void String::chop(const char *clist)
     if(!str->len)
         return;
 
-    offset = str->len;
-    while(offset) {
-        if(!strchr(clist, str->text[offset - 1]))
-            break;
-        --offset;
-    }
+    charset set(clist);
+    offset = (strsize_t)rscan(str->text, str->len, set, false);
 
     if(!offset) {
         clear();
@@ -531,16 +921,13 @@ void String::strip(const char *clist)
 
 void String::trim(const char *clist)
 {
-    unsigned offset = 0;
+    strsize_t offset;
 
     if(!str)
         return;
 
-    while(offset < str->len) {
-        if(!strchr(clist, str->text[offset]))
-            break;
-        ++offset;
-    }
+    charset set(clist);
+    offset = (strsize_t)scan(str->text, str->len, set, false);
 
     if(!offset)
         return;
@@ -573,22 +960,14 @@ unsigned String::replace(const char *substring, const char *cp, unsigned flags)
 
     while(result) {
         const char *text = str->text + offset;
-#if defined(_MSWINDOWS_)
-        if((flags & 0x01) == INSENSITIVE)
-            result = strstr(text, substring);
-#elif  defined(HAVE_STRICMP)
-        if((flags & 0x01) == INSENSITIVE)
-            result = stristr(text, substring);
-#else
         if((flags & 0x01) == INSENSITIVE)
-            result = strcasestr(text, substring);
-#endif
+            result = isearch(text, substring);
         else
             result = strstr(text, substring);
 
         if(result) {
             ++count;
-            offset = text - str->text;
+            offset = result - str->text;
             cut(offset, tcl);
             if(cpl) {
                 paste(offset, cp);
@@ -611,21 +990,13 @@ const char *String::search(const char *substring, unsigned instance, unsigned fl
     if(!instance)
         ++instance;
     while(instance-- && result) {
-#if defined(_MSWINDOWS_)
-        if((flags & 0x01) == INSENSITIVE)
-            result = strstr(text, substring);
-#elif  defined(HAVE_STRICMP)
         if((flags & 0x01) == INSENSITIVE)
-            result = stristr(text, substring);
-#else
-        if((flags & 0x01) == INSENSITIVE)
-            result = strcasestr(text, substring);
-#endif
+            result = isearch(text, substring);
         else
             result = strstr(text, substring);
 
         if(result)
-            text = result + strlen(result);
+            text = result + strlen(substring);
     }
     return result;
 }
@@ -635,11 +1006,10 @@ const char *String::find(const char *clist, strsize_t offset) const
     if(!str || !clist || !*clist || !str->len || offset > str->len)
         return NULL;
 
-    while(offset < str->len) {
-        if(strchr(clist, str->text[offset]))
-            return str->text + offset;
-        ++offset;
-    }
+    charset set(clist);
+    offset += (strsize_t)scan(str->text + offset, str->len - offset, set, true);
+    if(offset < str->len)
+        return str->text + offset;
     return NULL;
 }
 
@@ -885,7 +1255,7 @@ void String::set(const char *s)
 
     if(!str) {
         len = strlen(s);
-        str = create(len);
+        str = make(len);
         str->retain();
     }
 
@@ -904,7 +1274,7 @@ void String::paste(strsize_t offset, const char *cp, strsize_t size)
         return;
 
     if(!str) {
-        str = create(size);
+        str = make(size);
         String::set(str->text, ++size, cp);
         str->len = --size;
         str->fix();
@@ -998,13 +1368,14 @@ bool String::resize(strsize_t size)
     }
 
     if(!str) {
-        str = create(size, fill);
+        str = make(size, fill);
         str->retain();
     }
     else if(str->is_copied() || str->max < size) {
         fill = str->fill;
         str->release();
-        str = create(size, fill);
+        str = NULL;
+        str = make(size, fill);
         str->retain();
     }
     return true;
@@ -1039,8 +1410,15 @@ void String::cow(strsize_t size)
     if(!size)
         return;
 
+    // a short string of our own can grow within the string object
+    if(is_small() && !str->fill && size <= SMALL) {
+        if(size > str->max)
+            str->max = size;
+        return;
+    }
+
     if(!str || !str->max || str->is_copied() || size > str->max) {
-        cstring *s = create(size);
+        cstring *s = make(size);
         s->len = str->len;
         String::set(s->text, s->max + 1, str->text);
         s->retain();
@@ -1219,6 +1597,15 @@ String &String::operator=(const String &s)
     if(str == s.str)
         return *this;
 
+    if(s.is_small()) {
+        if(str)
+            str->release();
+        str = NULL;
+        str = clone(s.str);
+        str->retain();
+        return *this;
+    }
+
     if(s.str)
         s.str->retain();
 
@@ -1402,8 +1789,8 @@ char *String::token(char *text, char **token, const char *clist, const char *quo
         return NULL;
     }
 
-    while(**token && strchr(clist, **token))
-        ++*token;
+    charset set(clist);
+    *token = (char *)zscan(*token, set, false);
 
     result = *token;
 
@@ -1436,8 +1823,7 @@ char *String::token(char *text, char **token, const char *clist, const char *quo
         return result;
     }
 
-    while(**token && !strchr(clist, **token))
-        ++(*token);
+    *token = (char *)zscan(*token, set, true);
 
     if(**token) {
         **token = 0;
@@ -1464,6 +1850,13 @@ void String::fix(String &s)
 
 void String::swap(String &s1, String &s2)
 {
+    if(s1.is_small() || s2.is_small()) {
+        String tmp(s1);
+        s1 = s2;
+        s2 = tmp;
+        return;
+    }
+
     String::cstring *s = s1.str;
     s1.str = s2.str;
     s2.str = s;
@@ -1531,60 +1924,45 @@ size_t String::count(const char *cp)
 
 const char *String::find(const char *str, const char *key, const char *delim)
 {
-    unsigned l1 = strlen(str);
-    unsigned l2 = strlen(key);
+    if(!delim || !delim[0])
+        return strstr(str, key);
 
-    if(!delim[0])
-        delim = NULL;
+    size_t l1 = strlen(str);
+    size_t l2 = strlen(key);
+    const char *next;
 
+    // keys are only matched at the start of each delimited word...
+    charset set(delim);
     while(l1 >= l2) {
         if(!strncmp(key, str, l2)) {
-            if(l1 == l2 || !delim || strchr(delim, str[l2]))
+            if(l1 == l2 || set.is(str[l2]))
                 return str;
         }
-        if(!delim) {
-            ++str;
-            --l1;
-            continue;
-        }
-        while(l1 >= l2 && !strchr(delim, *str)) {
-            ++str;
-            --l1;
-        }
-        while(l1 >= l2 && strchr(delim, *str)) {
-            ++str;
-            --l1;
-        }
+        next = zscan(zscan(str, set, true), set, false);
+        l1 -= next - str;
+        str = next;
     }
     return NULL;
 }
 
 const char *String::ifind(const char *str, const char *key, const char *delim)
 {
-    unsigned l1 = strlen(str);
-    unsigned l2 = strlen(key);
+    if(!delim || !delim[0])
+        return isearch(str, key);
 
-    if(!delim[0])
-        delim = NULL;
+    size_t l1 = strlen(str);
+    size_t l2 = strlen(key);
+    const char *next;
 
+    charset set(delim);
     while(l1 >= l2) {
-        if(!strnicmp(key, str, l2)) {
-            if(l1 == l2 || !delim || strchr(delim, str[l2]))
+        if(!case_compare(key, str, l2)) {
+            if(l1 == l2 || set.is(str[l2]))
                 return str;
         }
-        if(!delim) {
-            ++str;
-            --l1;
-            continue;
-        }
-        while(l1 >= l2 && !strchr(delim, *str)) {
-            ++str;
-            --l1;
-        }
-        while(l1 >= l2 && strchr(delim, *str)) {
-            ++str;
-            --l1;
-        }
+        next = zscan(zscan(str, set, true), set, false);
+        l1 -= next - str;
+        str = next;
     }
     return NULL;
 }
@@ -1693,10 +2071,8 @@ char *String::trim(char *str, const char *clist)
     if(!clist)
         return str;
 
-    while(*str && strchr(clist, *str))
-        ++str;
-
-    return str;
+    charset set(clist);
+    return (char *)zscan(str, set, false);
 }
 
 char *String::chop(char *str, const char *clist)
@@ -1707,9 +2083,10 @@ char *String::chop(char *str, const char *clist)
     if(!clist)
         return str;
 
-    size_t offset = strlen(str);
-    while(offset && strchr(clist, str[offset - 1]))
-        str[--offset] = 0;
+    size_t len = strlen(str);
+    charset set(clist);
+    size_t offset = rscan(str, len, set, false);
+    memset(str + offset, 0, len - offset);
     return str;
 }
 
@@ -1746,12 +2123,11 @@ void String::erase(char *str)
 
 unsigned String::ccount(const char *str, const char *clist)
 {
-    unsigned count = 0;
-    while(str && *str) {
-        if(strchr(clist, *(str++)))
-            ++count;
-    }
-    return count;
+    if(!str || !clist)
+        return 0;
+
+    charset set(clist);
+    return (unsigned)tally(str, strlen(str), set);
 }
 
 char *String::skip(char *str, const char *clist)
@@ -1759,8 +2135,8 @@ char *String::skip(char *str, const char *clist)
     if(!str || !clist)
         return NULL;
 
-    while(*str && strchr(clist, *str))
-        ++str;
+    charset set(clist);
+    str = (char *)zscan(str, set, false);
 
     if(*str)
         return str;
@@ -1775,29 +2151,22 @@ char *String::rskip(char *str, const char *clist)
     if(!len || !clist)
         return NULL;
 
-    while(len > 0) {
-        if(!strchr(clist, str[--len]))
-            return str;
-    }
+    charset set(clist);
+    if(rscan(str, len, set, false))
+        return str;
     return NULL;
 }
 
 size_t String::seek(char *str, const char *clist)
 {
-    size_t pos = 0;
-
     if(!str)
         return 0;
 
     if(!clist)
         return strlen(str);
 
-    while(str[pos]) {
-        if(strchr(clist, str[pos]))
-            return pos;
-        ++pos;
-    }
-    return pos;
+    charset set(clist);
+    return zscan(str, set, true) - str;
 }
 
 char *String::find(char *str, const char *clist)
@@ -1808,10 +2177,10 @@ char *String::find(char *str, const char *clist)
     if(!clist)
         return str;
 
-    while(str && *str) {
-        if(strchr(clist, *str))
-            return str;
-    }
+    charset set(clist);
+    str = (char *)zscan(str, set, true);
+    if(*str)
+        return str;
     return NULL;
 }
 
@@ -1823,12 +2192,10 @@ char *String::rfind(char *str, const char *clist)
     if(!clist)
         return str + strlen(str);
 
-    char *s = str + strlen(str);
-
-    while(s > str) {
-        if(strchr(clist, *(--s)))
-            return s;
-    }
+    charset set(clist);
+    size_t offset = rscan(str, strlen(str), set, true);
+    if(offset)
+        return str + offset - 1;
     return NULL;
 }
 
@@ -1892,6 +2259,18 @@ bool String::eq_case(const char *s1, const char *s2, size_t size)
 #endif
 }
 
+unsigned String::hash_case(const char *s)
+{
+    unsigned hash = 2166136261u;
+
+    if(!s)
+        s = "";
+
+    while(*s)
+        hash = (hash ^ (unsigned)tolower((unsigned char)*(s++))) * 16777619u;
+    return hash;
+}
+
 bool String::equal(const char *s1, const char *s2)
 {
     if(!s1)
@@ -1975,6 +2354,8 @@ unsigned String::hexsize(const char *format)
     return count;
 }
 
+static const char hexdigits[] = "0123456789abcdef";
+
 unsigned String::hexdump(const unsigned char *binary, char *string, const char *format)
 {
     unsigned count = 0;
@@ -1991,8 +2372,8 @@ unsigned String::hexdump(const unsigned char *binary, char *string, const char *
             format = ep;
             count += skip * 2;
             while(skip--) {
-                snprintf(string, 3, "%02x", *(binary++));
-                string += 2;
+                *(string++) = hexdigits[*binary >> 4];
+                *(string++) = hexdigits[*(binary++) & 0x0f];
             }
         }
     }
@@ -2000,12 +2381,12 @@ unsigned String::hexdump(const unsigned char *binary, char *string, const char *
     return count;
 }
 
-static unsigned hex(char ch)
+static inline unsigned hex(char ch)
 {
     if(ch >= '0' && ch <= '9')
         return ch - '0';
     else
-        return toupper(ch) - 'A' + 10;
+        return (ch & ~0x20) - 'A' + 10;
 }
 
 unsigned String::hexpack(unsigned char *binary, const char *string, const char *format)
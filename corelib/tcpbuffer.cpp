@@ -23,19 +23,89 @@
 #include <ucommon/buffer.h>
 #include <ucommon/string.h>
 #include <ucommon/shell.h>
+#include <errno.h>
+
+#ifdef  HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#include <time.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <poll.h>
+#define ZEROCOPY_SENDS
+#endif
+
+// slices per gathered write, the least any posix system supports...
+#define TCP_VECTORS 16
 
 namespace ucommon {
 
+#ifdef  ZEROCOPY_SENDS
+
+// wait for the kernel to be done with the pages of a zero copy send...
+static bool zerocopy_wait(socket_t so, unsigned last)
+{
+    char control[128];
+    struct msghdr msg;
+    struct cmsghdr *cm;
+    struct sock_extended_err *serr;
+    struct pollfd pfd;
+
+    for(;;) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if(recvmsg(so, &msg, MSG_ERRQUEUE) < 0) {
+            if(errno == EINTR)
+                continue;
+            if(errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+
+            pfd.fd = so;
+            pfd.events = 0;
+            pfd.revents = 0;
+            if(poll(&pfd, 1, -1) < 0 && errno != EINTR)
+                return false;
+            if(pfd.revents & (POLLHUP | POLLNVAL))
+                return false;
+            continue;
+        }
+
+        for(cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if(!(cm->cmsg_level == IPPROTO_IP && cm->cmsg_type == IP_RECVERR) &&
+              !(cm->cmsg_level == IPPROTO_IPV6 && cm->cmsg_type == IPV6_RECVERR))
+                continue;
+
+            serr = (struct sock_extended_err *)CMSG_DATA(cm);
+            if(serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr->ee_errno)
+                continue;
+
+            // completions are ranges of send ids, which may wrap
+            if((int)(serr->ee_data - last) >= 0)
+                return true;
+        }
+    }
+}
+
+#endif
+
 TCPBuffer::TCPBuffer() :
 BufferProtocol()
 {
     so = INVALID_SOCKET;
+    zerocopy_min = 0;
+    zerocopy_sent = 0;
 }
 
 TCPBuffer::TCPBuffer(const char *host, const char *service, size_t size) :
 BufferProtocol()
 {
     so = INVALID_SOCKET;
+    zerocopy_min = 0;
+    zerocopy_sent = 0;
     open(host, service, size);
 }
 
@@ -43,6 +113,8 @@ TCPBuffer::TCPBuffer(const TCPServer *server, size_t size) :
 BufferProtocol()
 {
     so = INVALID_SOCKET;
+    zerocopy_min = 0;
+    zerocopy_sent = 0;
     open(server, size);
 }
 
@@ -95,6 +167,10 @@ void TCPBuffer::_buffer(size_t size)
     socklen_t alen = sizeof(max);
 #endif
 
+    // zero copy send ids are numbered per socket
+    zerocopy_min = 0;
+    zerocopy_sent = 0;
+
     if(size < 80) {
         allocate(size);
         return;
@@ -167,6 +243,182 @@ size_t TCPBuffer::_push(const char *address, size_t len)
     return (size_t)result;
 }
 
+size_t TCPBuffer::_writev(struct iovec *vector, unsigned count)
+{
+    size_t total = 0, size = 0;
+    ssize_t result;
+    unsigned pos, issued = zerocopy_sent;
+    int flags = 0;
+
+    for(pos = 0; pos < count; ++pos)
+        size += vector[pos].iov_len;
+
+#ifdef  ZEROCOPY_SENDS
+    if(zerocopy_min && size >= zerocopy_min)
+        flags = MSG_ZEROCOPY;
+#endif
+
+    while(count) {
+        result = Socket::sendv(so, vector, count, flags);
+        if(result < 0) {
+            if(errno == EINTR)
+                continue;
+#ifdef  ZEROCOPY_SENDS
+            // out of pinned memory for zero copy, or a socket that cannot
+            // send zero copy, such as kernel tls, so send copied instead
+            if(flags && (errno == ENOBUFS || errno == EOPNOTSUPP)) {
+                flags = 0;
+                continue;
+            }
+#endif
+            ioerr = Socket::error();
+            break;
+        }
+
+        if(flags)
+            ++zerocopy_sent;
+
+        total += result;
+        while(count && (size_t)result >= vector->iov_len) {
+            result -= vector->iov_len;
+            ++vector;
+            --count;
+        }
+        if(count) {
+            vector->iov_base = (caddr_t)vector->iov_base + result;
+            vector->iov_len -= result;
+        }
+    }
+
+#ifdef  ZEROCOPY_SENDS
+    if(zerocopy_sent != issued) {
+        if(!zerocopy_wait(so, zerocopy_sent - 1) && !ioerr)
+            ioerr = Socket::error();
+    }
+#endif
+
+    return total;
+}
+
+size_t TCPBuffer::sendv(const struct iovec *vector, unsigned count)
+{
+    return _sendv(vector, count);
+}
+
+size_t TCPBuffer::sendfile(fsys& file, size_t size)
+{
+    return _sendfile(file, size);
+}
+
+size_t TCPBuffer::_sendv(const struct iovec *vector, unsigned count)
+{
+    struct iovec local[TCP_VECTORS];
+    const char *pending;
+    size_t size, sent, expect, total = 0;
+    unsigned used = 0, pos;
+
+    if(ioerr || !vector || so == INVALID_SOCKET)
+        return 0;
+
+    // pending output goes out first as part of the same write
+    pending = drain(&size);
+    if(pending) {
+        local[used].iov_base = (caddr_t)pending;
+        local[used++].iov_len = size;
+    }
+
+    while(count || used) {
+        while(count && used < TCP_VECTORS) {
+            local[used++] = *(vector++);
+            --count;
+        }
+
+        for(expect = 0, pos = 0; pos < used; ++pos)
+            expect += local[pos].iov_len;
+
+        sent = _writev(local, used);
+
+        // what was pending and not sent is kept to be flushed later
+        if(sent < size) {
+            restore(size, sent);
+            return 0;
+        }
+
+        total += sent - size;
+        if(sent < expect)
+            break;
+
+        size = 0;
+        used = 0;
+    }
+    return total;
+}
+
+size_t TCPBuffer::_sendfile(fsys& file, size_t size)
+{
+    char buf[8192];
+    size_t total = 0;
+    ssize_t result;
+
+    if(ioerr || !flush())
+        return 0;
+
+#ifdef  HAVE_SYS_SENDFILE_H
+    while(total < size) {
+        result = ::sendfile(so, file.handle(), NULL, size - total);
+        if(result > 0) {
+            total += result;
+            continue;
+        }
+        if(!result)
+            return total;
+        if(errno == EINTR)
+            continue;
+
+        // if not a file the kernel can send from, we copy it instead...
+        if(total || (errno != EINVAL && errno != ENOSYS)) {
+            ioerr = Socket::error();
+            return total;
+        }
+        break;
+    }
+
+    if(total == size)
+        return total;
+#endif
+
+    while(total < size) {
+        result = file.read(buf, (size - total) > sizeof(buf) ? sizeof(buf) : size - total);
+        if(result < 1)
+            break;
+        if(put(buf, result) < (size_t)result)
+            return total;
+        total += result;
+    }
+
+    flush();
+    return total;
+}
+
+bool TCPBuffer::zerocopy(size_t minimum)
+{
+    zerocopy_min = 0;
+    if(!minimum)
+        return true;
+
+#ifdef  ZEROCOPY_SENDS
+    int opt = 1;
+
+    if(so == INVALID_SOCKET || setsockopt(so, SOL_SOCKET, SO_ZEROCOPY, (char *)&opt, sizeof(opt)))
+        return false;
+
+    zerocopy_min = minimum;
+    return true;
+#else
+    return false;
+#endif
+}
+
 size_t TCPBuffer::_pull(char *address, size_t len)
 {
     ssize_t result;
@@ -18,11 +18,17 @@
 #include <ucommon-config.h>
 #include <ucommon/export.h>
 #include <ucommon/object.h>
+#include <ucommon/atomic.h>
 #include <ucommon/thread.h>
 #include <ucommon/timers.h>
 #include <ucommon/linked.h>
 #include <errno.h>
+#ifdef  _FUTEX_
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 #include <string.h>
+#include <stdlib.h>
 #include <stdarg.h>
 #include <limits.h>
 
@@ -42,14 +48,54 @@ extern int _posix_clocking;
 int _posix_clocking = CLOCK_REALTIME;
 #endif
 
-struct mutex_entry
+#ifndef MUTEX_STRIPES
+#define MUTEX_STRIPES   64
+#endif
+
+#define STRIPE_ALIGN    64
+
+#ifndef STRIPE_OBJECTS
+#define STRIPE_OBJECTS  4
+#endif
+
+// an object protected through a stripe, free when neither held nor waited.
+// Its stripe guards who holds it, and it only sleeps and wakes its own
+// waiters, so a release never wakes waiters of other objects...
+class __LOCAL mutex_object : public Conditional
 {
-    pthread_mutex_t mutex;
-    struct mutex_entry *next;
+public:
     const void *pointer;
-    unsigned count;
+    pthread_t owner;
+    unsigned depth, waiting, wakeups;
+
+    mutex_object();
+
+    void sleep(void);
+    void wake(void);
 };
 
+// a stripe only guards the objects that hash to it for as long as it
+// takes to find or claim one, so unrelated objects that share a stripe
+// never hold or release each other.  Each stripe has a fixed pool of
+// objects, and only waits for one to be free when all are in use...
+class __LOCAL mutex_stripe : public Conditional
+{
+public:
+    mutex_object objects[STRIPE_OBJECTS];
+    unsigned long acquired, contended;
+    unsigned starving;
+
+    mutex_stripe();
+
+    void protect(const void *ptr);
+    bool release(const void *ptr);
+
+private:
+    mutex_object *find(const void *ptr);
+};
+
+#define STRIPE_SIZE ((sizeof(mutex_stripe) + STRIPE_ALIGN - 1) & ~(STRIPE_ALIGN - 1))
+
 class __LOCAL rwlock_entry : public ThreadLock
 {
 public:
@@ -59,14 +105,6 @@ public:
     unsigned count;
 };
 
-class __LOCAL mutex_index : public Mutex
-{
-public:
-    struct mutex_entry *list;
-
-    mutex_index();
-};
-
 class __LOCAL rwlock_index : public Mutex
 {
 public:
@@ -77,9 +115,8 @@ public:
 
 static rwlock_index single_rwlock;
 static rwlock_index *rwlock_table = &single_rwlock;
-static mutex_index single_table;
-static mutex_index *mutex_table = &single_table;
-static unsigned mutex_indexing = 1;
+static caddr_t stripe_table = NULL;
+static unsigned stripe_count = 0;
 static unsigned rwlock_indexing = 1;
 
 #ifdef  __PTH__
@@ -92,9 +129,162 @@ static pthread_key_t threadmap;
 #endif
 #endif
 
-mutex_index::mutex_index() : Mutex()
+mutex_object::mutex_object() : Conditional()
 {
-    list = NULL;
+    pointer = NULL;
+    depth = waiting = wakeups = 0;
+}
+
+// a wakeup may be left over from a release nobody slept through, so the
+// waiter always looks again...
+void mutex_object::sleep(void)
+{
+    lock();
+    while(!wakeups)
+        wait();
+    --wakeups;
+    unlock();
+}
+
+void mutex_object::wake(void)
+{
+    lock();
+    ++wakeups;
+    signal();
+    unlock();
+}
+
+mutex_stripe::mutex_stripe() : Conditional()
+{
+    acquired = contended = 0;
+    starving = 0;
+}
+
+mutex_object *mutex_stripe::find(const void *ptr)
+{
+    mutex_object *empty = NULL;
+
+    for(unsigned pos = 0; pos < STRIPE_OBJECTS; ++pos) {
+        mutex_object *object = &objects[pos];
+        if(object->pointer == ptr && (object->depth || object->waiting))
+            return object;
+        if(!empty && !object->depth && !object->waiting)
+            empty = object;
+    }
+
+    if(empty)
+        empty->pointer = ptr;
+    return empty;
+}
+
+void mutex_stripe::protect(const void *ptr)
+{
+    mutex_object *object;
+
+    lock();
+    while(NULL == (object = find(ptr))) {
+        ++starving;
+        wait();
+        --starving;
+    }
+
+    if(object->depth && Thread::equal(object->owner, pthread_self())) {
+        ++object->depth;
+        unlock();
+        return;
+    }
+
+    // while we wait the object stays ours to sleep on...
+    if(object->depth) {
+        ++contended;
+        ++object->waiting;
+        do {
+            unlock();
+            object->sleep();
+            lock();
+        } while(object->depth);
+        --object->waiting;
+    }
+    ++acquired;
+    object->owner = pthread_self();
+    object->depth = 1;
+    unlock();
+}
+
+bool mutex_stripe::release(const void *ptr)
+{
+    mutex_object *object = NULL;
+    bool waking = false;
+
+    lock();
+    for(unsigned pos = 0; pos < STRIPE_OBJECTS; ++pos) {
+        if(objects[pos].pointer == ptr && objects[pos].depth) {
+            object = &objects[pos];
+            break;
+        }
+    }
+
+    if(!object || !Thread::equal(object->owner, pthread_self())) {
+        unlock();
+        return false;
+    }
+
+    if(!--object->depth) {
+        if(object->waiting)
+            waking = true;
+        else if(starving)
+            broadcast();
+    }
+    unlock();
+
+    // a waiter keeps the object from being reused until it wakes
+    if(waking)
+        object->wake();
+    return true;
+}
+
+// a replaced table is never freed since stripes may still be referenced...
+static void stripe_create(unsigned size)
+{
+    caddr_t mem = (caddr_t)::malloc(STRIPE_SIZE * size + STRIPE_ALIGN);
+
+    crit(mem != NULL, "mutex stripes failed");
+
+    caddr_t table = (caddr_t)(((size_t)mem + STRIPE_ALIGN - 1) & ~((size_t)STRIPE_ALIGN - 1));
+
+    for(unsigned pos = 0; pos < size; ++pos)
+        new((void *)(table + pos * STRIPE_SIZE)) mutex_stripe;
+
+    stripe_table = table;
+    stripe_count = size;
+}
+
+static inline mutex_stripe *stripe_at(unsigned pos)
+{
+    return (mutex_stripe *)(stripe_table + pos * STRIPE_SIZE);
+}
+
+// the table pointer is constant initialized, so protect may be used by
+// constructors that run before ours...
+class __LOCAL mutex_stripes
+{
+public:
+    inline mutex_stripes()
+        {if(!stripe_table) stripe_create(MUTEX_STRIPES);}
+};
+
+static mutex_stripes stripes;
+
+static inline mutex_stripe *stripe_entry(const void *ptr)
+{
+    size_t addr = (size_t)ptr;
+    unsigned key = (unsigned)(addr >> 3) ^ (unsigned)((addr >> 16) >> 16);
+
+    if(!stripe_table)
+        stripe_create(MUTEX_STRIPES);
+
+    key *= 2654435761u;
+    return stripe_at((key ^ (key >> 16)) % stripe_count);
 }
 
 rwlock_index::rwlock_index() : Mutex()
@@ -206,6 +396,105 @@ void Conditional::set(struct timespec *ts, timeout_t msec)
     }
 }
 
+#ifdef  _FUTEX_
+
+// spins before parking, only worth doing when another cpu can release...
+#ifndef FUTEX_SPINS
+#define FUTEX_SPINS 100
+#endif
+
+static unsigned futex_spins = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? FUTEX_SPINS : 0;
+
+static inline void futex_pause(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__("pause" ::: "memory");
+#else
+    __sync_synchronize();
+#endif
+}
+
+static inline long futex_call(volatile int *word, int op, int value, const struct timespec *ts = NULL, volatile int *word2 = NULL, int value3 = 0)
+{
+    return syscall(SYS_futex, word, op, value, ts, word2, value3);
+}
+
+void futex::contended(lock_t *lock)
+{
+    unsigned spins = futex_spins;
+
+    while(spins--) {
+        futex_pause();
+        if(!*lock && __sync_bool_compare_and_swap(lock, 0, 1))
+            return;
+    }
+
+    // 2 marks the lock as having parked waiters for unlock to wake
+    while(__sync_lock_test_and_set(lock, 2))
+        futex_call(lock, FUTEX_WAIT_PRIVATE, 2);
+}
+
+void futex::wakeup(lock_t *lock)
+{
+    __sync_lock_release(lock);
+    futex_call(lock, FUTEX_WAKE_PRIVATE, 1);
+}
+
+void futex::wake(event_t *event, lock_t *lock, bool all)
+{
+    int sequence = event->sequence;
+
+    if(!all) {
+        futex_call(&event->sequence, FUTEX_WAKE_PRIVATE, 1);
+        return;
+    }
+
+    // wake one and move the rest onto the lock so they are released
+    // one at a time by unlock rather than all contending at once...
+    while(futex_call(&event->sequence, FUTEX_CMP_REQUEUE_PRIVATE, 1,
+        (const struct timespec *)(long)INT_MAX, lock, sequence) < 0 && errno == EAGAIN)
+        sequence = event->sequence;
+}
+
+bool futex::wait(event_t *event, lock_t *lock, const struct timespec *timeout)
+{
+    unsigned spins = futex_spins;
+    int op = FUTEX_WAIT_BITSET_PRIVATE;
+    bool result = true;
+    int sequence;
+
+#if _POSIX_TIMERS > 0 && defined(POSIX_TIMERS)
+    if(_posix_clocking == CLOCK_REALTIME)
+        op |= FUTEX_CLOCK_REALTIME;
+#else
+    op |= FUTEX_CLOCK_REALTIME;
+#endif
+
+    __sync_fetch_and_add(&event->waiters, 1);
+    sequence = event->sequence;
+    unlock(lock);
+
+    while(spins-- && event->sequence == sequence)
+        futex_pause();
+
+    while(event->sequence == sequence) {
+        if(futex_call(&event->sequence, op, sequence, timeout, NULL, FUTEX_BITSET_MATCH_ANY) < 0 && errno == ETIMEDOUT) {
+            result = false;
+            break;
+        }
+    }
+
+    __sync_fetch_and_sub(&event->waiters, 1);
+
+    // we may have been requeued, so re-acquire as contended...
+    while(__sync_lock_test_and_set(lock, 2))
+        futex_call(lock, FUTEX_WAIT_PRIVATE, 2);
+
+    return result;
+}
+
+#endif
+
 Semaphore::Semaphore(unsigned limit) :
 Conditional()
 {
@@ -258,10 +547,12 @@ bool Semaphore::wait(timeout_t timeout)
 void Semaphore::wait(void)
 {
     lock();
-    if(used >= count) {
+    while(used >= count) {
         ++waits;
         Conditional::wait();
         --waits;
+        if(!count)
+            break;
     }
 	if(count)
 	    ++used;
@@ -465,10 +756,13 @@ Conditional::attribute::attribute()
 
 Conditional::Conditional()
 {
-#ifdef  __PTH__
+#if defined(__PTH__)
     Thread::init();
     pth_cond_init(&cond);
     pth_mutex_init(&mutex);
+#elif defined(_FUTEX_)
+    cond.sequence = cond.waiters = 0;
+    mutex = 0;
 #else
     crit(pthread_cond_init(&cond, &attr.attr) == 0, "conditional init failed");
     crit(pthread_mutex_init(&mutex, NULL) == 0, "mutex init failed");
@@ -477,7 +771,7 @@ Conditional::Conditional()
 
 Conditional::~Conditional()
 {
-#ifndef __PTH__
+#if !defined(__PTH__) && !defined(_FUTEX_)
     pthread_cond_destroy(&cond);
     pthread_mutex_destroy(&mutex);
 #endif
@@ -494,10 +788,14 @@ bool Conditional::wait(struct timespec *ts)
 {
     assert(ts != NULL);
 
+#ifdef  _FUTEX_
+    return futex::wait(&cond, &mutex, ts);
+#else
     if(pthread_cond_timedwait(&cond, &mutex, ts) == ETIMEDOUT)
         return false;
 
     return true;
+#endif
 }
 
 #endif
@@ -646,8 +944,10 @@ bool ConditionalAccess::waitBroadcast(struct timespec *ts)
 ConditionalAccess::ConditionalAccess()
 {
     waiting = pending = sharing = 0;
-#ifdef  __PTH__
+#if defined(__PTH__)
     pth_cond_init(&bcast);
+#elif defined(_FUTEX_)
+    bcast.sequence = bcast.waiters = 0;
 #else
     crit(pthread_cond_init(&bcast, &attr.attr) == 0, "conditional init failed");
 #endif
@@ -655,7 +955,7 @@ ConditionalAccess::ConditionalAccess()
 
 ConditionalAccess::~ConditionalAccess()
 {
-#ifndef __PTH__
+#if !defined(__PTH__) && !defined(_FUTEX_)
     pthread_cond_destroy(&bcast);
 #endif
 }
@@ -671,10 +971,14 @@ bool ConditionalAccess::waitBroadcast(struct timespec *ts)
 {
     assert(ts != NULL);
 
+#ifdef  _FUTEX_
+    return futex::wait(&bcast, &mutex, ts);
+#else
     if(pthread_cond_timedwait(&bcast, &mutex, ts) == ETIMEDOUT)
         return false;
 
     return true;
+#endif
 }
 
 bool ConditionalAccess::waitBroadcast(timeout_t timeout)
@@ -688,10 +992,14 @@ bool ConditionalAccess::waitSignal(struct timespec *ts)
 {
     assert(ts != NULL);
 
+#ifdef  _FUTEX_
+    return futex::wait(&cond, &mutex, ts);
+#else
     if(pthread_cond_timedwait(&cond, &mutex, ts) == ETIMEDOUT)
         return false;
 
     return true;
+#endif
 }
 
 #endif
@@ -1004,8 +1312,10 @@ void Mutex::guard::release(void)
 
 Mutex::Mutex()
 {
-#ifdef  __PTH__
+#if defined(__PTH__)
     pth_mutex_init(&mlock);
+#elif defined(_FUTEX_)
+    mlock = 0;
 #else
     crit(pthread_mutex_init(&mlock, NULL) == 0, "mutex init failed");
 #endif
@@ -1013,15 +1323,31 @@ Mutex::Mutex()
 
 Mutex::~Mutex()
 {
+#ifndef _FUTEX_
     pthread_mutex_destroy(&mlock);
+#endif
 }
 
 void Mutex::indexing(unsigned index)
 {
-    if(index > 1) {
-        mutex_table = new mutex_index[index];
-        mutex_indexing = index;
+    if(index && index != stripe_count)
+        stripe_create(index);
+}
+
+unsigned Mutex::contention(unsigned long *acquired, unsigned long *contended)
+{
+    unsigned long locks = 0, waits = 0;
+
+    for(unsigned pos = 0; pos < stripe_count; ++pos) {
+        locks += stripe_at(pos)->acquired;
+        waits += stripe_at(pos)->contended;
     }
+
+    if(acquired)
+        *acquired = locks;
+    if(contended)
+        *contended = waits;
+    return stripe_count;
 }
 
 void ThreadLock::indexing(unsigned index)
@@ -1178,38 +1504,11 @@ bool ThreadLock::writer(const void *ptr, timeout_t timeout)
 
 bool Mutex::protect(const void *ptr)
 {
-    mutex_index *index = &mutex_table[hash_address(ptr, mutex_indexing)];
-    mutex_entry *entry, *empty = NULL;
-
     if(!ptr)
         return false;
 
-    index->acquire();
-    entry = index->list;
-    while(entry) {
-        if(entry->count && entry->pointer == ptr)
-            break;
-        if(!entry->count)
-            empty = entry;
-        entry = entry->next;
-    }
-    if(!entry) {
-        if(empty)
-            entry = empty;
-        else {
-            entry = new struct mutex_entry;
-            entry->count = 0;
-            pthread_mutex_init(&entry->mutex, NULL);
-            entry->next = index->list;
-            index->list = entry;
-        }
-    }
-    entry->pointer = ptr;
-    ++entry->count;
-//  printf("ACQUIRE %p, THREAD %d, POINTER %p, COUNT %d\n", entry, Thread::self(), entry->pointer, entry->count);
-    index->release();
-    pthread_mutex_lock(&entry->mutex);
-	return true;
+    stripe_entry(ptr)->protect(ptr);
+    return true;
 }
 
 bool ThreadLock::release(const void *ptr)
@@ -1240,39 +1539,20 @@ bool ThreadLock::release(const void *ptr)
 
 bool Mutex::release(const void *ptr)
 {
-    mutex_index *index = &mutex_table[hash_address(ptr, mutex_indexing)];
-    mutex_entry *entry;
-
     if(!ptr)
         return false;
 
-    index->acquire();
-    entry = index->list;
-    while(entry) {
-        if(entry->count && entry->pointer == ptr)
-            break;
-        entry = entry->next;
-    }
-
-	bool rtn = false;
-    if(entry) {
-//      printf("RELEASE %p, THREAD %d, POINTER %p COUNT %d\n", entry, Thread::self(), entry->pointer, entry->count);
-        pthread_mutex_unlock(&entry->mutex);
-        --entry->count;
-		rtn = true;
-    }
-    index->release();
-	return rtn;
+    return stripe_entry(ptr)->release(ptr);
 }
 
 void Mutex::_lock(void)
 {
-    pthread_mutex_lock(&mlock);
+    lock();
 }
 
 void Mutex::_unlock(void)
 {
-    pthread_mutex_unlock(&mlock);
+    unlock();
 }
 
 #ifdef  _MSTHREADS_
@@ -1771,10 +2051,217 @@ SharedObject::~SharedObject()
 {
 }
 
+#if defined(HAVE_GCC_ATOMICS) && !defined(_MSTHREADS_) && !defined(__PTH__)
+#define USE_EPOCH_READERS
+#endif
+
+#ifdef  USE_EPOCH_READERS
+
+// each thread that reads a lockfree shared pointer marks the epoch it
+// entered in its own padded entry, and a writer waits for entries marked
+// before its update.  Entries of exited threads are reused, never freed.
+// Unlike atomic::epoch, readers never write to a count they share, but
+// the epoch is global to all lockfree pointers.
+struct epoch_entry
+{
+    union epoch_reader *next;
+    volatile long epoch;
+    volatile long inuse;
+    unsigned depth;
+};
+
+union epoch_reader
+{
+    struct epoch_entry entry;
+    char pad[(sizeof(struct epoch_entry) + STRIPE_ALIGN - 1) & ~(STRIPE_ALIGN - 1)];
+};
+
+// objects replaced by a thread that is still reading are retired here,
+// and freed once no reader marked before they were retired remains.
+struct epoch_retired
+{
+    struct epoch_retired *next;
+    SharedObject *object;
+    long epoch;
+};
+
+static union epoch_reader *volatile epoch_readers = NULL;
+static struct epoch_retired *volatile epoch_retire = NULL;
+static volatile long epoch_current = 1;
+static pthread_key_t epoch_key;
+static pthread_once_t epoch_once = PTHREAD_ONCE_INIT;
+
+static void epoch_exit(void *data)
+{
+    union epoch_reader *reader = (union epoch_reader *)data;
+
+    reader->entry.depth = 0;
+    atomic::store(&reader->entry.epoch, 0);
+    atomic::store(&reader->entry.inuse, 0);
+}
+
+static void epoch_setup(void)
+{
+    pthread_key_create(&epoch_key, &epoch_exit);
+}
+
+static union epoch_reader *epoch_self(void)
+{
+    union epoch_reader *reader;
+    caddr_t mem;
+
+    pthread_once(&epoch_once, &epoch_setup);
+    reader = (union epoch_reader *)pthread_getspecific(epoch_key);
+    if(reader)
+        return reader;
+
+    reader = epoch_readers;
+    while(reader) {
+        if(!reader->entry.inuse && __sync_bool_compare_and_swap(&reader->entry.inuse, 0, 1))
+            break;
+        reader = reader->entry.next;
+    }
+
+    if(!reader) {
+        mem = (caddr_t)::malloc(sizeof(union epoch_reader) + STRIPE_ALIGN);
+        crit(mem != NULL, "epoch reader failed");
+        reader = (union epoch_reader *)(((size_t)mem + STRIPE_ALIGN - 1) & ~((size_t)STRIPE_ALIGN - 1));
+        reader->entry.epoch = 0;
+        reader->entry.inuse = 1;
+        reader->entry.depth = 0;
+        do {
+            reader->entry.next = epoch_readers;
+        } while(!__sync_bool_compare_and_swap(&epoch_readers, reader->entry.next, reader));
+    }
+
+    pthread_setspecific(epoch_key, reader);
+    return reader;
+}
+
+// the fence orders our epoch mark before reading the pointer, against a
+// writer that publishes the pointer before it reads our mark...
+static union epoch_reader *epoch_enter(void)
+{
+    union epoch_reader *reader = epoch_self();
+
+    if(!reader->entry.depth++) {
+        reader->entry.epoch = atomic::load(&epoch_current);
+        atomic::fence();
+    }
+    return reader;
+}
+
+static void epoch_reclaim(void);
+
+static void epoch_leave(void)
+{
+    union epoch_reader *reader = (union epoch_reader *)pthread_getspecific(epoch_key);
+
+    if(reader && reader->entry.depth && !--reader->entry.depth) {
+        atomic::store(&reader->entry.epoch, 0);
+        if(epoch_retire)
+            epoch_reclaim();
+    }
+}
+
+// the epoch is shared by all lockfree pointers, so a thread that is
+// still reading any of them would wait for itself...
+static bool epoch_reading(void)
+{
+    union epoch_reader *reader;
+
+    pthread_once(&epoch_once, &epoch_setup);
+    reader = (union epoch_reader *)pthread_getspecific(epoch_key);
+    return reader && reader->entry.depth;
+}
+
+static void epoch_synchronize(void)
+{
+    long epoch;
+    union epoch_reader *reader;
+
+    atomic::fence();
+    epoch = atomic::add(&epoch_current, 1);
+    atomic::fence();
+
+    reader = epoch_readers;
+    while(reader) {
+        for(;;) {
+            long marked = atomic::load(&reader->entry.epoch);
+            if(!marked || marked >= epoch)
+                break;
+            Thread::yield();
+        }
+        reader = reader->entry.next;
+    }
+}
+
+static bool epoch_passed(long epoch)
+{
+    union epoch_reader *reader = epoch_readers;
+
+    while(reader) {
+        long marked = atomic::load(&reader->entry.epoch);
+        if(marked && marked < epoch)
+            return false;
+        reader = reader->entry.next;
+    }
+    return true;
+}
+
+static void epoch_push(struct epoch_retired *node)
+{
+    do {
+        node->next = epoch_retire;
+    } while(!__sync_bool_compare_and_swap(&epoch_retire, node->next, node));
+}
+
+static void epoch_defer(SharedObject *object)
+{
+    struct epoch_retired *node = (struct epoch_retired *)::malloc(sizeof(struct epoch_retired));
+
+    crit(node != NULL, "epoch retire failed");
+    node->object = object;
+    node->epoch = atomic::add(&epoch_current, 1);
+    epoch_push(node);
+}
+
+// the whole list is taken at once, so reclaiming threads never see the
+// same node, and what has not passed yet is pushed back...
+static void epoch_reclaim(void)
+{
+    struct epoch_retired *list, *node;
+
+    list = __sync_lock_test_and_set(&epoch_retire, (struct epoch_retired *)NULL);
+    while(list) {
+        node = list;
+        list = list->next;
+        if(epoch_passed(node->epoch)) {
+            delete node->object;
+            ::free(node);
+        }
+        else
+            epoch_push(node);
+    }
+}
+
+#endif
+
 SharedPointer::SharedPointer() :
 ConditionalAccess()
 {
     pointer = NULL;
+    lockfree = false;
+}
+
+SharedPointer::SharedPointer(bool rcu) :
+ConditionalAccess()
+{
+    pointer = NULL;
+    lockfree = rcu;
+#ifndef USE_EPOCH_READERS
+    lockfree = false;
+#endif
 }
 
 SharedPointer::~SharedPointer()
@@ -1784,22 +2271,63 @@ SharedPointer::~SharedPointer()
 void SharedPointer::replace(SharedObject *ptr)
 {
     modify();
+    update(ptr);
+    commit();
+}
+
+void SharedPointer::update(SharedObject *ptr)
+{
+#ifdef  USE_EPOCH_READERS
+    // writers are still serialized, but readers never wait for them
+    if(lockfree) {
+        SharedObject *prior = pointer;
+        if(ptr)
+            ptr->commit(this);
+        atomic::store((void *volatile *)&pointer, ptr);
+        if(prior && epoch_reading())
+            epoch_defer(prior);
+        else if(prior) {
+            epoch_synchronize();
+            delete prior;
+        }
+        if(epoch_retire)
+            epoch_reclaim();
+        return;
+    }
+#endif
 
     if(pointer)
         delete pointer;
     pointer = ptr;
     if(ptr)
         ptr->commit(this);
-
-    commit();
 }
 
 SharedObject *SharedPointer::share(void)
 {
+#ifdef  USE_EPOCH_READERS
+    if(lockfree) {
+        epoch_enter();
+        return (SharedObject *)atomic::load((void *const volatile *)&pointer);
+    }
+#endif
+
     access();
     return pointer;
 }
 
+void SharedPointer::release(void)
+{
+#ifdef  USE_EPOCH_READERS
+    if(lockfree) {
+        epoch_leave();
+        return;
+    }
+#endif
+
+    ConditionalAccess::release();
+}
+
 Thread::Thread(size_t size)
 {
     stack = size;
@@ -2181,18 +2709,20 @@ locked_release &locked_release::operator=(LockedPointer &p)
 shared_release::shared_release(const shared_release &copy)
 {
     ptr = copy.ptr;
+    object = NULL;
+    if(ptr)
+        object = ptr->share();
 }
 
 shared_release::shared_release()
 {
     ptr = NULL;
+    object = NULL;
 }
 
 SharedObject *shared_release::get(void)
 {
-    if(ptr)
-        return ptr->pointer;
-    return NULL;
+    return object;
 }
 
 void SharedObject::commit(SharedPointer *spointer)
@@ -2202,7 +2732,7 @@ void SharedObject::commit(SharedPointer *spointer)
 shared_release::shared_release(SharedPointer &p)
 {
     ptr = &p;
-    p.share(); // create rdlock
+    object = p.share(); // create rdlock
 }
 
 shared_release::~shared_release()
@@ -2215,13 +2745,14 @@ void shared_release::release(void)
     if(ptr)
         ptr->release();
     ptr = NULL;
+    object = NULL;
 }
 
 shared_release &shared_release::operator=(SharedPointer &p)
 {
     release();
     ptr = &p;
-    p.share();
+    object = p.share();
     return *this;
 }
 
@@ -58,6 +58,39 @@ static void adj(struct timeval *ts)
 }
 #endif
 
+// timer wheel geometry, four levels of 256 millisecond based slots...
+
+#define WHEEL_BITS      8
+#define WHEEL_SIZE      (1 << WHEEL_BITS)
+#define WHEEL_MASK      (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS    4
+
+#if _POSIX_TIMERS > 0 && defined(POSIX_TIMERS)
+static Timer::tick_t _msec(const struct timespec *ts)
+{
+    return ((Timer::tick_t)ts->tv_sec * 1000) + (ts->tv_nsec / 1000000l);
+}
+
+static Timer::tick_t _msec(void)
+{
+    struct timespec current;
+    clock_gettime(_posix_clocking, &current);
+    return _msec(&current);
+}
+#else
+static Timer::tick_t _msec(const struct timeval *tv)
+{
+    return ((Timer::tick_t)tv->tv_sec * 1000) + (tv->tv_usec / 1000l);
+}
+
+static Timer::tick_t _msec(void)
+{
+    struct timeval current;
+    gettimeofday(&current, NULL);
+    return _msec(&current);
+}
+#endif
+
 #ifdef  WIN32
 #ifdef  _WIN32_WCE
 } // namespace ucommon
@@ -112,12 +145,14 @@ const time_t Timer::reset = ((time_t)0);
 TimerQueue::event::event(timeout_t timeout) :
 Timer(), LinkedList()
 {
+    timing.owner = this;
     set(timeout);
 }
 
 TimerQueue::event::event(TimerQueue *tq, timeout_t timeout) :
 Timer(), LinkedList()
 {
+    timing.owner = this;
     set(timeout);
     Timer::update();
     attach(tq);
@@ -197,6 +232,7 @@ void TimerQueue::event::attach(TimerQueue *tq)
     tq->modify();
     enlist(tq);
     Timer::update();
+    tq->schedule(this);
     tq->update();
 }
 
@@ -206,8 +242,10 @@ void TimerQueue::event::arm(timeout_t timeout)
     if(tq)
         tq->modify();
     set(timeout);
-    if(tq)
+    if(tq) {
+        tq->schedule(this);
         tq->update();
+    }
 }
 
 void TimerQueue::event::disarm(void)
@@ -218,8 +256,10 @@ void TimerQueue::event::disarm(void)
     if(tq && flag)
         tq->modify();
     clear();
-    if(tq && flag)
+    if(tq && flag) {
+        tq->remove(this);
         tq->update();
+    }
 }
 
 void TimerQueue::event::update(void)
@@ -227,6 +267,7 @@ void TimerQueue::event::update(void)
     TimerQueue *tq = list();
     if(Timer::update() && tq) {
         tq->modify();
+        tq->schedule(this);
         tq->update();
     }
 }
@@ -237,6 +278,7 @@ void TimerQueue::event::detach(void)
     if(tq) {
         tq->modify();
         clear();
+        tq->remove(this);
         delist();
         tq->update();
     }
@@ -467,32 +509,162 @@ timeout_t TQEvent::timeout(void)
         disarm();
         expired();
         timeout = get();
-        Timer::update();
+        // the handler may have re-armed through the timer itself...
+        update();
     }
     return timeout;
 }
 
 TimerQueue::TimerQueue() : OrderedIndex()
 {
+    wheel = new OrderedIndex[WHEEL_SIZE * WHEEL_LEVELS];
+    current = _msec();
+    for(unsigned level = 0; level < WHEEL_LEVELS; ++level)
+        pending[level] = 0;
 }
 
 TimerQueue::~TimerQueue()
 {
+    linked_pointer<event> tp = begin();
+    event *timer;
+
+    while(is(tp)) {
+        timer = *tp;
+        tp.next();
+        timer->timing.delist();
+        timer->delist();
+    }
+
+    delete[] wheel;
 }
 
-timeout_t TimerQueue::expire(void)
+void TimerQueue::remove(event *timer)
+{
+    OrderedIndex *index = timer->timing.index();
+
+    if(!index)
+        return;
+
+    if(index >= wheel && index < wheel + (WHEEL_SIZE * WHEEL_LEVELS))
+        --pending[(index - wheel) / WHEEL_SIZE];
+
+    timer->timing.delist();
+}
+
+void TimerQueue::schedule(event *timer)
+{
+    Timer::tick_t due, delta;
+    unsigned level = 0;
+
+    remove(timer);
+    if(!timer->is_active())
+        return;
+
+    due = _msec(&timer->timer);
+    if(due < current)
+        due = current;
+
+    delta = due - current;
+    while(level < WHEEL_LEVELS - 1 && delta >= ((Timer::tick_t)1 << (WHEEL_BITS * (level + 1))))
+        ++level;
+
+    // beyond the top of the wheel, so park in furthest slot to be cascaded
+    if(delta >> (WHEEL_BITS * WHEEL_LEVELS))
+        due = current + ((Timer::tick_t)1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+
+    ++pending[level];
+    timer->timing.enlist(&wheel[level * WHEEL_SIZE + ((due >> (WHEEL_BITS * level)) & WHEEL_MASK)]);
+}
+
+void TimerQueue::cascade(unsigned level)
 {
-    timeout_t first = Timer::inf, next;
-    linked_pointer<TimerQueue::event> timer = begin();
-    TimerQueue::event *tp;
+    OrderedIndex *slot = &wheel[level * WHEEL_SIZE + ((current >> (WHEEL_BITS * level)) & WHEEL_MASK)];
+    event::slot *node;
+
+    while(NULL != (node = static_cast<event::slot *>(slot->begin())))
+        schedule(node->owner);
+}
 
-    while(timer) {
-        tp = *timer;
-        timer.next();
-        next = tp->timeout();
-        if(next && next < first)
-            first = next;
+timeout_t TimerQueue::next(Timer::tick_t now)
+{
+    Timer::tick_t first = 0, when;
+    unsigned level, offset, shift;
+
+    for(level = 0; level < WHEEL_LEVELS; ++level) {
+        if(!pending[level])
+            continue;
+
+        shift = WHEEL_BITS * level;
+        for(offset = level ? 1 : 0; offset <= WHEEL_SIZE; ++offset) {
+            when = ((current >> shift) + offset) << shift;
+            if(wheel[level * WHEEL_SIZE + ((when >> shift) & WHEEL_MASK)].begin())
+                break;
+        }
+
+        if(offset <= WHEEL_SIZE && (!first || when < first))
+            first = when;
     }
+
+    if(!first)
+        return Timer::inf;
+
+    if(first <= now)
+        return 0;
+
+    return (timeout_t)(first - now);
+}
+
+timeout_t TimerQueue::expire(void)
+{
+    Timer::tick_t now = _msec(), boundary;
+    timeout_t first = Timer::inf, wait;
+    OrderedIndex due;
+    event::slot *node;
+    unsigned level;
+
+    while(current <= now) {
+        // when the lowest wheel wraps, refill it from the higher ones...
+        for(level = 1; level < WHEEL_LEVELS; ++level) {
+            if(current & (((Timer::tick_t)1 << (WHEEL_BITS * level)) - 1))
+                break;
+            cascade(level);
+        }
+
+        OrderedIndex *slot = &wheel[current & WHEEL_MASK];
+        while(NULL != (node = static_cast<event::slot *>(slot->begin()))) {
+            node->enlist(&due);
+            --pending[0];
+        }
+
+        ++current;
+
+        // an event goes back into the wheel before we call it, so that it
+        // may detach or delete itself, and its timeout re-slots it again
+        // if the handler re-armed it...
+        while(NULL != (node = static_cast<event::slot *>(due.begin()))) {
+            node->delist();
+            schedule(node->owner);
+            wait = node->owner->timeout();
+            if(wait && wait < first)
+                first = wait;
+        }
+
+        // skip empty stretches of the wheel up to the next cascade...
+        boundary = current;
+        for(level = 0; level < WHEEL_LEVELS && !pending[level]; ++level)
+            boundary = ((current >> (WHEEL_BITS * (level + 1))) + 1) << (WHEEL_BITS * (level + 1));
+
+        if(level == WHEEL_LEVELS || boundary > now + 1)
+            boundary = now + 1;
+
+        if(boundary > current)
+            current = boundary;
+    }
+
+    // events may have taken time and re-armed, so measure from after them
+    wait = next(_msec());
+    if(wait < first)
+        first = wait;
     return first;
 }
 
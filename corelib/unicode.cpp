@@ -438,7 +438,7 @@ UString::~UString() {}
 
 UString::UString(strsize_t size)
 {
-    str = create(size);
+    str = make(size);
     str->retain();
 }
 
@@ -465,7 +465,7 @@ void UString::set(const unicode_t text)
 {
     strsize_t size = utf8::chars(text);
     str = NULL;
-    str = create(size);
+    str = make(size);
     str->retain();
 
     chartext cp(str->text, str->max);
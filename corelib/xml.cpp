@@ -21,10 +21,65 @@
 #include <ucommon/string.h>
 #include <ucommon/xml.h>
 #include <ctype.h>
+#include <stdlib.h>
+#ifdef  HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef  HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if defined(HAVE_SYS_MMAN_H) && !defined(_MSWINDOWS_)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define XML_MAPPED
+#endif
+
+// element name characters, as a table rather than a test per character...
+static const unsigned char elements[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+
+static inline bool isElement(char c)
+{
+    return elements[(unsigned char)c] != 0;
+}
 
-static bool isElement(char c)
+// find the end of a tag, skipping any quoted attribute values, and with
+// the quote we are within kept between chunks...
+static const char *tagend(const char *data, const char *end, char& quote)
 {
-    return isalnum(c) || c == ':' || c == '-' || c == '.' || c == '_';
+    const char *gt, *sq, *dq;
+    size_t size;
+
+    while(data < end) {
+        if(quote) {
+            data = (const char *)memchr(data, quote, end - data);
+            if(!data)
+                return NULL;
+            quote = 0;
+            ++data;
+            continue;
+        }
+        gt = (const char *)memchr(data, '>', end - data);
+        size = (gt ? gt : end) - data;
+        dq = (const char *)memchr(data, '\"', size);
+        if(dq)
+            size = dq - data;
+        sq = (const char *)memchr(data, '\'', size);
+        if(sq)
+            dq = sq;
+        if(!dq)
+            return gt;
+        quote = *dq;
+        data = dq + 1;
+    }
+    return NULL;
 }
 
 namespace ucommon {
@@ -36,6 +91,7 @@ XMLParser::XMLParser(unsigned size)
     bufsize = size;
     buffer = new char[size];
     ecount = dcount = 0;
+    quote = 0;
 }
 
 XMLParser::~XMLParser()
@@ -46,128 +102,227 @@ XMLParser::~XMLParser()
     }
 }
 
-void XMLParser::putBuffer(char c)
+void XMLParser::section(caddr_t text, size_t size)
 {
-    buffer[bufpos++] = c;
-    if(bufpos >= bufsize) {
-        if(ecount)
-            characters((caddr_t)buffer, bufpos);
+    if(state == COMMENT)
+        comment(text, size);
+    else if(ecount)
+        characters(text, size);
+}
+
+// comments and cdata are passed from the data being parsed, other than
+// the dashes or brackets at the end of a chunk that may begin the close,
+// which are held in our buffer...
+const char *XMLParser::parseSection(const char *data, const char *end)
+{
+    char mark = (state == COMMENT) ? '-' : ']';
+    const char *cp = data, *gt;
+    size_t pos, held;
+    bool closed;
+
+    while(NULL != (gt = (const char *)memchr(cp, '>', end - cp))) {
+        pos = (size_t)(gt - data);
+        if(pos >= 2)
+            closed = (gt[-1] == mark && gt[-2] == mark);
+        else if(pos == 1)
+            closed = (gt[-1] == mark && bufpos);
+        else
+            closed = (bufpos >= 2);
+        if(!closed) {
+            cp = gt + 1;
+            continue;
+        }
+        held = bufpos;
+        if(pos < 2)
+            held -= (2 - pos);
+        if(held)
+            section(buffer, held);
+        if(pos > 2)
+            section((caddr_t)data, pos - 2);
         bufpos = 0;
+        state = NONE;
+        return gt + 1;
+    }
+
+    size_t size = (size_t)(end - data), tail = 0;
+    while(tail < 2 && tail < size && data[size - tail - 1] == mark)
+        ++tail;
+
+    if(tail == size) {
+        held = bufpos + size;
+        if(held > 2) {
+            section(buffer, held - 2);
+            held = 2;
+        }
+        memset(buffer, mark, held);
+        bufpos = (unsigned)held;
+        return end;
     }
+
+    if(bufpos)
+        section(buffer, bufpos);
+    section((caddr_t)data, size - tail);
+    memset(buffer, mark, tail);
+    bufpos = (unsigned)tail;
+    return end;
 }
 
-void XMLParser::clearBuffer(void)
+bool XMLParser::parseEntity(char ch)
 {
-    if(bufpos && ecount)
-        characters((caddr_t)buffer, bufpos);
+    unsigned char cp;
+
+    if((!bufpos && ch == '#') || isElement(ch)) {
+        if(bufpos + 1 >= bufsize)
+            return false;
+        buffer[bufpos++] = ch;
+        return true;
+    }
+    if(ch != ';')
+        return false;
+    buffer[bufpos] = 0;
+    if(buffer[0] == '#' && buffer[1] == 'x')
+        cp = (unsigned char)strtol(buffer + 2, NULL, 16);
+    else if(buffer[0] == '#')
+        cp = atoi(buffer + 1);
+    else if(eq(buffer, "amp"))
+        cp = '&';
+    else if(eq(buffer, "lt"))
+        cp = '<';
+    else if(eq(buffer, "gt"))
+        cp = '>';
+    else if(eq(buffer, "apos"))
+        cp = '\'';
+    else if(eq(buffer, "quot"))
+        cp = '\"';
+    else
+        return false;
+    characters((caddr_t)&cp, 1);
     bufpos = 0;
+    state = NONE;
+    return true;
 }
 
-bool XMLParser::parse(FILE *fp)
+// declarations, comments, and cdata sections are found a character at a
+// time from the start of the tag...
+bool XMLParser::parseDeclaration(char ch)
 {
-    state = NONE;
-    bufpos = 0;
-    ecount = dcount = 0;
+    if(ch == '>') {
+        buffer[bufpos] = 0;
+        state = NONE;
+        return parseTag();
+    }
+    else if(ch == '[' && bufpos == 7 && !strncmp(buffer, "![CDATA", 7)) {
+        state = CDATA;
+        bufpos = 0;
+    }
+    else if(ch == '-' && bufpos == 2 && !strncmp(buffer, "!-", 2)) {
+        state = COMMENT;
+        bufpos = 0;
+    }
+    else if(ch == '[' && !strncmp(buffer, "!DOCTYPE ", 9)) {
+        state = DTD;
+        bufpos = 0;
+    }
+    else if(bufpos + 1 >= bufsize)
+        return false;
+    else
+        buffer[bufpos++] = ch;
+    return true;
+}
 
-    int ch;
-    unsigned char cp;
+const char *XMLParser::parseChunk(const char *data, const char *end)
+{
+    const char *cp;
+    size_t size;
 
-    while((ch = fgetc(fp)) != EOF) {
+    while(data < end) {
         switch(state) {
+        case END:
+            return data;
+        case NONE:
+            // text outside of the document is skipped
+            cp = (const char *)memchr(data, '<', end - data);
+            if(!cp)
+                cp = end;
+            if(ecount) {
+                const char *amp = (const char *)memchr(data, '&', cp - data);
+                if(amp)
+                    cp = amp;
+                if(cp > data)
+                    characters((caddr_t)data, cp - data);
+            }
+            if(cp == end)
+                return end;
+            state = (*cp == '<') ? TAG : AMP;
+            bufpos = 0;
+            quote = 0;
+            data = cp + 1;
+            break;
         case AMP:
-            if((!bufpos && ch == '#') || isElement(ch)) {
-                buffer[bufpos++] = ch;
+            if(!parseEntity(*(data++)))
+                return NULL;
+            break;
+        case TAG:
+            if((bufpos && buffer[0] == '!') || (!bufpos && *data == '!')) {
+                if(!parseDeclaration(*(data++)))
+                    return NULL;
                 break;
             }
-            if(ch != ';')
-                return false;
+            cp = tagend(data, end, quote);
+            size = (cp ? cp : end) - data;
+            if(bufpos + size >= bufsize)
+                return NULL;
+            memcpy(buffer + bufpos, data, size);
+            bufpos += (unsigned)size;
+            if(!cp)
+                return end;
             buffer[bufpos] = 0;
-            if(buffer[0] == '#')
-                cp = atoi(buffer + 1);
-            else if(eq(buffer, "amp"))
-                cp = '&';
-            else if(eq(buffer, "lt"))
-                cp = '<';
-            else if(eq(buffer, "gt"))
-                cp = '>';
-            else if(eq(buffer, "apos"))
-                cp = '`';
-            else if(eq(buffer, "quot"))
-                cp = '\"';
-            else
-                return false;
-            characters((caddr_t)&cp, 1);
-            bufpos = 0;
+            data = cp + 1;
             state = NONE;
-            break;
-        case TAG:
-            if(ch == '>') {
-                state = NONE;
-                if(!parseTag())
-                    return false;
-            }
-            else if(ch == '[' && bufpos == 7 && !strncmp(buffer, "![CDATA", 7)) {
-                state = CDATA;
-            }
-            else if(ch == '-' && bufpos == 2 && !strncmp(buffer, "!-", 2)) {
-                state = COMMENT;
-                bufpos = 0;
-            }
-            else if(ch == '[' && !strncmp(buffer, "!DOCTYPE ", 9)) {
-                state = DTD;
-                bufpos = 0;
-            }
-            else
-                putBuffer(ch);
+            if(!parseTag())
+                return NULL;
             break;
         case COMMENT:
-            if(ch == '>' && bufpos >= 2 && !strncmp(&buffer[bufpos - 2], "--", 2)) {
-                bufpos -= 2;
-                if(bufpos)
-                    comment((caddr_t)buffer, bufpos);
-                bufpos = 0;
-                state = NONE;
-            }
-            else {
-                buffer[bufpos++] = ch;
-                if(bufpos == bufsize) {
-                    comment((caddr_t)buffer, bufpos);
-                    bufpos = 0;
-                }
-            }
-            break;
         case CDATA:
-            putBuffer(ch);
-            if(bufpos > 2)
-                if(eq(&buffer[bufpos - 3], "]]>")) {
-                    bufpos -= 3;
-                    state = NONE;
-                    clearBuffer();
-                }
+            data = parseSection(data, end);
             break;
         case DTD:
-            if(ch == '<')
-                ++dcount;
-            else if(ch == '>' && dcount)
-                --dcount;
-            else if(ch == '>')
-                state = NONE;
-            break;
-        case NONE:
-            if(ch == '<') {
-                clearBuffer();
-                state = TAG;
-            }
-            else if(ecount && ch == '&') {
-                clearBuffer();
-                state = AMP;
+            while(data < end && state == DTD) {
+                if(*data == '<')
+                    ++dcount;
+                else if(*data == '>' && dcount)
+                    --dcount;
+                else if(*data == '>')
+                    state = NONE;
+                ++data;
             }
-            else if(ecount)
-                putBuffer(ch);
             break;
-        case END:
-            return true;
         }
+    }
+    return data;
+}
+
+// streams are read in chunks that end with a '>', since that is the only
+// place a document can end, so we never read past the end of a document...
+bool XMLParser::parse(FILE *fp)
+{
+    char chunk[1024];
+    size_t len;
+    int ch = 0;
+
+    state = NONE;
+    bufpos = 0;
+    ecount = dcount = 0;
+
+    while(ch != EOF) {
+        len = 0;
+        while(len < sizeof(chunk) && (ch = fgetc(fp)) != EOF) {
+            chunk[len++] = (char)ch;
+            if(ch == '>')
+                break;
+        }
+        if(!parseChunk(chunk, chunk + len))
+            return false;
         if(state == END)
             return true;
     }
@@ -175,112 +330,25 @@ bool XMLParser::parse(FILE *fp)
     return false;
 }
 
-
 bool XMLParser::parse(CharacterProtocol& io)
 {
+    char chunk[1024];
+    size_t len;
+    int ch = 0;
+
     state = NONE;
     bufpos = 0;
     ecount = dcount = 0;
 
-    int ch;
-    unsigned char cp;
-
-    while((ch = io.getchar()) != EOF) {
-        switch(state) {
-        case AMP:
-            if((!bufpos && ch == '#') || isElement(ch)) {
-                buffer[bufpos++] = ch;
+    while(ch != EOF) {
+        len = 0;
+        while(len < sizeof(chunk) && (ch = io.getchar()) != EOF) {
+            chunk[len++] = (char)ch;
+            if(ch == '>')
                 break;
-            }
-            if(ch != ';')
-                return false;
-            buffer[bufpos] = 0;
-            if(buffer[0] == '#')
-                cp = atoi(buffer + 1);
-            else if(eq(buffer, "amp"))
-                cp = '&';
-            else if(eq(buffer, "lt"))
-                cp = '<';
-            else if(eq(buffer, "gt"))
-                cp = '>';
-            else if(eq(buffer, "apos"))
-                cp = '`';
-            else if(eq(buffer, "quot"))
-                cp = '\"';
-            else
-                return false;
-            characters((caddr_t)&cp, 1);
-            bufpos = 0;
-            state = NONE;
-            break;
-        case TAG:
-            if(ch == '>') {
-                state = NONE;
-                if(!parseTag())
-                    return false;
-            }
-            else if(ch == '[' && bufpos == 7 && !strncmp(buffer, "![CDATA", 7)) {
-                state = CDATA;
-            }
-            else if(ch == '-' && bufpos == 2 && !strncmp(buffer, "!-", 2)) {
-                state = COMMENT;
-                bufpos = 0;
-            }
-            else if(ch == '[' && !strncmp(buffer, "!DOCTYPE ", 9)) {
-                state = DTD;
-                bufpos = 0;
-            }
-            else
-                putBuffer(ch);
-            break;
-        case COMMENT:
-            if(ch == '>' && bufpos >= 2 && !strncmp(&buffer[bufpos - 2], "--", 2)) {
-                bufpos -= 2;
-                if(bufpos)
-                    comment((caddr_t)buffer, bufpos);
-                bufpos = 0;
-                state = NONE;
-            }
-            else {
-                buffer[bufpos++] = ch;
-                if(bufpos == bufsize) {
-                    comment((caddr_t)buffer, bufpos);
-                    bufpos = 0;
-                }
-            }
-            break;
-        case CDATA:
-            putBuffer(ch);
-            if(bufpos > 2)
-                if(eq(&buffer[bufpos - 3], "]]>")) {
-                    bufpos -= 3;
-                    state = NONE;
-                    clearBuffer();
-                }
-            break;
-        case DTD:
-            if(ch == '<')
-                ++dcount;
-            else if(ch == '>' && dcount)
-                --dcount;
-            else if(ch == '>')
-                state = NONE;
-            break;
-        case NONE:
-            if(ch == '<') {
-                clearBuffer();
-                state = TAG;
-            }
-            else if(ecount && ch == '&') {
-                clearBuffer();
-                state = AMP;
-            }
-            else if(ecount)
-                putBuffer(ch);
-            break;
-        case END:
-            return true;
         }
+        if(!parseChunk(chunk, chunk + len))
+            return false;
         if(state == END)
             return true;
     }
@@ -288,107 +356,65 @@ bool XMLParser::parse(CharacterProtocol& io)
     return false;
 }
 
+bool XMLParser::parse(const char *path)
+{
+#ifdef  XML_MAPPED
+    struct stat ino;
+    int fd = ::open(path, O_RDONLY);
+    void *map = MAP_FAILED;
+
+    if(fd < 0)
+        return false;
+
+    // handlers get writable text, so they may change a private copy...
+    if(!fstat(fd, &ino) && ino.st_size > 0)
+        map = mmap(NULL, (size_t)ino.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if(map != MAP_FAILED) {
+        const char *data = (const char *)map;
+        size_t size = (size_t)ino.st_size;
+
+#ifdef  MADV_SEQUENTIAL
+        madvise(map, size, MADV_SEQUENTIAL);
+#endif
+        state = NONE;
+        bufpos = 0;
+        ecount = dcount = 0;
+        data = parseChunk(data, data + size);
+        munmap(map, size);
+        return data != NULL && state == END;
+    }
+#endif
+
+    FILE *fp = fopen(path, "r");
+    if(!fp)
+        return false;
+
+    bool result = parse(fp);
+    fclose(fp);
+    return result;
+}
+
 bool XMLParser::partial(const char *data, size_t len)
 {
+    const char *end = data + len;
+
     if(state == END)
         state = NONE;
 
-    unsigned char cp;
-    while(len--) {
-        switch(state) {
-        case AMP:
-            if((!bufpos && *data == '#') || isElement(*data)) {
-                buffer[bufpos++] = *data;
-                break;
-            }
-            if(*data != ';')
-                return false;
-            buffer[bufpos] = 0;
-            if(buffer[0] == '#')
-                cp = atoi(buffer + 1);
-            else if(eq(buffer, "amp"))
-                cp = '&';
-            else if(eq(buffer, "lt"))
-                cp = '<';
-            else if(eq(buffer, "gt"))
-                cp = '>';
-            else if(eq(buffer, "apos"))
-                cp = '`';
-            else if(eq(buffer, "quot"))
-                cp = '\"';
-            else
-                return false;
-            characters((caddr_t)&cp, 1);
-            bufpos = 0;
+    while(data < end) {
+        data = parseChunk(data, end);
+        if(!data)
+            return false;
+
+        // text after a document is skipped up to the next one...
+        if(data < end && state == END) {
+            data = (const char *)memchr(data, '<', end - data);
+            if(!data)
+                return true;
             state = NONE;
-            break;
-        case TAG:
-            if(*data == '>') {
-                state = NONE;
-                if(!parseTag())
-                    return false;
-            }
-            else if(*data == '[' && bufpos == 7 && !strncmp(buffer, "![CDATA", 7)) {
-                state = CDATA;
-            }
-            else if(*data == '-' && bufpos == 2 && !strncmp(buffer, "!-", 2)) {
-                state = COMMENT;
-                bufpos = 0;
-            }
-            else if(*data == '[' && !strncmp(buffer, "!DOCTYPE ", 9)) {
-                state = DTD;
-                bufpos = 0;
-            }
-            else
-                putBuffer(*data);
-            break;
-        case COMMENT:
-            if(*data == '>' && bufpos >= 2 && !strncmp(&buffer[bufpos - 2], "--", 2)) {
-                bufpos -= 2;
-                if(bufpos)
-                    comment((caddr_t)buffer, bufpos);
-                bufpos = 0;
-                state = NONE;
-            }
-            else {
-                buffer[bufpos++] = *data;
-                if(bufpos == bufsize) {
-                    comment((caddr_t)buffer, bufpos);
-                    bufpos = 0;
-                }
-            }
-            break;
-        case CDATA:
-            putBuffer(*data);
-            if(bufpos > 2)
-                if(eq(&buffer[bufpos - 3], "]]>")) {
-                    bufpos -= 3;
-                    state = NONE;
-                    clearBuffer();
-                }
-            break;
-        case DTD:
-            if(*data == '<')
-                ++dcount;
-            else if(*data == '>' && dcount)
-                --dcount;
-            else if(*data == '>')
-                state = NONE;
-            break;
-        case NONE:
-        case END:
-            if(*data == '<') {
-                clearBuffer();
-                state = TAG;
-            }
-            else if(ecount && *data == '&') {
-                clearBuffer();
-                state = AMP;
-            }
-            else if(ecount)
-                putBuffer(*data);
         }
-        ++data;
     }
     return true;
 }
@@ -84,6 +84,18 @@ bool Digest::put(const void *address, size_t size)
     return true;
 }
 
+// gnutls hashes each stream with its own accelerated transforms
+bool Digest::batch(Digest **digests, const void **memory, const size_t *size, unsigned count)
+{
+    bool result = true;
+
+    for(unsigned pos = 0; pos < count; ++pos) {
+        if(!digests[pos]->put(memory[pos], size[pos]))
+            result = false;
+    }
+    return result;
+}
+
 void Digest::reset(void)
 {
     unsigned char temp[MAX_DIGEST_HASHSIZE / 8];
@@ -22,6 +22,15 @@
 #include <gnutls/gnutls.h>
 #include <gnutls/crypto.h>
 
+// gnutls hands established records to the kernel when so configured...
+#if GNUTLS_VERSION_NUMBER >= 0x030703
+#include <gnutls/socket.h>
+#define KTLS_SENDS
+#endif
+
+// largest tls record, which whole record buffering is sized for
+#define TLS_RECORD  16384
+
 #ifdef  _MSWINDOWS_
 #include <wincrypt.h>
 #endif
@@ -130,4 +130,90 @@ size_t SSLBuffer::_pull(char *address, size_t size)
     return (size_t)result;
 }
 
+bool SSLBuffer::records(void)
+{
+    if(!is_open())
+        return false;
+
+    if(!bio) {
+        allocate(TLS_RECORD);
+        return false;
+    }
+
+    allocate(gnutls_record_get_max_size((SSL)ssl));
+    return true;
+}
+
+bool SSLBuffer::is_offloaded(void) const
+{
+#ifdef  KTLS_SENDS
+    if(bio)
+        return (gnutls_transport_is_ktls_enabled((SSL)ssl) & GNUTLS_KTLS_SEND) != 0;
+#endif
+    return false;
+}
+
+size_t SSLBuffer::_sendv(const struct iovec *vector, unsigned count)
+{
+    size_t total = 0;
+
+    if(!bio || is_offloaded())
+        return TCPBuffer::_sendv(vector, count);
+
+    // slices are gathered in the buffer, and so sent as full records
+    while(count--) {
+        if(put(vector->iov_base, vector->iov_len) < vector->iov_len)
+            return total;
+        total += vector->iov_len;
+        ++vector;
+    }
+
+    // a failed flush leaves the tail of our slices unsent
+    if(!flush())
+        return total > output_waiting() ? total - output_waiting() : 0;
+
+    return total;
+}
+
+size_t SSLBuffer::_sendfile(fsys& file, size_t size)
+{
+    char buf[8192];
+    size_t total = 0;
+    ssize_t result;
+
+    if(!bio)
+        return TCPBuffer::_sendfile(file, size);
+
+    if(ioerr || !flush())
+        return 0;
+
+#ifdef  KTLS_SENDS
+    if(is_offloaded()) {
+        while(total < size) {
+            result = gnutls_record_send_file((SSL)ssl, file.handle(), NULL, size - total);
+            if(result == GNUTLS_E_INTERRUPTED || result == GNUTLS_E_AGAIN)
+                continue;
+            if(result < 1)
+                break;
+            total += result;
+        }
+        if(total < size)
+            ioerr = EIO;
+        return total;
+    }
+#endif
+
+    while(total < size) {
+        result = file.read(buf, (size - total) > sizeof(buf) ? sizeof(buf) : size - total);
+        if(result < 1)
+            break;
+        if(put(buf, result) < (size_t)result)
+            return total;
+        total += result;
+    }
+
+    flush();
+    return total;
+}
+
 } // namespace ucommon
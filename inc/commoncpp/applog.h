@@ -153,6 +153,9 @@ class __LOCAL AppLogPrivate;
  *
  * It can be used to log directly on a file or in a spooler like way. Latter
  * uses a ost::ThreadQueue to implement a thread safe access to logger.
+ * A third, asynchronous, way gives each subscribed thread a lock-free ring
+ * that a single writer thread gathers into the file, so that logging threads
+ * never take a lock or allocate memory.
  *
  * It provides a global stream variable called ost::alog.
  *
@@ -179,6 +182,15 @@ class __EXPORT AppLog : protected streambuf, public ostream
     static std::map<string, Slog::Level> *assoc;
 
   public:
+    /**
+     * What asynchronous logging does when a thread's ring is full.
+     */
+    enum Overflow
+    {
+      overflowDrop,   ///< discard the message and count it as dropped
+      overflowBlock   ///< wait for the writer thread to make room
+    };
+
     /**
      * Ident class that represents module name.
      */
@@ -281,6 +293,24 @@ class __EXPORT AppLog : protected streambuf, public ostream
      */
     void logFileName(const char* FileName, bool logDirectly = false);
 #endif
+    /**
+     * Switches to asynchronous logging into the current log file.  Each
+     * subscribed thread formats its messages into its own lock-free ring,
+     * and a single writer thread gathers all rings into the file with
+     * writev.  This stays in effect until the next logFileName().  Pipes
+     * and Windows keep using the spooler.
+     * @param ringSize bytes of ring for each subscribed thread.
+     * @param policy when a thread's ring is full.
+     */
+    void asyncEnable(size_t ringSize = 65536, Overflow policy = overflowBlock);
+
+    /**
+     * Number of messages discarded by asynchronous logging because
+     * a ring was full.
+     * @return messages dropped.
+     */
+    unsigned long dropped(void);
+
     /**
      * if logDirectly is set it closes the file.
      */
@@ -324,13 +324,22 @@ public:
  * Unlike with Assoc, This form of map table also allows objects to be
  * removed from the table.  This table also includes a mutex lock for
  * thread safety.  A free list is also optionally maintained for reusable
- * maps.
+ * maps.  A concurrent map table is looked up without locking, and grows
+ * its slots as objects are added.
  *
  * @author David Sugar <dyfet@gnutelephony.org>
  * @short Table to hold hash indexed objects.
  */
 class __EXPORT MapTable : public Mutex
 {
+private:
+    bool concurrent;
+    volatile long sequence;
+    ucommon::atomic::epoch readers;
+
+    unsigned index(const char *id);
+    void grow(void);
+
 protected:
     friend class MapObject;
     friend class MapIndex;
@@ -348,6 +357,20 @@ public:
      */
     MapTable(unsigned size);
 
+    /**
+     * Create a map table that may be concurrent.  Lookups in a concurrent
+     * table take no lock, and only register as readers of the current
+     * epoch.  Objects are still added and removed under the table mutex,
+     * and removal waits for readers that may still be passing the object
+     * before it returns, so that it can then be freed or reused.  The
+     * slots are doubled whenever the table holds more objects than slots.
+     * Where atomics are not supported, lookups lock the table instead.
+     *
+     * @param number of slots to start with.
+     * @param concurrent to look up without locking.
+     */
+    MapTable(unsigned size, bool concurrent);
+
     /**
      * Destroy the table, calls cleanup.
      */
@@ -356,13 +379,22 @@ public:
     /**
      * Get index value from id string.  This function can be changed
      * as needed to provide better collision avoidence for specific
-     * tables.
+     * tables.  A concurrent table, which may be resized, always indexes
+     * by the case insensitive hash of the default version.
      *
      * @param id string
      * @return index slot in table.
      */
     virtual unsigned getIndex(const char *id);
 
+    /**
+     * Test if the table is looked up without locking.
+     *
+     * @return true if concurrent.
+     */
+    inline bool isConcurrent(void) const
+        {return concurrent;}
+
     /**
      * Return range of this table.
      *
@@ -381,7 +413,7 @@ public:
 
     /**
      * Lookup an object by id key.  It is returned as void * for
-     * easy re-cast.
+     * easy re-cast.  A concurrent table is looked up without locking.
      *
      * @param key to find.
      * @return pointer to found object or NULL.
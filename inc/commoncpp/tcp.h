@@ -318,6 +318,9 @@ private:
 
     void segmentBuffering(unsigned mss);
 
+    ssize_t readStream(char *data, size_t len);
+    size_t writeStream(const char *data, size_t len);
+
     friend TCPStream& crlf(TCPStream&);
     friend TCPStream& lfcr(TCPStream&);
 
@@ -348,6 +351,14 @@ public:
      */
     int getSegmentSize(void);
 
+    /**
+     * Resize stream buffering for bulk transfer.  The stream buffers
+     * are made to hold as many of the measured protocol segments as fit
+     * in 64k, so that each refill or flush moves several segments.  Any
+     * pending output is sent first, and unread input is kept.
+     */
+    void bulkBuffering(void);
+
 protected:
     /**
      * Used to allocate the buffer space needed for iostream
@@ -390,6 +401,30 @@ protected:
      */
     int overflow(int ch);
 
+    /**
+     * This streambuf method is used to read a block from the stream.
+     * Whatever is in the input buffer is taken first, and a remainder as
+     * large as the buffer, or any remainder when in interactive mode, is
+     * read straight from the tcp connection into the block.
+     *
+     * @param data to read into.
+     * @param size of block to read.
+     * @return number of bytes read, less than size at end of stream.
+     */
+    std::streamsize xsgetn(char *data, std::streamsize size);
+
+    /**
+     * This streambuf method is used to write a block to the stream.
+     * A block as large as the buffer, or any block when in interactive
+     * mode, is written straight to the tcp connection after any pending
+     * output, rather than copied through the output buffer.
+     *
+     * @param data to write.
+     * @param size of block to write.
+     * @return number of bytes written.
+     */
+    std::streamsize xsputn(const char *data, std::streamsize size);
+
     /**
      * Create a TCP stream by connecting to a TCP socket (on
      * a remote machine).
@@ -497,7 +532,8 @@ public:
     int sync(void);
 
     /**
-     * Print content into a socket.
+     * Print content into a socket.  It is formatted in place in the
+     * output buffer, and sent at once with any output pending before it.
      *
      * @return count of bytes sent.
      * @param format string
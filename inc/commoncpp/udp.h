@@ -211,6 +211,24 @@ public:
      */
     ssize_t receive(void *buf, size_t len, bool reply = false);
 
+    /**
+     * Send a batch of message packets.  Packets without their own
+     * address are sent to the peer host.
+     *
+     * @param batch of packets to send.
+     * @return number of packets sent.
+     */
+    unsigned send(ucommon::DatagramBatch& batch);
+
+    /**
+     * Receive a batch of messages from any host, with the sender of
+     * each saved in the batch.
+     *
+     * @param batch to receive into.
+     * @return number of packets received.
+     */
+    unsigned receive(ucommon::DatagramBatch& batch);
+
     /**
      * Examine address of sender of next waiting packet.  This also
      * sets "peer" address to the sender so that the next "send"
@@ -413,6 +431,16 @@ public:
     inline ssize_t transmit(const char *buffer, size_t len)
         {return ::send(so, buffer, len, MSG_DONTWAIT|MSG_NOSIGNAL);}
 
+    /**
+     * Transmit a batch of packets to the connected peer without
+     * blocking.  Packets that could not be queued remain in the batch.
+     *
+     * @return number of packets sent.
+     * @param batch of packets to send.
+     */
+    inline unsigned transmit(ucommon::DatagramBatch& batch)
+        {return batch.send(so, MSG_DONTWAIT);}
+
     /**
      * See if output queue is empty for sending more packets.
      *
@@ -528,6 +556,15 @@ public:
     inline ssize_t receive(void *buf, size_t len)
         {return ::recv(so, (char *)buf, len, 0);}
 
+    /**
+     * Receive a batch of data packets with one call.
+     *
+     * @return number of packets received.
+     * @param batch to receive into.
+     */
+    inline unsigned receive(ucommon::DatagramBatch& batch)
+        {return batch.receive(so);}
+
     /**
      * See if input queue has data packets available.
      *
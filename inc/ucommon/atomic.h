@@ -47,6 +47,88 @@ public:
      */
     static const bool simulated;
 
+    /**
+     * Load a value shared with other threads.  Later loads and stores of
+     * the calling thread are not moved before it.
+     * @param pointer to value.
+     * @return current value.
+     */
+    static long load(const volatile long *pointer);
+
+    /**
+     * Load a pointer shared with other threads.  Later loads and stores
+     * of the calling thread are not moved before it.
+     * @param pointer to pointer.
+     * @return current pointer.
+     */
+    static void *load(void *const volatile *pointer);
+
+    /**
+     * Load a size shared with other threads.  Later loads and stores of
+     * the calling thread are not moved before it.
+     * @param pointer to size.
+     * @return current size.
+     */
+    static size_t load(const volatile size_t *pointer);
+
+    /**
+     * Store a value shared with other threads.  Earlier loads and stores
+     * of the calling thread are completed before it.
+     * @param pointer to value.
+     * @param value to store.
+     */
+    static void store(volatile long *pointer, long value);
+
+    /**
+     * Publish a pointer shared with other threads.  Earlier loads and
+     * stores of the calling thread, such as those that built the object,
+     * are completed before it.
+     * @param pointer to pointer.
+     * @param value to publish.
+     */
+    static void store(void *volatile *pointer, void *value);
+
+    /**
+     * Store a size shared with other threads.  Earlier loads and stores
+     * of the calling thread are completed before it.
+     * @param pointer to size.
+     * @param value to store.
+     */
+    static void store(volatile size_t *pointer, size_t value);
+
+    /**
+     * Replace a value shared with other threads if it is still what we
+     * expect.  This is a full barrier.
+     * @param pointer to value.
+     * @param expected value.
+     * @param value to store.
+     * @return true if replaced.
+     */
+    static bool cas(volatile long *pointer, long expected, long value);
+
+    /**
+     * Replace a size shared with other threads if it is still what we
+     * expect.  This is a full barrier.
+     * @param pointer to size.
+     * @param expected size.
+     * @param value to store.
+     * @return true if replaced.
+     */
+    static bool cas(volatile size_t *pointer, size_t expected, size_t value);
+
+    /**
+     * Add to a value shared with other threads.  This is a full barrier.
+     * @param pointer to value.
+     * @param offset to add.
+     * @return new value.
+     */
+    static long add(volatile long *pointer, long offset);
+
+    /**
+     * Full memory barrier.  Loads and stores are not moved across it.
+     */
+    static void fence(void);
+
     /**
      * Atomic counter class.  Can be used to manipulate value of an
      * atomic counter without requiring explicit thread locking.
@@ -100,6 +182,46 @@ public:
          */
         void release(void);
     };
+
+    /**
+     * Atomic epoch for lockfree readers.  Readers register in the count
+     * of the current epoch, and a writer that has published a change
+     * flips the epoch and waits for the readers of the prior one to leave
+     * before it frees what they may still be using.  Readers never wait.
+     * Writers must be serialized by the caller, and a thread must never
+     * wait for an epoch it is still reading.
+     * @author David Sugar <dyfet@gnutelephony.org>
+     */
+    class __EXPORT epoch
+    {
+    private:
+        volatile long current;
+        volatile long readers[2];
+
+    public:
+        /**
+         * Construct and initialize epoch.
+         */
+        epoch();
+
+        /**
+         * Register as a reader of the current epoch.
+         * @return reader slot to pass to leave.
+         */
+        unsigned enter(void);
+
+        /**
+         * Leave the epoch we entered.
+         * @param reader slot returned by enter.
+         */
+        void leave(unsigned reader);
+
+        /**
+         * Start a new epoch and wait for readers of the prior one.  Changes
+         * published before this are seen by all readers after it returns.
+         */
+        void synchronize(void);
+    };
 };
 
 } // namespace ucommon
@@ -57,6 +57,12 @@ namespace ucommon {
  */
 class __EXPORT TCPBuffer : public BufferProtocol, protected Socket
 {
+private:
+    size_t zerocopy_min;
+    unsigned zerocopy_sent;
+
+    __LOCAL size_t _writev(struct iovec *vector, unsigned count);
+
 protected:
     void _buffer(size_t size);
 
@@ -121,12 +127,60 @@ public:
      */
     void close(void);
 
+    /**
+     * Send pending output followed by gathered slices in one physical
+     * write, without copying the slices through the output buffer.  This
+     * is useful for sending a header and a body that are held separately.
+     * @param vector of slices to send.
+     * @param count of slices in vector.
+     * @return number of bytes of slices sent, short if error.
+     */
+    size_t sendv(const struct iovec *vector, unsigned count);
+
+    /**
+     * Send a file from its current position after any pending output.
+     * Where supported the kernel moves the file data directly to the
+     * socket, otherwise it is read and written through the buffer.
+     * @param file to send from.
+     * @param size of data to send.
+     * @return number of bytes sent, short if error or end of file.
+     */
+    size_t sendfile(fsys& file, size_t size);
+
+    /**
+     * Use zero copy sends for gathered writes of at least a minimum size.
+     * The kernel then sends directly from the slices, and sendv waits for
+     * their completion before returning so they may be safely reused.  This
+     * is only worth doing for large payloads.
+     * @param minimum size to send zero copy, 0 to disable.
+     * @return true if zero copy is supported.
+     */
+    bool zerocopy(size_t minimum);
+
 protected:
     /**
      * Check for pending tcp or ssl data.
      * @return true if data pending.
      */
     virtual bool _pending(void);
+
+    /**
+     * Send gathered slices after pending output.  This is the physical
+     * method used by sendv, and may be overridden for ssl.
+     * @param vector of slices to send.
+     * @param count of slices in vector.
+     * @return number of bytes of slices sent.
+     */
+    virtual size_t _sendv(const struct iovec *vector, unsigned count);
+
+    /**
+     * Send from a file after pending output.  This is the physical method
+     * used by sendfile, and may be overridden for ssl.
+     * @param file to send from.
+     * @param size of data to send.
+     * @return number of bytes sent.
+     */
+    virtual size_t _sendfile(fsys& file, size_t size);
 };
 
 /**
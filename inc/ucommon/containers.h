@@ -202,6 +202,112 @@ public:
     bool operator!() const;
 };
 
+/**
+ * Bounded lock-free ring buffer of objects.  Like Buffer, this holds
+ * physical copies of same sized objects passed through it in fifo order,
+ * but it may be used with any number of producer and consumer threads at
+ * once.  Each slot carries a sequence number that hands it between the
+ * producer and consumer sides, so the common put and get paths use only
+ * atomic operations and no locking.  The conditional is only used to block
+ * threads when the ring is found empty or full.  Since slots are reused
+ * as soon as they are consumed, objects are always copied out of the ring
+ * rather than accessed in place.  When gcc atomics are not enabled the
+ * ring is simply serialized by its conditional.  The ring is normally
+ * used through the ringof<type> template.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+class __EXPORT Ring : protected Conditional
+{
+private:
+    enum {PADDING = 64};
+
+    size_t objsize, slotsize;
+    caddr_t slots;
+    size_t mask;
+    char pad1[PADDING];
+    volatile size_t head;
+    char pad2[PADDING];
+    volatile size_t tail;
+    char pad3[PADDING];
+    volatile unsigned waiting;
+
+    bool push(const void *data);
+    bool pull(void *data);
+    void wakeup(void);
+
+protected:
+    /**
+     * Create a ring to hold a series of objects.  The number of objects
+     * is rounded up to a power of two.
+     * @param size of each object in ring.
+     * @param count of objects in the ring.
+     */
+    Ring(size_t typesize, size_t count);
+
+    /**
+     * Deallocate ring.
+     */
+    virtual ~Ring();
+
+    /**
+     * Put (copy) an object into the ring.  This blocks while the ring
+     * is full.
+     * @param data to copy into the ring.
+     */
+    void put(const void *data);
+
+    /**
+     * Put (copy) an object into the ring.
+     * @param data to copy into the ring.
+     * @param timeout to wait if ring is full.
+     * @return true if copied, false if timed out while full.
+     */
+    bool put(const void *data, timeout_t timeout);
+
+    /**
+     * Copy the next object out of the ring.  This blocks until an object
+     * becomes available.
+     * @param data pointer to copy into.
+     */
+    void get(void *data);
+
+    /**
+     * Copy the next object out of the ring.
+     * @param data pointer to copy into.
+     * @param timeout to wait when ring is empty in milliseconds.
+     * @return true if object copied, or false if timed out.
+     */
+    bool get(void *data, timeout_t timeout);
+
+public:
+    /**
+     * Get the number of object slots in the ring.
+     * @return size of the ring.
+     */
+    unsigned size(void) const;
+
+    /**
+     * Get the number of objects in the ring currently.  This is only
+     * a snapshot when other threads are active.
+     * @return number of objects in ring.
+     */
+    unsigned count(void) const;
+
+    /**
+     * Test if there is data waiting in the ring.
+     * @return true if ring has data.
+     */
+    inline operator bool() const
+        {return count() > 0;}
+
+    /**
+     * Test if the ring is empty.
+     * @return true if the ring is empty.
+     */
+    inline bool operator!() const
+        {return count() == 0;}
+};
+
 /**
  * Manage a thread-safe queue of objects through reference pointers.  This
  * can be particularly interesting when used to enqueue/dequeue reference
@@ -447,7 +553,7 @@ public:
      * @return pointer to next typed object from buffer.
      */
     inline T *get(void)
-        {return static_cast<T*>(get());}
+        {return static_cast<T*>(Buffer::get());}
 
     /**
      * Get the next typed object from the buffer.
@@ -455,7 +561,7 @@ public:
      * @return pointer to next typed object in the buffer or NULL if timed out.
      */
     inline T *get(timeout_t timeout)
-        {return static_cast<T*>(get(timeout));}
+        {return static_cast<T*>(Buffer::get(timeout));}
 
     /**
      * Put (copy) a typed object into the buffer.  This blocks while the buffer
@@ -463,7 +569,7 @@ public:
      * @param object to copy into the buffer.
      */
     inline void put(T *object)
-        {put(object);}
+        {Buffer::put(object);}
 
     /**
      * Put (copy) an object into the buffer.
@@ -472,7 +578,7 @@ public:
      * @return true if copied, false if timed out while full.
      */
     inline bool put(T *object, timeout_t timeout)
-        {return put(object, timeout);}
+        {return Buffer::put(object, timeout);}
 
     /**
      * Copy the next typed object from the buffer.  This blocks until an object
@@ -480,7 +586,7 @@ public:
      * @param object pointer to copy typed object into.
      */
     inline void copy(T *object)
-        {copy(object);}
+        {Buffer::copy(object);}
 
     /**
      * Copy the next typed object from the buffer.
@@ -489,7 +595,7 @@ public:
      * @return true if object copied, or false if timed out.
      */
     inline bool get(T *object, timeout_t timeout)
-        {return copy(object, timeout);}
+        {return Buffer::copy(object, timeout);}
 
     /**
      * Examine past item in the buffer.  This is a typecast of the peek
@@ -498,7 +604,7 @@ public:
      * @return item pointer if valid or NULL.
      */
     inline const T& at(unsigned item)
-        {return static_cast<const T&>(Buffer::peek(item));}
+        {return *(static_cast<const T*>(Buffer::peek(item)));}
 
     /**
      * Examine past item in the buffer.  This is a typecast of the peek
@@ -507,12 +613,82 @@ public:
      * @return item pointer if valid or NULL.
      */
     inline T&operator[](unsigned item)
-        {return static_cast<T&>(Buffer::peek(item));}
+        {return *(static_cast<T*>(Buffer::peek(item)));}
 
     inline T* operator()(unsigned offset = 0)
         {return static_cast<T*>(Buffer::peek(offset));}
 };
 
+/**
+ * A templated typed class for a lock-free ring of objects.  This operates
+ * as a fifo of typed objects which are physically copied into and out of
+ * the ring, and may be used with multiple producer and multiple consumer
+ * threads.  The typed object should be a plain data type since it is
+ * copied by memory.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+template<class T>
+class ringof : public Ring
+{
+public:
+    /**
+     * Create a ring to hold a series of typed objects.
+     * @param capacity of typed objects in the ring.
+     */
+    inline ringof(unsigned capacity) :
+        Ring(sizeof(T), capacity) {}
+
+    /**
+     * Put (copy) a typed object into the ring.  This blocks while the ring
+     * is full.
+     * @param object to copy into the ring.
+     */
+    inline void put(const T *object)
+        {Ring::put(object);}
+
+    /**
+     * Put (copy) a typed object into the ring.
+     * @param object to copy into the ring.
+     * @param timeout to wait if ring is full.
+     * @return true if copied, false if timed out while full.
+     */
+    inline bool put(const T *object, timeout_t timeout)
+        {return Ring::put(object, timeout);}
+
+    /**
+     * Copy the next typed object from the ring.  This blocks until an
+     * object becomes available.
+     * @param object pointer to copy typed object into.
+     */
+    inline void get(T *object)
+        {Ring::get(object);}
+
+    /**
+     * Copy the next typed object from the ring.
+     * @param object pointer to copy typed object into.
+     * @param timeout to wait when ring is empty in milliseconds.
+     * @return true if object copied, or false if timed out.
+     */
+    inline bool get(T *object, timeout_t timeout)
+        {return Ring::get(object, timeout);}
+
+    /**
+     * Put (copy) a typed object into the ring.
+     * @param object to copy.
+     * @return ring for chaining.
+     */
+    inline ringof& operator<<(const T& object)
+        {Ring::put(&object); return *this;}
+
+    /**
+     * Copy the next typed object from the ring.
+     * @param object to copy into.
+     * @return ring for chaining.
+     */
+    inline ringof& operator>>(T& object)
+        {Ring::get(&object); return *this;}
+};
+
 /**
  * A templated typed class for thread-safe stack of object pointers.  This
  * allows one to use the stack class in a typesafe manner for a specific
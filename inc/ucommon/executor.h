@@ -0,0 +1,196 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * Work stealing task executor.
+ * Rather than deriving a thread for every short lived job, a job can be
+ * derived from a task and submitted to an executor, which runs it on a
+ * fixed pool of worker threads.  Each worker keeps its own double ended
+ * queue of tasks, and idle workers steal from the queues of busy ones.
+ * @file ucommon/executor.h
+ */
+
+#ifndef _UCOMMON_EXECUTOR_H_
+#define _UCOMMON_EXECUTOR_H_
+
+#ifndef _UCOMMON_THREAD_H_
+#include <ucommon/thread.h>
+#endif
+
+#ifndef _UCOMMON_ATOMIC_H_
+#include <ucommon/atomic.h>
+#endif
+
+namespace ucommon {
+
+/**
+ * A fixed pool of worker threads that run submitted tasks.  Tasks
+ * submitted from within a running task are pushed on the submitting
+ * worker's own queue, and are taken back in last in, first out order by
+ * that worker, while other workers steal the oldest entries from the
+ * other end.  Tasks submitted from other threads go to a shared queue.
+ * Workers may optionally be bound to a cpu each.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+class __EXPORT Executor : private Conditional
+{
+private:
+    class worker;
+
+public:
+    /**
+     * A unit of work that is run by an executor.  A task is derived
+     * with a run method, and the task object also serves as the handle
+     * that is joined to wait for it to complete.  The task object is owned
+     * by the caller, and must remain valid until it has been joined.  A
+     * task that has completed may be submitted again.
+     * @author David Sugar <dyfet@gnutelephony.org>
+     */
+    class __EXPORT task
+    {
+    private:
+        friend class Executor;
+        friend class worker;
+
+        Executor *owner;
+        task *next;
+        volatile long state;
+
+    protected:
+        /**
+         * Create a task that has not been submitted.
+         */
+        task();
+
+        /**
+         * Work of the task, run from one of the executor's workers.
+         */
+        virtual void run(void) = 0;
+
+    public:
+        /**
+         * Destroy task.  A submitted task should be joined first.
+         */
+        virtual ~task();
+
+        /**
+         * Wait for the task to complete.  When called from a worker of
+         * the same executor, other tasks are run while waiting, so a
+         * task may join the sub-tasks it submits.
+         */
+        void join(void);
+
+        /**
+         * Wait for the task to complete with a timeout.  This does not
+         * run other tasks while waiting.
+         * @param timeout to wait in milliseconds.
+         * @return true if completed, false if timer expired.
+         */
+        bool join(timeout_t timeout);
+
+        /**
+         * Test if the task has been submitted and not yet completed.
+         * @return true if pending.
+         */
+        bool is_pending(void) const;
+    };
+
+private:
+    friend class task;
+
+    worker **workers;
+    unsigned threads;
+    bool binding;
+    volatile bool running;
+    volatile unsigned sleeping;
+    volatile unsigned joining;
+    task *volatile first;
+    task *last;
+    atomic::counter outstanding;
+
+    worker *current(void);
+    bool await(task *task, timeout_t timeout);
+    task *dequeue(void);
+    void idle(void);
+    void wakeup(void);
+    void completed(void);
+    bool available(void);
+
+public:
+    /**
+     * Create an executor.  The workers are not started until start is
+     * called, although tasks may be submitted before then.
+     * @param count of worker threads, or 0 for one per online cpu.
+     * @param affinity to bind each worker to a cpu if supported.
+     * @param stack size of worker threads or 0 for default.
+     */
+    Executor(unsigned count = 0, bool affinity = false, size_t stack = 0);
+
+    /**
+     * Stop and destroy executor.  Pending tasks are completed first.
+     */
+    virtual ~Executor();
+
+    /**
+     * Start the worker threads.
+     * @param priority of worker threads.
+     */
+    void start(int priority = 0);
+
+    /**
+     * Complete all pending tasks, and then stop and join the workers.
+     */
+    void stop(void);
+
+    /**
+     * Submit a task to be run.  This may be called from any thread,
+     * including from tasks of the executor.
+     * @param task to run.
+     * @return false if task is already pending.
+     */
+    bool submit(task *task);
+
+    /**
+     * Wait until every submitted task has completed.  This is for threads
+     * outside the executor, and must not be called from a task.
+     */
+    void wait(void);
+
+    /**
+     * Get number of tasks submitted that have not completed.
+     * @return pending task count.
+     */
+    inline unsigned pending(void)
+        {return (unsigned)(long)outstanding;}
+
+    /**
+     * Get number of worker threads.
+     * @return worker count.
+     */
+    inline unsigned size(void) const
+        {return threads;}
+
+    /**
+     * Get number of online cpus, which is the default worker count.
+     * @return cpu count, at least 1.
+     */
+    static unsigned cpus(void);
+};
+
+} // namespace ucommon
+
+#endif
@@ -42,6 +42,14 @@
 #include <ucommon/memory.h>
 #endif
 
+#ifndef  _UCOMMON_THREAD_H_
+#include <ucommon/thread.h>
+#endif
+
+#ifndef  _UCOMMON_STRING_H_
+#include <ucommon/string.h>
+#endif
+
 namespace ucommon {
 
 class keyfile;
@@ -63,6 +71,7 @@ private:
     keydata(keyfile *file, const char *id);
     const char *name;
     keyfile *root;
+    keydata *chain;
 
 public:
     /**
@@ -75,7 +84,9 @@ public:
     private:
         friend class keydata;
         friend class keyfile;
+        keyvalue *chain;
         keyvalue(keyfile *allocator, keydata *section, const char *key, const char *data);
+        keyvalue(keydata *section, const char *key, const char *data);
     public:
         const char *id;
         const char *value;
@@ -83,6 +94,15 @@ public:
 
     friend class keyvalue;
 
+private:
+    keyvalue **hash;
+    unsigned buckets, count;
+
+    __LOCAL void assign(const char *id, const char *value);
+    __LOCAL void insert(keyvalue *key);
+    __LOCAL void remove(const char *id);
+
+public:
     /**
      * Lookup a key value by it's id.
      * @param id to look for.
@@ -145,15 +165,26 @@ public:
  * Traditional keypair config file parsing class.  This is used to get
  * generic config data either from a /etc/xxx.conf, a windows style
  * xxx.ini file, or a ~/.xxxrc file, and parses [] sections from the
- * entire file at once.
+ * entire file at once.  The file is read into memory as a whole,
+ * and keys and values loaded from it are parsed in place rather than
+ * copied.  Sections and the keys of each section are hash indexed.
  */
 class __EXPORT keyfile : public memalloc
 {
 private:
     friend class keydata;
+    class __LOCAL text;
+
     OrderedIndex index;
     keydata *defaults;
     int errcode;
+    keydata **hash;
+    unsigned buckets, count;
+    text *texts;
+
+    __LOCAL void insert(keydata *section);
+    __LOCAL void remove(keydata *section);
+    __LOCAL void parse(char *data, size_t size);
 
 protected:
     keydata *create(const char *section);
@@ -179,6 +210,11 @@ public:
 
     keyfile(const keyfile &copy, size_t pagesize = 0);
 
+    /**
+     * Destroy keyfile and release any loaded config files.
+     */
+    virtual ~keyfile();
+
     /**
      * Load (overlay) another config file over the currently loaded one.
      * This is used to merge key data, such as getting default values from
@@ -254,6 +290,76 @@ public:
         {return errcode;}
 };
 
+/**
+ * A keyfile snapshot that is shared thru a keyconfig.  The snapshot is
+ * loaded before it is shared, and is then only read.
+ */
+class __EXPORT keysnapshot : public keyfile, public SharedObject
+{
+public:
+    /**
+     * Create an empty snapshot ready for loading.
+     * @param pagesize for memory paging.
+     */
+    keysnapshot(size_t pagesize = 0);
+};
+
+/**
+ * A config file that may be reloaded while any number of threads read it.
+ * Each load builds a complete new keyfile snapshot, and then replaces the
+ * current snapshot at once.  Readers access the current snapshot thru a
+ * keyconfig::instance, which takes no locks where lock free shared
+ * pointers are supported, and a replaced snapshot is deleted once no
+ * reader still holds it.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+class __EXPORT keyconfig : public shared_pointer<keysnapshot>
+{
+private:
+    String filename;
+    size_t paging;
+    int errcode;
+
+public:
+    /**
+     * Access to the current snapshot for the life of the instance.
+     */
+    typedef shared_instance<keysnapshot> instance;
+
+    /**
+     * Create a shared config and load it from a config file.
+     * @param path to load from, or NULL to load later.
+     * @param pagesize for memory paging of each snapshot.
+     */
+    keyconfig(const char *path = NULL, size_t pagesize = 0);
+
+    /**
+     * Destroy shared config.  There must be no instances still held.
+     */
+    ~keyconfig();
+
+    /**
+     * Load a new snapshot from a config file and replace the current one.
+     * If the file cannot be read, the current snapshot is kept.
+     * @param path to load from.
+     * @return true if replaced.
+     */
+    bool load(const char *path);
+
+    /**
+     * Load a new snapshot from the last config file loaded.
+     * @return true if replaced.
+     */
+    bool reload(void);
+
+    /**
+     * Get error from the last load attempt.
+     * @return error code or 0 if loaded.
+     */
+    inline int err(void) const
+        {return errcode;}
+};
+
 } // namespace ucommon
 
 #endif
@@ -1867,7 +1867,7 @@ public:
      * @return pointer to index root.
      */
     inline NamedObject **root(void)
-        {return static_cast<NamedObject**>(&head);}
+        {return reinterpret_cast<NamedObject**>(&head);}
 
     /**
      * Return first item in ordered list.  This is commonly used to
@@ -61,6 +61,7 @@ class __EXPORT memalloc : public MemoryProtocol
 {
 private:
     friend class bufpager;
+    friend class mempager;
 
     size_t pagesize, align;
     unsigned count;
@@ -170,12 +171,22 @@ public:
  * it is best to allocate objects a significant fraction smaller than the
  * page size, as fragmentation occurs at the end of pages when there is
  * insufficient space in the current page to complete a request.
+ *
+ * When pages are a power of two in size, small requests are instead
+ * served from size class slab pages, and these may be returned with
+ * dealloc to be reused.  Each thread keeps a small cache of free blocks
+ * for each size class, and only exchanges batches of blocks with the
+ * pager's central depot under the pager mutex, so threads sharing a pager
+ * rarely contend for it.
  * @author David Sugar <dyfet@gnutelephony.org>
  */
 class __EXPORT mempager : public memalloc, public LockingProtocol
 {
 private:
+    class __LOCAL depot;
+
     mutable pthread_mutex_t mutex;
+    depot *slabs;
 
 protected:
     /**
@@ -210,7 +221,8 @@ public:
      * requests that cannot fit on an already allocated page are moved into
      * a new page, there is some unusable space left over at the end of the
      * page.  When utilization approaches 100, this is good.  A low utilization
-     * may suggest a larger page size should be used.
+     * may suggest a larger page size should be used.  Slab blocks count as
+     * used from when they are allocated until they are dealloc'd.
      * @return pager utilization.
      */
     unsigned utilization(void);
@@ -221,10 +233,10 @@ public:
     void purge(void);
 
     /**
-     * Return memory back to pager heap.  This actually does nothing, but
-     * might be used in a derived class to create a memory heap that can
-     * also receive (free) memory allocated from our heap and reuse it,
-     * for example in a full private malloc implementation in a derived class.
+     * Return memory back to pager heap.  Memory that came from a size class
+     * slab is reused by later allocations of the same size class.  Larger
+     * requests carved directly from pages are only reclaimed when the pager
+     * is purged, and so freeing those does nothing.
      * @param memory to free back to private heap.
      */
     virtual void dealloc(void *memory);
@@ -1143,7 +1155,7 @@ public:
      * @return pager utilization, 0-100.
      */
     inline unsigned utilization(void) const
-        {return mempager::utilization();}
+        {return const_cast<mapof *>(this)->mempager::utilization();}
 
     /**
      * Access to number of pages allocated from heap for our associated
@@ -1237,7 +1249,7 @@ public:
      * @return pager utilization, 0-100.
      */
     inline unsigned utilization(void) const
-        {return mempager::utilization();}
+        {return const_cast<assoc_pointer *>(this)->mempager::utilization();}
 
     /**
      * Access to number of pages allocated from heap for our associated
@@ -1296,7 +1308,8 @@ public:
      * Create the object cache.
      * @param size of allocation units.
      */
-    inline keypager(size_t size) : mempager(size) {}
+    inline keypager(size_t size) : mempager(size)
+        {memset(idx, 0, sizeof(idx));}
 
     /**
      * Destroy the hash pager by purging the index chains and memory pools.
@@ -1311,10 +1324,11 @@ public:
      * @return typed object if found through map or NULL.
      */
     inline T *get(const char *name) const {
-        T *node = (static_cast<T*>(NamedObject::map(idx, name, M)));
+        keypager *pager = const_cast<keypager *>(this);
+        T *node = (static_cast<T*>(NamedObject::map(pager->idx, name, M)));
         if(!node) {
-            node = init<T>(static_cast<T*>(mempager::_alloc(sizeof(T))));
-            node->NamedObject::add(idx, name, M);
+            node = init<T>(static_cast<T*>(pager->_alloc(sizeof(T))));
+            node->NamedObject::add(pager->idx, strdup(name), M);
         }
         return node;
     }
@@ -1382,6 +1396,236 @@ public:
     typedef linked_pointer<T> iterator;
 };
 
+/**
+ * An open addressed hash table of pointers referenced by string or binary
+ * keys.  Entries are kept directly in one slot array with robin hood
+ * probing, so a lookup usually touches one cache line rather than walking
+ * a chain of named objects, and the table doubles in size as it fills.
+ * When it grows, entries are moved from the old slot array a few at a
+ * time by later changes, so no single insert pays for rehashing the whole
+ * table.  Lookups never modify the table, but it is not locked, so
+ * changes must be serialized with any other access by the caller.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+class __EXPORT keyhash
+{
+private:
+    class __LOCAL slot;
+
+    slot *table, *older;
+    unsigned mask, oldmask;
+    unsigned used, moving;
+    unsigned cursor;
+
+    slot *find(uint32_t hash, const void *key, size_t size) const;
+    void insert(uint32_t hash, const void *key, size_t size, void *pointer);
+    void migrate(unsigned slots);
+    void grow(void);
+
+public:
+    /**
+     * Create an empty hash table.
+     * @param size of entries to reserve room for, or 0 to start small.
+     */
+    keyhash(unsigned size = 0);
+
+    /**
+     * Destroy hash table and the copies of keys it holds.
+     */
+    ~keyhash();
+
+    /**
+     * Get the number of keys in the table.
+     * @return number of keys stored.
+     */
+    inline unsigned count(void) const
+        {return used + moving;}
+
+    /**
+     * Remove all keys from the table and release its memory.
+     */
+    void purge(void);
+
+    /**
+     * Lookup the pointer associated with a binary key.
+     * @param key to lookup.
+     * @param size of key in bytes.
+     * @return pointer or NULL if not found.
+     */
+    void *locate(const void *key, size_t size) const;
+
+    /**
+     * Lookup the pointer associated with a string name.
+     * @param name to lookup.
+     * @return pointer or NULL if not found.
+     */
+    inline void *locate(const char *name) const
+        {return locate(name, strlen(name));}
+
+    /**
+     * Lookup a list of names at once.  The slots of all names are fetched
+     * from memory ahead of comparing keys, so that the cache misses of
+     * a bulk lookup overlap.
+     * @param names to lookup.
+     * @param pointers to save lookup results in, NULL if not found.
+     * @param count of names.
+     * @return number of names found.
+     */
+    unsigned locate(const char **names, void **pointers, unsigned count) const;
+
+    /**
+     * Assign a pointer to a binary key.  If the key exists, it is
+     * re-assigned, otherwise a copy of the key is created.
+     * @param key to assign.
+     * @param size of key in bytes.
+     * @param pointer value to assign with key.
+     */
+    void assign(const void *key, size_t size, void *pointer);
+
+    /**
+     * Assign a pointer to a string name.
+     * @param name to assign.
+     * @param pointer value to assign with name.
+     */
+    inline void assign(const char *name, void *pointer)
+        {assign(name, strlen(name), pointer);}
+
+    /**
+     * Create a new binary key in the table and assign its pointer.
+     * @param key to create.
+     * @param size of key in bytes.
+     * @param pointer value to assign with key.
+     * @return false if key already exists.
+     */
+    bool create(const void *key, size_t size, void *pointer);
+
+    /**
+     * Create a new string name in the table and assign its pointer.
+     * @param name to create.
+     * @param pointer value to assign with name.
+     * @return false if name already exists.
+     */
+    inline bool create(const char *name, void *pointer)
+        {return create(name, strlen(name), pointer);}
+
+    /**
+     * Remove a binary key from the table.
+     * @param key to remove.
+     * @param size of key in bytes.
+     * @return pointer value of the key or NULL if not found.
+     */
+    void *remove(const void *key, size_t size);
+
+    /**
+     * Remove a string name from the table.
+     * @param name to remove.
+     * @return pointer value of the name or NULL if not found.
+     */
+    inline void *remove(const char *name)
+        {return remove(name, strlen(name));}
+
+    /**
+     * Lookup the pointer of a string by direct operation.
+     * @param name to lookup.
+     * @return pointer or NULL if not found.
+     */
+    inline void *operator()(const char *name) const
+        {return locate(name);}
+
+    /**
+     * Hash a key.  This is a 64 bit multiply and xor-shift hash that mixes
+     * every byte of the key, with a final avalanche, folded to 32 bits.
+     * @param key to hash.
+     * @param size of key in bytes.
+     * @return hash value.
+     */
+    static uint32_t hash(const void *key, size_t size);
+};
+
+/**
+ * A typed template for an open addressed hash table of typed object
+ * pointers referenced by name.  This offers the same use as mapof and
+ * assoc_pointer, but with keyhash rather than keyassoc chains.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+template <class T>
+class hashof : private keyhash
+{
+public:
+    /**
+     * Construct a typed hash table.
+     * @param size of entries to reserve room for.
+     */
+    inline hashof(unsigned size = 0) : keyhash(size) {}
+
+    /**
+     * Get the count of typed objects stored in our hash table.
+     * @return typed objects in table.
+     */
+    inline unsigned count(void) const
+        {return keyhash::count();}
+
+    /**
+     * Purge the hash table of typed objects.
+     */
+    inline void purge(void)
+        {keyhash::purge();}
+
+    /**
+     * Lookup a typed object by name.
+     * @param name of typed object to locate.
+     * @return typed object pointer or NULL if not found.
+     */
+    inline T *locate(const char *name) const
+        {return static_cast<T*>(keyhash::locate(name));}
+
+    /**
+     * Lookup a list of typed objects by name.
+     * @param names to lookup.
+     * @param pointers to save typed object pointers in.
+     * @param count of names.
+     * @return number of names found.
+     */
+    inline unsigned locate(const char **names, T **pointers, unsigned count) const
+        {return keyhash::locate(names, (void **)pointers, count);}
+
+    inline T *operator[](const char *name) const
+        {return locate(name);}
+
+    /**
+     * Reference a typed object directly by name.
+     * @param name of typed object to locate.
+     * @return typed object pointer or NULL if not found.
+     */
+    inline T *operator()(const char *name) const
+        {return locate(name);}
+
+    /**
+     * Assign a name for a pointer to a typed object.
+     * @param name to assign.
+     * @param pointer of typed object to assign with name.
+     */
+    inline void assign(const char *name, T *pointer)
+        {keyhash::assign(name, pointer);}
+
+    /**
+     * Create a new name in the table and assign typed object.
+     * @param name to create.
+     * @param pointer of typed object to assign with name.
+     * @return false if already exists.
+     */
+    inline bool create(const char *name, T *pointer)
+        {return keyhash::create(name, pointer);}
+
+    /**
+     * Remove a name and typed pointer association.
+     * @param name to remove.
+     * @return typed object pointer that was removed or NULL.
+     */
+    inline T *remove(const char *name)
+        {return static_cast<T*>(keyhash::remove(name));}
+};
+
 /**
  * A convenience type for paged string lists.
  */
@@ -295,7 +295,7 @@ public:
         {return get(offset);}
 
     inline const T* at(unsigned offset) const
-        {return static_cast<const T&>(SparseObjects::get(offset));}
+        {return static_cast<const T*>(const_cast<sarray<T>*>(this)->SparseObjects::get(offset));}
 
 private:
     __LOCAL ObjectProtocol *create(void)
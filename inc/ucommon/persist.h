@@ -31,6 +31,7 @@
 
 #include <iostream>
 #include <string>
+#include <cstring>
 #include <vector>
 #include <deque>
 #include <map>
@@ -93,6 +94,14 @@ public:
      */
     static PersistObject* createInstanceOf(const char* name);
 
+    /**
+     * This finds the construction function of a type, or NULL if the type
+     * is not known.  An engine uses this once for each class it reads.
+     */
+    static NewPersistObjectFunction find(const char* name);
+
+    typedef registration Registration;
+
     typedef std::map<std::string,NewPersistObjectFunction> StringFunctionMap;
 };
 
@@ -184,6 +193,12 @@ public:
  * operates in the mode specified. The stream passed into the
  * constructor must be a binary mode to function properly.
  *
+ * An engine may also write an archive into memory, or read one from
+ * memory or from a mapped file, without any stream at all.  The archive
+ * is the same in either case.  Primitive values are collected in a
+ * buffer, which is written to the stream once each top level object has
+ * been written, and class names are resolved once for each stream.
+ *
  * @author Daniel Silverstone
  */
 class __EXPORT PersistEngine
@@ -204,8 +219,49 @@ public:
      */
     PersistEngine(std::iostream& stream, EngineMode mode) throw(PersistException);
 
+    /**
+     * Constructs a Persistence::Engine that writes an archive into
+     * memory.  The archive may be retrieved with getData and getSize.
+     */
+    PersistEngine();
+
+    /**
+     * Constructs a Persistence::Engine that reads an archive held in
+     * memory, such as a mapped file.  The memory must remain valid for
+     * the life of the engine.
+     * @param data of archive.
+     * @param size of archive.
+     */
+    PersistEngine(const void *data, size_t size);
+
+    /**
+     * Constructs a Persistence::Engine that reads an archive file.  The
+     * file is mapped into memory where supported.
+     * @param path of archive file.
+     */
+    PersistEngine(const char *path) throw(PersistException);
+
     virtual ~PersistEngine();
 
+    /**
+     * Write any buffered data to the underlying stream.
+     */
+    void flush(void);
+
+    /**
+     * Get the archive written into memory.
+     * @return archive data.
+     */
+    inline const uint8_t *getData(void) const
+        {return buffer;}
+
+    /**
+     * Get the size of the archive written into memory.
+     * @return size of archive.
+     */
+    inline size_t getSize(void) const
+        {return bufpos;}
+
     // Write operations
 
     /**
@@ -236,7 +292,14 @@ public:
     void write(const std::string& str) throw(PersistException);
 
     // Every write operation boils down to one or more of these
-    void writeBinary(const uint8_t* data, const uint32_t size) throw(PersistException);
+    inline void writeBinary(const uint8_t* data, const uint32_t size) throw(PersistException) {
+        if(size <= buflimit - bufpos) {
+            memcpy(buffer + bufpos, data, size);
+            bufpos += size;
+        }
+        else
+            writeBuffer(data, size);
+    }
 
     // Read Operations
 
@@ -267,9 +330,39 @@ public:
     void read(std::string& str) throw(PersistException);
 
     // Every read operation boiled down to one or more of these
-    void readBinary(uint8_t* data, uint32_t size) throw(PersistException);
+    inline void readBinary(uint8_t* data, uint32_t size) throw(PersistException) {
+        if(size <= (size_t)(limit - input)) {
+            memcpy(data, input, size);
+            input += size;
+        }
+        else
+            readBuffer(data, size);
+    }
 
 private:
+    PersistEngine(const PersistEngine& copy);
+    PersistEngine& operator=(const PersistEngine& copy);
+
+    /**
+     * writes data that does not fit in what remains of the buffer.
+     */
+    void writeBuffer(const uint8_t* data, uint32_t size) throw(PersistException);
+
+    /**
+     * reads data that is not in memory, or past the end of it.
+     */
+    void readBuffer(uint8_t* data, uint32_t size) throw(PersistException);
+
+    /**
+     * writes an object marker.
+     */
+    void writeMarker(const char *marker) throw(PersistException);
+
+    /**
+     * reads and checks an object marker.
+     */
+    void readMarker(const char *marker, const char *reason) throw(PersistException);
+
     /**
      * reads the actual object data into a pre-instantiated object pointer
      * by calling the read function of the derived class.
@@ -277,15 +370,15 @@ private:
     void readObject(PersistObject* object) throw(PersistException);
 
     /**
-     * reads in a class name, and caches it into the ClassMap.
+     * reads in a class id, and caches the class name for it.
      */
-    const std::string readClass() throw(PersistException);
+    uint32_t readClass() throw(PersistException);
 
 
     /**
-     * The underlying stream
+     * The underlying stream, if any
      */
-    std::iostream& myUnderlyingStream;
+    std::iostream* myUnderlyingStream;
 
     /**
      * The mode of the engine. read or write
@@ -299,11 +392,35 @@ private:
     typedef std::map<PersistObject const*, int32_t> ArchiveMap;
     typedef std::vector<std::string>                ClassVector;
     typedef std::map<std::string, int32_t>            ClassMap;
+    typedef std::map<const char*, int32_t>            IdentityMap;
+    typedef std::vector<NewPersistObjectFunction>   FactoryVector;
 
     ArchiveVector myArchiveVector;
     ArchiveMap myArchiveMap;
     ClassVector myClassVector;
     ClassMap myClassMap;
+    IdentityMap myIdentityMap;
+    FactoryVector myFactoryVector;
+
+    /**
+     * The buffer being written, and how much of it may be filled before
+     * it is written to the stream or grown.
+     */
+    uint8_t *buffer;
+    size_t bufsize, bufpos, buflimit;
+
+    /**
+     * The archive being read from memory, and how it was loaded.
+     */
+    const uint8_t *input, *limit;
+    void *archive;
+    size_t archiveSize;
+    bool archiveMapped;
+
+    /**
+     * How deeply nested the object being written is.
+     */
+    unsigned depth;
 };
 
 #define CCXX_RE(ar,ob)   ar.read(ob); return ar
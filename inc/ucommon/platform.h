@@ -305,6 +305,11 @@ typedef int fd_t;
 #define INVALID_HANDLE_VALUE -1
 #include <signal.h>
 
+// futex based locking is selected when the library is built...
+#if defined(UCOMMON_FUTEX) && defined(__linux__) && defined(__GNUC__)
+#define _FUTEX_
+#endif
+
 #endif
 
 #ifdef _MSC_VER
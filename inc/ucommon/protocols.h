@@ -417,6 +417,23 @@ protected:
     inline size_t output_waiting(void) const
         {return outsize;}
 
+    /**
+     * Take pending output so a derived class may write it directly, such
+     * as along with other data in one gathered write.  The output buffer
+     * is emptied, so the data must be written before further output.
+     * @param size of pending output taken.
+     * @return pending output or NULL if none waiting.
+     */
+    const char *drain(size_t *size);
+
+    /**
+     * Put back the part of drained output that was not written.  This is
+     * used when a gathered write is short, before any further output.
+     * @param size of pending output that was drained.
+     * @param sent bytes of it that were written.
+     */
+    void restore(size_t size, size_t sent);
+
 public:
     const char *endl(void) const
         {return eol;}
@@ -0,0 +1,249 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * Event driven socket reactor.
+ * The reactor allows a small pool of threads to service a very large
+ * number of mostly idle socket connections.  Rather than having a thread
+ * block in Socket::wait for each connection, sockets are registered with
+ * the reactor through a handler object, and the handler's input, output,
+ * and expired methods are called from the reactor's thread pool when the
+ * socket becomes ready or has been idle too long.  On GNU/Linux an edge
+ * triggered epoll descriptor is used, and poll is used elsewhere.
+ * @file ucommon/reactor.h
+ */
+
+#ifndef _UCOMMON_REACTOR_H_
+#define _UCOMMON_REACTOR_H_
+
+#ifndef _UCOMMON_SOCKET_H_
+#include <ucommon/socket.h>
+#endif
+
+#ifndef _UCOMMON_THREAD_H_
+#include <ucommon/thread.h>
+#endif
+
+#ifndef _UCOMMON_ATOMIC_H_
+#include <ucommon/atomic.h>
+#endif
+
+namespace ucommon {
+
+/**
+ * A socket event reactor dispatched on a thread pool.  Each registered
+ * socket is represented by a handler object.  A handler is only ever
+ * dispatched from one reactor thread at a time, so derived handlers need
+ * no locking of their own for per-connection state.  When the epoll backend
+ * is used, sockets are edge triggered, and so a handler's input method
+ * should read until the socket would block.  Handlers are normally removed
+ * from the reactor from within their own callbacks by calling detach, or
+ * from other threads by cancelling the socket, which will result in the
+ * disconnect callback being dispatched.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+class __EXPORT Reactor
+{
+public:
+    /**
+     * Events a handler can be registered for.
+     */
+    enum {
+        INPUT = 0x01,
+        OUTPUT = 0x02
+    };
+
+private:
+    class worker;
+
+public:
+    /**
+     * A socket handler that lives in a reactor.  This is used as a base
+     * class for a connection object, and the derived class overrides the
+     * callbacks it is interested in.  Each handler is assigned to one pool
+     * thread when attached, and all of its callbacks are invoked from that
+     * thread.
+     * @author David Sugar <dyfet@gnutelephony.org>
+     */
+    class __EXPORT handler : public LinkedList
+    {
+    private:
+        friend class Reactor;
+        friend class worker;
+
+        worker *loop;
+        Timer::tick_t deadline;
+        unsigned mask;
+        bool detaching;
+
+    protected:
+        socket_t so;
+
+        /**
+         * Create a handler for an existing socket.  The socket is set
+         * non-blocking when the handler is attached.
+         * @param socket to handle.
+         */
+        handler(socket_t socket);
+
+        /**
+         * Called when the socket has input pending or a pending
+         * connection for a listener.
+         */
+        virtual void input(void);
+
+        /**
+         * Called when the socket may be written after output has been
+         * enabled with writing.
+         */
+        virtual void output(void);
+
+        /**
+         * Called when an armed idle timer expires.  The default
+         * behavior is to treat this as a disconnect.
+         */
+        virtual void expired(void);
+
+        /**
+         * Called when the socket has hung up or has an error pending.
+         * The default behavior is to detach the handler.
+         */
+        virtual void disconnect(void);
+
+        /**
+         * Called once the handler has been removed from the reactor and
+         * will no longer be dispatched.  A dynamically created handler
+         * will commonly delete itself here.
+         */
+        virtual void detached(void);
+
+    public:
+        /**
+         * Destroy handler.  The handler should be detached first.
+         */
+        virtual ~handler();
+
+        /**
+         * Arm (or re-arm) the idle timer of the handler.  The timer is
+         * checked at the resolution of the reactor.
+         * @param timeout in milliseconds from now.
+         */
+        void arm(timeout_t timeout);
+
+        /**
+         * Disarm the idle timer of the handler.
+         */
+        void disarm(void);
+
+        /**
+         * Enable or disable output readiness events.  This may be called
+         * from any thread.
+         * @param enable output events if true.
+         */
+        void writing(bool enable);
+
+        /**
+         * Remove handler from reactor.  This must only be called from the
+         * handler's own callbacks.  The detached method is called once
+         * the reactor thread has finished with the handler.
+         */
+        void detach(void);
+
+        /**
+         * Shutdown the socket from any thread.  This results in the
+         * disconnect method being dispatched.
+         */
+        void cancel(void);
+
+        /**
+         * Get socket of handler.
+         * @return socket descriptor.
+         */
+        inline socket_t handle(void) const
+            {return so;}
+
+        /**
+         * Test if handler is attached to a reactor.
+         * @return true if attached.
+         */
+        inline bool is_attached(void) const
+            {return loop != NULL;}
+    };
+
+private:
+    friend class handler;
+
+    worker **workers;
+    unsigned threads;
+    unsigned rotor;
+    timeout_t granularity;
+    atomic::counter attached;
+
+public:
+    /**
+     * Create a reactor.  The reactor threads are not started until start
+     * is called, although handlers may be attached before then.
+     * @param count of pool threads to dispatch handlers with.
+     * @param resolution of idle timers in milliseconds.
+     */
+    Reactor(unsigned count = 2, timeout_t resolution = 250);
+
+    /**
+     * Stop and destroy reactor.  Handlers still attached are detached.
+     */
+    virtual ~Reactor();
+
+    /**
+     * Start the reactor thread pool.
+     * @param priority of pool threads.
+     */
+    void start(int priority = 0);
+
+    /**
+     * Stop and join the reactor thread pool.  Handlers remain attached
+     * until the reactor is destroyed.
+     */
+    void stop(void);
+
+    /**
+     * Attach a handler to the reactor.  This may be called from any
+     * thread, including from the callbacks of another handler, such as
+     * when a listener accepts a new connection.
+     * @param handler to attach.
+     * @param events to select, normally INPUT.
+     * @return true if attached.
+     */
+    bool attach(handler *handler, unsigned events = INPUT);
+
+    /**
+     * Get number of handlers attached.
+     * @return handler count.
+     */
+    inline unsigned count(void)
+        {return (unsigned)(long)attached;}
+
+    /**
+     * Test if the reactor uses edge triggered kernel event notification.
+     * When true, input handlers must read until the socket would block.
+     * @return true if edge triggered.
+     */
+    static bool is_edge(void);
+};
+
+} // namespace ucommon
+
+#endif
@@ -247,6 +247,41 @@ public:
 
     bool _pending(void);
 
+    /**
+     * Send gathered slices through tls.  If the kernel sends our tls
+     * records (ktls) the slices are written to the socket as for TCPBuffer,
+     * otherwise they are encrypted through the buffer.
+     * @param vector of slices to send.
+     * @param count of slices in vector.
+     * @return number of bytes of slices sent, short if error.
+     */
+    size_t _sendv(const struct iovec *vector, unsigned count);
+
+    /**
+     * Send from a file through tls.  If the kernel sends our tls records
+     * the file is sent by the kernel, otherwise it is read and encrypted
+     * through the buffer.
+     * @param file to send from.
+     * @param size of data to send.
+     * @return number of bytes sent, short if error or end of file.
+     */
+    size_t _sendfile(fsys& file, size_t size);
+
+    /**
+     * Buffer by whole tls records.  The i/o buffer is resized to hold the
+     * largest tls record, so that output is sent as full records, and
+     * input is read a record at a time, with read ahead where supported.
+     * This is done after connecting, before any data is exchanged.
+     * @return true if the connection is secure.
+     */
+    bool records(void);
+
+    /**
+     * Test if our tls records are sent by the kernel (ktls).
+     * @return true if sends are offloaded.
+     */
+    bool is_offloaded(void) const;
+
     inline bool is_secure(void) const
         {return bio != NULL;}
 };
@@ -521,6 +556,20 @@ public:
      */
     static bool has(const char *name);
 
+    /**
+     * Put memory into several digests at once.  Each digest is given the
+     * memory and size at the same position, as if put were called for
+     * each.  Where the hash supports it, whole blocks of separate digests
+     * are hashed together in vector lanes.  Each digest should appear
+     * only once.
+     * @param digests to put memory into.
+     * @param memory to put into each digest.
+     * @param size of memory for each digest.
+     * @param count of digests.
+     * @return false if any digest was not active.
+     */
+    static bool batch(Digest **digests, const void **memory, const size_t *size, unsigned count);
+
     static void uuid(char *string, const char *name, const unsigned char *ns = NULL);
 
     static String uuid(const char *name, const unsigned char *ns = NULL);
@@ -763,6 +812,8 @@ public:
 
     ssize_t _write(const char *address, size_t size);
 
+    ssize_t _writev(const struct iovec *vector, unsigned count);
+
     ssize_t _read(char *address, size_t size);
 
     bool _wait(void);
@@ -770,6 +821,22 @@ public:
     inline void flush(void)
         {sync();}
 
+    /**
+     * Buffer by whole tls records.  The stream buffers are resized to
+     * hold the largest tls record, so that output is sent as full records,
+     * and input is read a record at a time, with read ahead where
+     * supported.  This is done after connecting, before any data is
+     * exchanged.
+     * @return true if the connection is secure.
+     */
+    bool records(void);
+
+    /**
+     * Test if our tls records are sent by the kernel (ktls).
+     * @return true if sends are offloaded.
+     */
+    bool is_offloaded(void) const;
+
     inline bool is_secure(void) const
         {return bio != NULL;}
 };
@@ -38,6 +38,10 @@
 #include <ucommon/string.h>
 #endif
 
+#ifndef _UCOMMON_ATOMIC_H_
+#include <ucommon/atomic.h>
+#endif
+
 extern "C" {
     struct addrinfo;
 }
@@ -48,9 +52,14 @@ extern "C" {
 #define SHUT_RD     SD_RECV
 typedef uint16_t in_port_t;
 typedef uint32_t in_addr_t;
+struct iovec {
+    void *iov_base;
+    size_t iov_len;
+};
 #else
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <netdb.h>
@@ -306,6 +315,85 @@ public:
         {return !is_member(address);}
 };
 
+/**
+ * A longest prefix match index of a cidr policy chain.  Finding the cidr
+ * that matches an address in a policy chain with cidr::find compares the
+ * address with every entry.  The index instead holds the chain in a path
+ * compressed binary trie for each address family, so a lookup only
+ * visits the prefixes of the address.  An index may be rebuilt from a
+ * changed policy chain while other threads are looking up addresses.
+ * Lookups already under way complete with the prior snapshot, which is
+ * released once they are done, and lookups take no locks.  The cidr
+ * objects of the chain are referenced, not copied, and must remain valid
+ * while they are indexed.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+class __EXPORT cidrmap
+{
+private:
+    class __LOCAL snapshot;
+
+    void *volatile current;
+    mutable atomic::epoch readers;
+    atomic::spinlock writer;
+
+public:
+    /**
+     * Create an empty index.
+     */
+    cidrmap();
+
+    /**
+     * Create an index of a policy chain.
+     * @param policy chain to index.
+     */
+    cidrmap(const cidr::policy *policy);
+
+    /**
+     * Destroy index.  There must be no lookups still in progress.
+     */
+    ~cidrmap();
+
+    /**
+     * Rebuild the index from a policy chain.  The new index replaces the
+     * old one at once for new lookups.  This waits for lookups still
+     * using the old index to complete before releasing it.
+     * @param policy chain to index, or NULL to clear.
+     */
+    void set(const cidr::policy *policy);
+
+    /**
+     * Remove all entries from the index.
+     */
+    inline void clear(void)
+        {set(NULL);}
+
+    /**
+     * Get the number of cidr entries indexed.
+     * @return count of entries.
+     */
+    unsigned count(void) const;
+
+    /**
+     * Find the smallest cidr entry that matches the socket address.  This
+     * finds the same entry as cidr::find on the indexed policy chain.
+     * @param address to search for.
+     * @return smallest cidr or NULL if none match.
+     */
+    const cidr *find(const struct sockaddr *address) const;
+
+    /**
+     * Get the largest container cidr entry that matches the socket
+     * address.  This finds the same entry as cidr::container on the
+     * indexed policy chain.
+     * @param address to search for.
+     * @return largest cidr or NULL if none match.
+     */
+    const cidr *container(const struct sockaddr *address) const;
+};
+
+class LineReader;
+
 /**
  * A generic socket base class.  This class can be used directly or as a
  * base class for building network protocol stacks.  This common base tries
@@ -319,6 +407,7 @@ protected:
     socket_t so;
     int ioerr;
     timeout_t iowait;
+    LineReader *reader;
 
 public:
     /**
@@ -912,8 +1001,7 @@ public:
      * Get the number of bytes of data in the socket receive buffer.
      * @return bytes pending.
      */
-    inline unsigned pending(void) const
-        {return pending(so);}
+    unsigned pending(void) const;
 
     /**
      * Set socket for unicast mode broadcasts.
@@ -1117,7 +1205,8 @@ public:
      * Read data from the socket receive buffer.  This will be used in abi 4.
      * @param data pointer to save data in.
      * @param number of bytes to read.
-     * @param address of peer data was received from.
+     * @param address of peer data was received from.  For data already
+     * read ahead by readline this is the connected peer.
      * @return number of bytes actually read, 0 if none, -1 if error.
      */
     size_t readfrom(void *data, size_t number, struct sockaddr_storage *address = NULL);
@@ -1133,12 +1222,14 @@ public:
 
     /**
      * Read a newline of text data from the socket and save in NULL terminated
-     * string.  This uses an optimized I/O method that takes advantage of
-     * socket peeking.  This presumes a connected socket on a streamble
-     * protocol.  Because the trailing newline is dropped, the return size
-     * may be greater than the string length.  If there was no data read
-     * because of eof of data, an error has occured, or timeout without
-     * input, then 0 will be returned.
+     * string.  Input is read ahead into a line buffer kept with the socket,
+     * so a line usually costs no more than one receive and several short
+     * lines may arrive from one receive.  Read ahead data is also returned
+     * by readfrom and peek, and counted by wait and pending.  This presumes
+     * a connected socket on a streamble protocol.  Because the trailing
+     * newline is dropped, the return size may be greater than the string
+     * length.  If there was no data read because of eof of data, an error
+     * has occured, or timeout without input, then 0 will be returned.
      * @param data to save input line.
      * @param size of input line buffer.
      * @return number of bytes read, 0 if none, err() has error.
@@ -1154,8 +1245,8 @@ public:
 
     /**
      * Read a string of input from the socket and strip trailing newline.
-     * This uses an optimized I/O method that takes advantage of
-     * socket peeking.  This presumes a connected socket on a streamble
+     * This reads through the same line buffer as readline into a
+     * string.  This presumes a connected socket on a streamble
      * protocol.  Because the trailing newline is dropped, the return size
      * may be greater than the string length.  If there was no data read
      * because of eof of data, an error has occured, or timeout without
@@ -1415,6 +1506,18 @@ public:
      */
     static ssize_t sendto(socket_t socket, const void *buffer, size_t size, int flags = 0, const struct sockaddr *address = NULL);
 
+    /**
+     * Send gathered data on a connected socket.  The slices are submitted
+     * together in one physical write where supported, without copying
+     * them into a single buffer first.
+     * @param socket to send to.
+     * @param vector of slices to send.
+     * @param count of slices in vector.
+     * @param flags for i/o operation (MSG_OOB, MSG_ZEROCOPY, etc).
+     * @return number of bytes sent, may be short, -1 if error.
+     */
+    static ssize_t sendv(socket_t socket, const struct iovec *vector, unsigned count, int flags = 0);
+
     /**
      * Send reply on socket.  Used to reply to a recvfrom message.
      * @param socket to send to.
@@ -1757,6 +1860,96 @@ public:
     static int remote(socket_t socket, struct sockaddr_storage *address);
 };
 
+/**
+ * A read ahead line buffer for a connected stream socket.  Input is
+ * received in large reads and lines are found with memchr, resuming the
+ * search where the last one stopped, so data is never scanned twice and
+ * most lines cost no system call at all.  Lines are returned as views into
+ * the buffer rather than copied, and remain valid until the next read.
+ * This is kept by a Socket for readline, and may be used directly by
+ * protocol servers parsing text headers.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+class __EXPORT LineReader
+{
+private:
+    char *buffer;
+    size_t bufsize, head, tail, scan;
+
+    __LOCAL ssize_t take(const char **line, size_t size);
+
+    // kill copy constructor
+    LineReader(const LineReader&);
+
+public:
+    /**
+     * Create a line buffer.
+     * @param size of buffer, which is the longest line returned whole.
+     */
+    LineReader(size_t size = 2048);
+
+    /**
+     * Release the line buffer.
+     */
+    ~LineReader();
+
+    /**
+     * Read a line from a socket.  The line includes its delimiter.  A line
+     * longer than the limit, or ended by eof, is returned without one.
+     * @param socket to read from.
+     * @param line set to the start of the line in the buffer.
+     * @param max length of line to return, or 0 for buffer size.
+     * @param timeout to wait for input, or 0 if none.
+     * @param delim which ends a line.
+     * @return length of line, 0 if eof or timeout, -1 if error.
+     */
+    ssize_t getline(socket_t socket, const char **line, size_t max = 0, timeout_t timeout = Timer::inf, char delim = '\n');
+
+    /**
+     * Read data, taking any that is already buffered first.
+     * @param socket to read from.
+     * @param data to save input in.
+     * @param size of data to read.
+     * @return bytes read, 0 if eof, -1 if error.
+     */
+    ssize_t read(socket_t socket, void *data, size_t size);
+
+    /**
+     * Copy buffered data without removing it.
+     * @param data to save copy in.
+     * @param size of data to copy.
+     * @return bytes copied.
+     */
+    size_t peek(void *data, size_t size) const;
+
+    /**
+     * Grow the buffer to hold at least a given size, keeping any
+     * buffered data.
+     * @param size of buffer needed.
+     */
+    void reserve(size_t size);
+
+    /**
+     * Discard any buffered data.
+     */
+    inline void clear(void)
+        {head = tail = scan = 0;}
+
+    /**
+     * Number of bytes read ahead and not yet returned.
+     * @return bytes buffered.
+     */
+    inline size_t pending(void) const
+        {return tail - head;}
+
+    /**
+     * Size of the buffer.
+     * @return buffer size.
+     */
+    inline size_t size(void) const
+        {return bufsize;}
+};
+
 /**
  * A bound socket used to listen for inbound socket connections.  This class
  * is commonly used for TCP and DCCP listener sockets.
@@ -1847,6 +2040,141 @@ public:
     TCPServer(const char *address, const char *service, unsigned backlog = 5);
 };
 
+/**
+ * A batch of datagrams moved with a single system call.  Message buffers,
+ * lengths, and peer addresses are preallocated in one arena when the
+ * batch is created, so receiving and sending involve no allocation.  A
+ * received batch may be sent back out as is, which makes relays and
+ * reflectors simple.  Where recvmmsg and sendmmsg are not available, the
+ * batch is moved one datagram at a time.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+class __EXPORT DatagramBatch
+{
+private:
+    caddr_t arena;
+    void *headers;
+    char *buffers;
+    struct sockaddr_storage *peers;
+    size_t *sizes;
+    size_t bufsize;
+    unsigned limit, used;
+
+    __LOCAL void remove(unsigned count);
+
+    // kill copy constructor
+    DatagramBatch(const DatagramBatch&);
+
+public:
+    /**
+     * Create a batch.
+     * @param count of datagrams held.
+     * @param size of largest datagram.
+     */
+    DatagramBatch(unsigned count, size_t size = 1500);
+
+    /**
+     * Release the batch arena.
+     */
+    ~DatagramBatch();
+
+    /**
+     * Receive datagrams into the batch, replacing its contents.  This
+     * waits for the first datagram unless flags has MSG_DONTWAIT, and
+     * then takes whatever else is already queued.
+     * @param socket to receive from.
+     * @param flags for receive.
+     * @return number of datagrams received, 0 if none or error.
+     */
+    unsigned receive(socket_t socket, int flags = 0);
+
+    /**
+     * Send the datagrams in the batch.  Those sent are removed from the
+     * batch, and any the socket could not take remain for a later send.
+     * @param socket to send on.
+     * @param flags for send.
+     * @param address to use for datagrams without a peer, or NULL.
+     * @return number of datagrams sent.
+     */
+    unsigned send(socket_t socket, int flags = 0, const struct sockaddr *address = NULL);
+
+    /**
+     * Add a datagram to send.
+     * @param data of datagram.
+     * @param size of datagram.
+     * @param address of peer, or NULL to send to the connected peer.
+     * @return false if batch is full or datagram too large.
+     */
+    bool put(const void *data, size_t size, const struct sockaddr *address = NULL);
+
+    /**
+     * Set the peer address of a datagram.
+     * @param index of datagram.
+     * @param address of peer, or NULL for none.
+     */
+    void set(unsigned index, const struct sockaddr *address);
+
+    /**
+     * Set the length of a datagram, such as after rewriting it in place.
+     * @param index of datagram.
+     * @param size of datagram.
+     */
+    void resize(unsigned index, size_t size);
+
+    /**
+     * Get the contents of a datagram.
+     * @param index of datagram.
+     * @return datagram buffer.
+     */
+    inline char *data(unsigned index) const
+        {return buffers + (index * bufsize);}
+
+    /**
+     * Get the length of a datagram.
+     * @param index of datagram.
+     * @return datagram length.
+     */
+    inline size_t size(unsigned index) const
+        {return sizes[index];}
+
+    /**
+     * Get the peer address of a datagram.
+     * @param index of datagram.
+     * @return address received from or to send to, NULL if none.
+     */
+    const struct sockaddr *peer(unsigned index) const;
+
+    /**
+     * Number of datagrams in the batch.
+     * @return datagram count.
+     */
+    inline unsigned count(void) const
+        {return used;}
+
+    /**
+     * Number of datagrams the batch can hold.
+     * @return datagram limit.
+     */
+    inline unsigned max(void) const
+        {return limit;}
+
+    /**
+     * Size of the largest datagram the batch holds.
+     * @return buffer size of each datagram.
+     */
+    inline size_t buffer(void) const
+        {return bufsize;}
+
+    /**
+     * Empty the batch.
+     */
+    inline void clear(void)
+        {used = 0;}
+
+    inline bool is_full(void) const
+        {return used >= limit;}
+};
+
 /**
  * Helper function for linked_pointer<struct sockaddr>.
  */
@@ -120,6 +120,15 @@ protected:
 
     virtual ssize_t _write(const char *buffer, size_t size);
 
+    /**
+     * Gather write of several buffers through the connection.  The
+     * default sends them as one message; secure streams override this.
+     * @param vector of buffers to write.
+     * @param count of buffers in vector.
+     * @return bytes written or -1 on error.
+     */
+    virtual ssize_t _writev(const struct iovec *vector, unsigned count);
+
     virtual bool _wait(void);
 
     /**
@@ -143,6 +152,16 @@ protected:
      */
     int overflow(int ch);
 
+    /**
+     * This streambuf method writes a block of data.  Blocks that do
+     * not fit in the output buffer are sent together with any pending
+     * output in a single gather write rather than copied through it.
+     * @param data to write.
+     * @param size of data.
+     * @return number of bytes written.
+     */
+    std::streamsize xsputn(const char *data, std::streamsize size);
+
     inline socket_t getsocket(void) const
         {return so;}
 
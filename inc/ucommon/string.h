@@ -220,6 +220,22 @@ public:
 protected:
     cstring *str;  /**< cstring instance our object references. */
 
+private:
+    enum {SMALL = 24};  /**< Longest text held in the string object */
+
+    union {
+        void *align;
+        char data[sizeof(cstring) + SMALL];
+    } local;        /**< Storage for a short cstring of our own */
+
+    inline bool is_small(void) const
+        {return str == (const cstring *)(local.data);}
+
+    cstring *clone(const cstring *from);
+
+    void take(String& from);
+
+protected:
     /**
      * Factory create a cstring object of specified size.
      * @param size of allocated space for string buffer.
@@ -228,6 +244,16 @@ protected:
      */
     cstring *create(strsize_t size, char fill = 0) const;
 
+    /**
+     * Create a cstring object of specified size for our own use.  A short
+     * string is held in storage within the string object itself rather
+     * than allocated from the heap, and is copied rather than shared.
+     * @param size of allocated space for string buffer.
+     * @param fill character to use or 0 if null.
+     * @return new cstring object.
+     */
+    cstring *make(strsize_t size, char fill = 0);
+
 public:
     /**
      * Compare the values of two string.  This is a virtual so that it
@@ -357,6 +383,16 @@ public:
      */
     String(const String& existing);
 
+#if __cplusplus >= 201103L
+    /**
+     * Construct a string by moving from another string object.  We take
+     * over the reference of the original, which is left empty.
+     * @param existing string to move from.
+     */
+    inline String(String&& existing)
+        {str = NULL; take(existing);}
+#endif
+
     /**
      * Destroy string.  De-reference cstring.  If last reference to cstring,
      * then also remove cstring from heap.
@@ -836,6 +872,16 @@ public:
      */
     String& operator=(const String& object);
 
+#if __cplusplus >= 201103L
+    /**
+     * Assign our string by moving the cstring of another object.  The
+     * other object is left empty.
+     * @param object to move from.
+     */
+    inline String& operator=(String&& object)
+        {if(this != &object) {release(); take(object);} return *this;}
+#endif
+
     bool operator*=(const char *substring);
 
     bool operator*=(regex& expr);
@@ -1092,16 +1138,18 @@ public:
      * Find position of case insensitive substring within a string.
      * @param text to search in.
      * @param key string to locate.
-     * @param optional separator chars if formatted as list of keys.
+     * @param optional separator chars if formatted as list of keys, or
+     * NULL to match anywhere.
      * @return substring position if found, or NULL.
      */
-    static const char *ifind(const char *text, const char *key, const char *optional);
+    static const char *ifind(const char *text, const char *key, const char *optional = NULL);
 
     /**
      * Find position of substring within a string.
      * @param text to search in.
      * @param key string to locate.
-     * @param optional separator chars if formatted as list of keys.
+     * @param optional separator chars if formatted as list of keys, or
+     * NULL to match anywhere.
      * @return substring position if found, or NULL.
      */
     static const char *find(const char *text, const char *key, const char *optional);
@@ -1184,6 +1232,14 @@ public:
      */
     static bool eq_case(const char *text1, const char *text2, size_t size);
 
+    /**
+     * Hash a string without case, so that strings that are equal without
+     * case hash the same.
+     * @param text to hash.
+     * @return hash value.
+     */
+    static unsigned hash_case(const char *text);
+
     /**
      * Return start of string after characters to trim from beginning.
      * This function does not modify memory.
@@ -73,6 +73,73 @@ namespace ucommon {
 
 class SharedPointer;
 
+#ifdef  _FUTEX_
+/**
+ * Linux futex primitives used to build the locking classes when the library
+ * is configured for futex locking.  Locks are a single word that is taken
+ * and released with atomic operations, and only enter the kernel when a
+ * thread actually has to park after a short adaptive spin.  Events are a
+ * sequence word with a waiter count so that signalling a conditional nobody
+ * is waiting on never makes a system call.
+ * @author David Sugar <dyfet@gnutelephony.org>
+ */
+class __EXPORT futex
+{
+public:
+    typedef volatile int lock_t;
+
+    typedef struct {
+        volatile int sequence;
+        volatile int waiters;
+    } event_t;
+
+private:
+    static void contended(lock_t *lock);
+    static void wakeup(lock_t *lock);
+    static void wake(event_t *event, lock_t *lock, bool all);
+
+public:
+    /**
+     * Acquire a futex lock, spinning and then parking if contended.
+     * @param lock word to acquire.
+     */
+    inline static void lock(lock_t *lock)
+        {if(!__sync_bool_compare_and_swap(lock, 0, 1)) contended(lock);}
+
+    /**
+     * Release a futex lock, waking a parked thread if contended.
+     * @param lock word to release.
+     */
+    inline static void unlock(lock_t *lock)
+        {if(__sync_fetch_and_sub(lock, 1) != 1) wakeup(lock);}
+
+    /**
+     * Wait on an event, releasing the lock while parked.
+     * @param event to wait on.
+     * @param lock held by the caller.
+     * @param timeout as absolute time from Conditional::set, or NULL.
+     * @return true if signalled, false if timer expired.
+     */
+    static bool wait(event_t *event, lock_t *lock, const struct timespec *timeout = NULL);
+
+    /**
+     * Signal one thread waiting on an event.
+     * @param event to signal.
+     */
+    inline static void signal(event_t *event)
+        {__sync_fetch_and_add(&event->sequence, 1); if(event->waiters) wake(event, NULL, false);}
+
+    /**
+     * Signal all threads waiting on an event.  Waiters are requeued onto
+     * the lock rather than all woken at once.
+     * @param event to signal.
+     * @param lock waiters will re-acquire.
+     */
+    inline static void broadcast(event_t *event, lock_t *lock)
+        {__sync_fetch_and_add(&event->sequence, 1); if(event->waiters) wake(event, lock, true);}
+};
+#endif
+
 /**
  * The conditional is a common base for other thread synchronizing classes.
  * Many of the complex sychronization objects, including barriers, semaphores,
@@ -109,9 +176,14 @@ private:
     __LOCAL static attribute attr;
 #endif
 
+#ifdef  _FUTEX_
+    mutable futex::event_t cond;
+    mutable futex::lock_t mutex;
+#else
     mutable pthread_cond_t cond;
     mutable pthread_mutex_t mutex;
 #endif
+#endif
 
 protected:
     friend class TimedEvent;
@@ -141,6 +213,22 @@ protected:
     void signal(void);
     void broadcast(void);
 
+#elif defined(_FUTEX_)
+    inline void lock(void)
+        {futex::lock(&mutex);}
+
+    inline void unlock(void)
+        {futex::unlock(&mutex);}
+
+    inline void wait(void)
+        {futex::wait(&cond, &mutex);}
+
+    inline void signal(void)
+        {futex::signal(&cond);}
+
+    inline void broadcast(void)
+        {futex::broadcast(&cond, &mutex);}
+
 #else
     /**
      * Lock the conditional's supporting mutex.
@@ -189,8 +277,10 @@ public:
     class __EXPORT autolock
     {
     private:
-#ifdef  _MSTHREADS_
+#if defined(_MSTHREADS_)
         CRITICAL_SECTION *mutex;
+#elif defined(_FUTEX_)
+        futex::lock_t *mutex;
 #else
         pthread_mutex_t *mutex;
 #endif
@@ -198,16 +288,20 @@ public:
     public:
         inline autolock(const Conditional* object) {
             mutex = &object->mutex;
-#ifdef _MSTHREADS_
+#if defined(_MSTHREADS_)
             EnterCriticalSection(mutex);
+#elif defined(_FUTEX_)
+            futex::lock(mutex);
 #else
             pthread_mutex_lock(mutex);
 #endif
         }
 
         inline ~autolock() {
-#ifdef  _MSTHREADS_
+#if defined(_MSTHREADS_)
             LeaveCriticalSection(mutex);
+#elif defined(_FUTEX_)
+            futex::unlock(mutex);
 #else
             pthread_mutex_unlock(mutex);
 #endif
@@ -245,6 +339,8 @@ class __EXPORT ConditionalAccess : private Conditional
 protected:
 #if defined _MSCONDITIONAL_
     CONDITION_VARIABLE bcast;
+#elif defined(_FUTEX_)
+    mutable futex::event_t bcast;
 #elif !defined(_MSTHREADS_)
     mutable pthread_cond_t bcast;
 #endif
@@ -306,6 +402,25 @@ protected:
     inline void broadcast(void)
         {Conditional::broadcast();};
 
+#elif defined(_FUTEX_)
+    inline void lock(void)
+        {futex::lock(&mutex);}
+
+    inline void unlock(void)
+        {futex::unlock(&mutex);}
+
+    inline void waitSignal(void)
+        {futex::wait(&cond, &mutex);}
+
+    inline void waitBroadcast(void)
+        {futex::wait(&bcast, &mutex);}
+
+    inline void signal(void)
+        {futex::signal(&cond);}
+
+    inline void broadcast(void)
+        {futex::broadcast(&bcast, &mutex);}
+
 #else
     /**
      * Lock the conditional's supporting mutex.
@@ -944,20 +1059,24 @@ public:
 /**
  * Generic non-recursive exclusive lock class.  This class also impliments
  * the exclusive_lock protocol.  In addition, an interface is offered to
- * support dynamically managed mutexes which are internally pooled.  These
- * can be used to protect and serialize arbitrary access to memory and
- * objects on demand.  This offers an advantage over embedding mutexes to
- * serialize access to individual objects since the maximum number of
- * mutexes will never be greater than the number of actually running threads
- * rather than the number of objects being potentially protected.  The
- * ability to hash the pointer address into an indexed table further optimizes
- * access by reducing the chance for collisions on the primary index mutex.
+ * protect and serialize arbitrary access to memory and objects on demand
+ * from a fixed table of striped locks.  The pointer address is hashed to
+ * pick a stripe, so no mutex is embedded in or allocated for the objects
+ * being protected.  Stripes are padded to their own cache lines.  A stripe
+ * still locks each object separately, so objects that share a stripe never
+ * block or release each other, and an object may be protected again by the
+ * thread that holds it.  Each stripe has a fixed pool of objects that may be
+ * held or waited on at once, and further objects wait for one to be free.
  * @author David Sugar <dyfet@gnutelephony.org>
  */
 class __EXPORT Mutex : public ExclusiveAccess
 {
 protected:
+#ifdef  _FUTEX_
+    mutable futex::lock_t mlock;
+#else
     mutable pthread_mutex_t mlock;
+#endif
 
     virtual void _lock(void);
     virtual void _unlock(void);
@@ -968,6 +1087,19 @@ public:
     class __EXPORT autolock
     {
     private:
+#ifdef  _FUTEX_
+        futex::lock_t *mutex;
+
+    public:
+        inline autolock(const Mutex *object) {
+            mutex = &object->mlock;
+            futex::lock(this->mutex);
+        }
+
+        inline ~autolock() {
+            futex::unlock(this->mutex);
+        }
+#else
         pthread_mutex_t *mutex;
 
     public:
@@ -979,6 +1111,7 @@ public:
         inline ~autolock() {
             pthread_mutex_unlock(this->mutex);
         }
+#endif
     };
 
     /**
@@ -1043,6 +1176,19 @@ public:
      */
     ~Mutex();
 
+#ifdef  _FUTEX_
+    inline void acquire(void)
+        {futex::lock(&mlock);}
+
+    inline void lock(void)
+        {futex::lock(&mlock);}
+
+    inline void unlock(void)
+        {futex::unlock(&mlock);}
+
+    inline void release(void)
+        {futex::unlock(&mlock);}
+#else
     /**
      * Acquire mutex lock.  This is a blocking operation.
      */
@@ -1066,6 +1212,7 @@ public:
      */
     inline void release(void)
         {pthread_mutex_unlock(&mlock);}
+#endif
 
     /**
      * Convenience function to acquire os native mutex lock directly.
@@ -1082,16 +1229,17 @@ public:
         {pthread_mutex_unlock(lock);}
 
     /**
-     * Specify hash table size for guard protection.  The default is 1.
+     * Specify number of stripes for guard protection.  The default is 64.
      * This should be called at initialization time from the main thread
      * of the application before any other threads are created.
-     * @param size of hash table used for guarding.
+     * @param size of stripe table used for guarding.
      */
     static void indexing(unsigned size);
 
     /**
-     * Specify pointer/object/resource to guard protect.  This uses a
-     * dynamically managed mutex.
+     * Specify pointer/object/resource to guard protect.  This waits until
+     * no other thread holds the pointer.  The thread holding it may protect
+     * it again, and must release it as many times.
      * @param pointer to protect.
      */
     static bool protect(const void *pointer);
@@ -1099,8 +1247,18 @@ public:
     /**
      * Specify a pointer/object/resource to release.
      * @param pointer to release.
+     * @return false if the pointer was not protected by this thread.
      */
     static bool release(const void *pointer);
+
+    /**
+     * Get lock statistics for guard protection.  When a high proportion of
+     * protect calls are contended, the table may be enlarged with indexing.
+     * @param acquired count of protect calls.
+     * @param contended count of protect calls that had to wait.
+     * @return number of stripes in the table.
+     */
+    static unsigned contention(unsigned long *acquired, unsigned long *contended);
 };
 
 /**
@@ -1245,13 +1403,16 @@ public:
  * singleton object through this pointer, and it can only be replaced with a
  * new singleton instance when no threads reference it.  The conditional lock
  * is used to manage shared access for use and exclusive access when modified.
+ * A pointer may instead be read copy updated, where readers take no locks
+ * and a replaced instance is deleted once all readers have passed it by.
  * @author David Sugar <dyfet@gnutelephony.org>
  */
 class __EXPORT SharedPointer : protected ConditionalAccess
 {
 private:
     friend class shared_release;
-    SharedObject *pointer;
+    SharedObject *volatile pointer;
+    bool lockfree;
 
 protected:
     /**
@@ -1259,6 +1420,20 @@ protected:
      */
     SharedPointer();
 
+    /**
+     * Create shared pointer that may be read without locking.  Readers
+     * only mark their own per thread epoch, and so never block or write
+     * memory shared with other readers.  Replace publishes the new object
+     * at once, and waits for readers that may still hold the prior object
+     * before deleting it.  The epoch is shared by all lockfree pointers,
+     * so if the replacing thread still holds a share of any of them, the
+     * prior object is instead retired, and deleted once the readers that
+     * may hold it have released.  Where not supported, shared locking is
+     * used.
+     * @param lockfree to read copy update rather than lock.
+     */
+    SharedPointer(bool lockfree);
+
     /**
      * Destroy lock and release any blocked threads.
      */
@@ -1267,11 +1442,20 @@ protected:
     /**
      * Replace existing singleton instance with new one.  This happens
      * during exclusive locking, and the commit method of the object
-     * will be called.
+     * will be called.  A lockfree pointer replaced by a thread that still
+     * holds a share retires the prior object rather than waiting for it.
      * @param object being set.
      */
     void replace(SharedObject *object);
 
+    /**
+     * Replace existing singleton instance while exclusive access is
+     * already held through modify.  This lets a derived class change its
+     * own state under the same lock that publishes the object.
+     * @param object being set.
+     */
+    void update(SharedObject *object);
+
     /**
      * Acquire a shared reference to the singleton object.  This is a
      * form of shared access lock.  Derived classes and templates access
@@ -1279,6 +1463,19 @@ protected:
      * @return shared object.
      */
     SharedObject *share(void);
+
+    /**
+     * Release a shared reference acquired with share.
+     */
+    void release(void);
+
+public:
+    /**
+     * Test if the pointer is read without locking.
+     * @return true if read copy updated.
+     */
+    inline bool is_lockfree(void) const
+        {return lockfree;}
 };
 
 /**
@@ -1592,6 +1789,7 @@ class __EXPORT shared_release
 {
 protected:
     SharedPointer *ptr; /**< Shared lock for protected singleton */
+    SharedObject *object; /**< Singleton instance we hold access to */
 
     /**
      * Create an unassigned shared singleton object pointer base.
@@ -1654,6 +1852,12 @@ public:
      */
     inline shared_pointer() : SharedPointer() {}
 
+    /**
+     * Created typed singleton pointer that may be read without locking.
+     * @param lockfree to read copy update rather than lock.
+     */
+    inline shared_pointer(bool lockfree) : SharedPointer(lockfree) {}
+
     /**
      * Acquire a shared (duplocate) reference to the typed singleton object.
      * This is a form of shared access lock.  Derived classes and templates
@@ -1802,21 +2006,21 @@ public:
      * Access shared typed singleton object this instance locks and references.
      */
     inline const T& operator*() const
-        {return *(static_cast<const T&>(ptr->pointer));}
+        {return *(static_cast<const T*>(object));}
 
     /**
      * Access member of shared typed singleton object this instance locks and
      * references.
      */
     inline const T* operator->() const
-        {return static_cast<const T*>(ptr->pointer);}
+        {return static_cast<const T*>(object);}
 
     /**
      * Access pointer to typed singleton object this instance locks and
      * references.
      */
     inline const T* get(void) const
-        {return static_cast<const T*>(ptr->pointer);}
+        {return static_cast<const T*>(object);}
 };
 
 /**
@@ -52,6 +52,7 @@ private:
     friend class Conditional;
     friend class Semaphore;
     friend class Event;
+    friend class TimerQueue;
 
 #if _POSIX_TIMERS > 0 && defined(POSIX_TIMERS)
     timespec timer;
@@ -264,7 +265,10 @@ public:
  * on events that have expired.  The timer queue also determines the
  * wait time until the next timer will expire.  When timer events are
  * modified, they can retrigger the queue to re-examine the list to
- * find when the next timer will now expire.
+ * find when the next timer will now expire.  Armed events are also kept
+ * in a hierarchical timing wheel of millisecond slots, so arming and
+ * disarming are constant time, and expire only examines events whose
+ * slot has come due rather than every event in the queue.
  * @author David Sugar <dyfet@gnutelephony.org>
  */
 class __EXPORT TimerQueue : public OrderedIndex
@@ -280,6 +284,18 @@ public:
      */
     class __EXPORT event : protected Timer, public LinkedList
     {
+    private:
+        class __LOCAL slot : public LinkedList
+        {
+        public:
+            event *owner;
+
+            inline OrderedIndex *index(void) const
+                {return Root;}
+        };
+
+        slot timing;
+
     protected:
         friend class TimerQueue;
 
@@ -304,6 +320,10 @@ public:
         /**
          * Expected next timeout for the timer.  This may be overriden
          * for strategy purposes when evaluted by timer queue's expire.
+         * This is called when the event's wheel slot comes due, and the
+         * event is re-slotted from its timer just before.  The default
+         * calls expired, and re-slots the event again if it was re-armed.
+         * A non-zero result also bounds the timeout expire returns.
          * @return milliseconds until timer next triggers.
          */
         virtual timeout_t timeout(void);
@@ -357,6 +377,16 @@ public:
             {return static_cast<TimerQueue*>(Root);}
     };
 
+private:
+    OrderedIndex *wheel;
+    Timer::tick_t current;
+    unsigned pending[4];
+
+    void schedule(event *timer);
+    void remove(event *timer);
+    void cascade(unsigned level);
+    timeout_t next(Timer::tick_t now);
+
 protected:
     friend class event;
 
@@ -380,7 +410,7 @@ public:
     TimerQueue();
 
     /**
-     * Destroy queue, does not remove event objects.
+     * Destroy queue, does not delete event objects, but detaches them.
      */
     virtual ~TimerQueue();
 
@@ -42,6 +42,11 @@ namespace ucommon {
  * parse xml content in memory buffers easily.  This parser is only concerned
  * with well-formedness, and does not perform validation.
  *
+ * Data is scanned a chunk at a time rather than a character at a time.
+ * Character text, comments, and cdata are passed to the virtuals directly
+ * from the data being parsed, and so may arrive in several pieces, while
+ * element names and attributes are collected in the parser buffer.
+ *
  * @author David Sugar <dyfet@gnutelephony.org>
  */
 class __EXPORT XMLParser
@@ -51,9 +56,13 @@ private:
     enum {TAG, CDATA, COMMENT, DTD, AMP, NONE, END} state;
     char *buffer;
     unsigned bufpos, bufsize;
+    char quote;
     __LOCAL bool parseTag(void);
-    __LOCAL void putBuffer(char c);
-    __LOCAL void clearBuffer(void);
+    __LOCAL bool parseEntity(char c);
+    __LOCAL bool parseDeclaration(char c);
+    __LOCAL const char *parseSection(const char *data, const char *end);
+    __LOCAL const char *parseChunk(const char *data, const char *end);
+    __LOCAL void section(caddr_t text, size_t size);
 
 protected:
     /**
@@ -69,6 +78,8 @@ protected:
 
     /**
      * Virtual to receive embedded comments in XML document being parsed.
+     * The text may point into data passed to partial, and must then not
+     * be modified.
      * @param text received.
      * @param size of text received.
      */
@@ -76,6 +87,8 @@ protected:
 
     /**
      * Virtual to receive character text extracted from the document.
+     * The text may point into data passed to partial, and must then not
+     * be modified.
      * @param text received.
      * @param size of text received.
      */
@@ -137,6 +150,15 @@ protected:
      */
     bool parse(FILE *file);
 
+    /**
+     * Parse a file by name and return parser document completion flag.
+     * Where supported the file is mapped into memory and parsed in place.
+     * Only the first XML document instance in the file is scanned.
+     * @param path of file to parse.
+     * @return true if parse complete, false if invalid or incomplete.
+     */
+    bool parse(const char *path);
+
     /**
      * End of document check.
      * @return true if end of document.
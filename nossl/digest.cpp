@@ -16,9 +16,72 @@
 // along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "local.h"
+#include "lanes.h"
 
 namespace ucommon {
 
+// streams are batched this many at a time
+#define BATCH_SLICE (DIGEST_LANES * 4)
+
+// keeps every lane busy with whole blocks of a different stream, and when
+// a stream runs out of blocks its lane goes to the next stream waiting...
+template <typename CTX>
+static void lanes(CTX **ctx, const uint8_t **data, size_t *blocks, unsigned count,
+    void (*run)(CTX **, const uint8_t **, size_t, unsigned),
+    void (*update)(CTX *, const uint8_t *, size_t))
+{
+    CTX *lane_ctx[DIGEST_LANES];
+    const uint8_t *lane_data[DIGEST_LANES];
+    size_t lane_blocks[DIGEST_LANES];
+    unsigned width = DigestLanes(), active = 0, next = 0, pos;
+    size_t step;
+
+    if(width < 2) {
+        for(pos = 0; pos < count; ++pos)
+            update(ctx[pos], data[pos], blocks[pos] * 64);
+        return;
+    }
+
+    for(;;) {
+        while(active < width && next < count) {
+            if(blocks[next]) {
+                lane_ctx[active] = ctx[next];
+                lane_data[active] = data[next];
+                lane_blocks[active++] = blocks[next];
+            }
+            ++next;
+        }
+
+        if(active < 2)
+            break;
+
+        step = lane_blocks[0];
+        for(pos = 1; pos < active; ++pos) {
+            if(lane_blocks[pos] < step)
+                step = lane_blocks[pos];
+        }
+
+        run(lane_ctx, lane_data, step, active);
+
+        pos = 0;
+        while(pos < active) {
+            lane_blocks[pos] -= step;
+            if(lane_blocks[pos]) {
+                ++pos;
+                continue;
+            }
+            --active;
+            lane_ctx[pos] = lane_ctx[active];
+            lane_data[pos] = lane_data[active];
+            lane_blocks[pos] = lane_blocks[active];
+        }
+    }
+
+    // a stream left alone is faster hashed by itself
+    if(active)
+        update(lane_ctx[0], lane_data[0], lane_blocks[0] * 64);
+}
+
 bool Digest::has(const char *id)
 {
     if(eq_case(id, "md5"))
@@ -85,6 +148,102 @@ bool Digest::put(const void *address, size_t size)
     }
 }
 
+bool Digest::batch(Digest **digests, const void **memory, const size_t *size, unsigned count)
+{
+    MD5_CTX *md5[BATCH_SLICE];
+    SHA1_CTX *sha1[BATCH_SLICE];
+    const uint8_t *md5_data[BATCH_SLICE], *sha1_data[BATCH_SLICE];
+    size_t md5_blocks[BATCH_SLICE], sha1_blocks[BATCH_SLICE];
+    unsigned md5_count, sha1_count, slice, pos, have;
+    const uint8_t *data;
+    size_t len, fill;
+    bool result = true;
+    Digest *digest;
+
+    while(count) {
+        slice = count < BATCH_SLICE ? count : BATCH_SLICE;
+        md5_count = sha1_count = 0;
+
+        // finish any block held from an earlier put before the lanes
+        for(pos = 0; pos < slice; ++pos) {
+            digest = digests[pos];
+            data = (const uint8_t *)memory[pos];
+            len = size[pos];
+
+            if(!digest->context || !digest->hashtype) {
+                result = false;
+                continue;
+            }
+
+            switch(*((char *)digest->hashtype)) {
+            case 'm':
+                have = (unsigned)((((MD5_CTX *)digest->context)->count >> 3) & 63);
+                if(have) {
+                    fill = len < 64u - have ? len : 64u - have;
+                    MD5Update((MD5_CTX *)digest->context, data, fill);
+                    data += fill;
+                    len -= fill;
+                }
+                md5[md5_count] = (MD5_CTX *)digest->context;
+                md5_data[md5_count] = data;
+                md5_blocks[md5_count++] = len / 64;
+                break;
+            case 's':
+                have = (unsigned)((((SHA1_CTX *)digest->context)->count >> 3) & 63);
+                if(have) {
+                    fill = len < 64u - have ? len : 64u - have;
+                    SHA1Update((SHA1_CTX *)digest->context, data, fill);
+                    data += fill;
+                    len -= fill;
+                }
+                sha1[sha1_count] = (SHA1_CTX *)digest->context;
+                sha1_data[sha1_count] = data;
+                sha1_blocks[sha1_count++] = len / 64;
+                break;
+            default:
+                result = false;
+                break;
+            }
+        }
+
+        lanes<MD5_CTX>(md5, md5_data, md5_blocks, md5_count, &MD5Lanes, &MD5Update);
+        lanes<SHA1_CTX>(sha1, sha1_data, sha1_blocks, sha1_count, &SHA1Lanes, &SHA1Update);
+
+        // and then buffer what is left past the last whole block
+        md5_count = sha1_count = 0;
+        for(pos = 0; pos < slice; ++pos) {
+            digest = digests[pos];
+            if(!digest->context || !digest->hashtype)
+                continue;
+
+            switch(*((char *)digest->hashtype)) {
+            case 'm':
+                data = md5_data[md5_count] + md5_blocks[md5_count] * 64;
+                len = (size_t)((const uint8_t *)memory[pos] + size[pos] - data);
+                ++md5_count;
+                if(len)
+                    MD5Update((MD5_CTX *)digest->context, data, len);
+                break;
+            case 's':
+                data = sha1_data[sha1_count] + sha1_blocks[sha1_count] * 64;
+                len = (size_t)((const uint8_t *)memory[pos] + size[pos] - data);
+                ++sha1_count;
+                if(len)
+                    SHA1Update((SHA1_CTX *)digest->context, data, len);
+                break;
+            default:
+                break;
+            }
+        }
+
+        digests += slice;
+        memory += slice;
+        size += slice;
+        count -= slice;
+    }
+    return result;
+}
+
 void Digest::reset(void)
 {
     if(hashtype) {
@@ -0,0 +1,554 @@
+// Copyright (C) 2010-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <ucommon/string.h>
+#include "lanes.h"
+
+// the lane transforms are written once for gcc vector types, and built
+// for each vector width.  The avx2 width is built for that target alone,
+// and chosen at runtime...
+#if defined(__GNUC__)
+#define LANES_VECTOR
+typedef uint32_t lane4_t __attribute__((vector_size(16)));
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define LANES_X86
+typedef uint32_t lane8_t __attribute__((vector_size(32)));
+#endif
+
+#ifdef  LANES_VECTOR
+
+#define F1(x, y, z) (z ^ (x & (y ^ z)))
+#define F2(x, y, z) F1(z, x, y)
+#define F3(x, y, z) (x ^ y ^ z)
+#define F4(x, y, z) (y ^ (x | ~z))
+
+#define MD5STEP(f, w, x, y, z, data, s) \
+    ( w += f(x, y, z) + data,  w = w<<s | w>>(32-s),  w += x )
+
+#define rol(value, bits) (((value) << (bits)) | ((value) >> (32 - (bits))))
+
+#define blk(i) (in[i&15] = rol(in[(i+13)&15]^in[(i+8)&15] \
+    ^in[(i+2)&15]^in[i&15],1))
+
+#define L0(v,w,x,y,z,i) z+=((w&(x^y))^y)+in[i]+0x5A827999+rol(v,5);w=rol(w,30);
+#define L1(v,w,x,y,z,i) z+=((w&(x^y))^y)+blk(i)+0x5A827999+rol(v,5);w=rol(w,30);
+#define L2(v,w,x,y,z,i) z+=(w^x^y)+blk(i)+0x6ED9EBA1+rol(v,5);w=rol(w,30);
+#define L3(v,w,x,y,z,i) z+=(((w|x)&y)|(w&x))+blk(i)+0x8F1BBCDC+rol(v,5);w=rol(w,30);
+#define L4(v,w,x,y,z,i) z+=(w^x^y)+blk(i)+0xCA62C1D6+rol(v,5);w=rol(w,30);
+
+static inline uint32_t lane_le(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+        (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint32_t lane_be(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+        (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+// unused lanes hash the first stream again, and their result is dropped
+template <typename V, unsigned N>
+static inline __attribute__((always_inline))
+void md5_lanes(MD5_CTX **ctx, const uint8_t **data, size_t blocks, unsigned count)
+{
+    const uint8_t *p[N];
+    V a, b, c, d, sa, sb, sc, sd, in[16];
+    unsigned lane, pos;
+    size_t block;
+
+    for(lane = 0; lane < N; ++lane) {
+        pos = lane < count ? lane : 0;
+        p[lane] = data[pos];
+        a[lane] = ctx[pos]->state[0];
+        b[lane] = ctx[pos]->state[1];
+        c[lane] = ctx[pos]->state[2];
+        d[lane] = ctx[pos]->state[3];
+    }
+
+    for(block = 0; block < blocks; ++block) {
+        for(pos = 0; pos < 16; ++pos) {
+            for(lane = 0; lane < N; ++lane)
+                in[pos][lane] = lane_le(p[lane] + pos * 4);
+        }
+
+        sa = a;
+        sb = b;
+        sc = c;
+        sd = d;
+
+        MD5STEP(F1, a, b, c, d, in[ 0] + 0xd76aa478,  7);
+        MD5STEP(F1, d, a, b, c, in[ 1] + 0xe8c7b756, 12);
+        MD5STEP(F1, c, d, a, b, in[ 2] + 0x242070db, 17);
+        MD5STEP(F1, b, c, d, a, in[ 3] + 0xc1bdceee, 22);
+        MD5STEP(F1, a, b, c, d, in[ 4] + 0xf57c0faf,  7);
+        MD5STEP(F1, d, a, b, c, in[ 5] + 0x4787c62a, 12);
+        MD5STEP(F1, c, d, a, b, in[ 6] + 0xa8304613, 17);
+        MD5STEP(F1, b, c, d, a, in[ 7] + 0xfd469501, 22);
+        MD5STEP(F1, a, b, c, d, in[ 8] + 0x698098d8,  7);
+        MD5STEP(F1, d, a, b, c, in[ 9] + 0x8b44f7af, 12);
+        MD5STEP(F1, c, d, a, b, in[10] + 0xffff5bb1, 17);
+        MD5STEP(F1, b, c, d, a, in[11] + 0x895cd7be, 22);
+        MD5STEP(F1, a, b, c, d, in[12] + 0x6b901122,  7);
+        MD5STEP(F1, d, a, b, c, in[13] + 0xfd987193, 12);
+        MD5STEP(F1, c, d, a, b, in[14] + 0xa679438e, 17);
+        MD5STEP(F1, b, c, d, a, in[15] + 0x49b40821, 22);
+
+        MD5STEP(F2, a, b, c, d, in[ 1] + 0xf61e2562,  5);
+        MD5STEP(F2, d, a, b, c, in[ 6] + 0xc040b340,  9);
+        MD5STEP(F2, c, d, a, b, in[11] + 0x265e5a51, 14);
+        MD5STEP(F2, b, c, d, a, in[ 0] + 0xe9b6c7aa, 20);
+        MD5STEP(F2, a, b, c, d, in[ 5] + 0xd62f105d,  5);
+        MD5STEP(F2, d, a, b, c, in[10] + 0x02441453,  9);
+        MD5STEP(F2, c, d, a, b, in[15] + 0xd8a1e681, 14);
+        MD5STEP(F2, b, c, d, a, in[ 4] + 0xe7d3fbc8, 20);
+        MD5STEP(F2, a, b, c, d, in[ 9] + 0x21e1cde6,  5);
+        MD5STEP(F2, d, a, b, c, in[14] + 0xc33707d6,  9);
+        MD5STEP(F2, c, d, a, b, in[ 3] + 0xf4d50d87, 14);
+        MD5STEP(F2, b, c, d, a, in[ 8] + 0x455a14ed, 20);
+        MD5STEP(F2, a, b, c, d, in[13] + 0xa9e3e905,  5);
+        MD5STEP(F2, d, a, b, c, in[ 2] + 0xfcefa3f8,  9);
+        MD5STEP(F2, c, d, a, b, in[ 7] + 0x676f02d9, 14);
+        MD5STEP(F2, b, c, d, a, in[12] + 0x8d2a4c8a, 20);
+
+        MD5STEP(F3, a, b, c, d, in[ 5] + 0xfffa3942,  4);
+        MD5STEP(F3, d, a, b, c, in[ 8] + 0x8771f681, 11);
+        MD5STEP(F3, c, d, a, b, in[11] + 0x6d9d6122, 16);
+        MD5STEP(F3, b, c, d, a, in[14] + 0xfde5380c, 23);
+        MD5STEP(F3, a, b, c, d, in[ 1] + 0xa4beea44,  4);
+        MD5STEP(F3, d, a, b, c, in[ 4] + 0x4bdecfa9, 11);
+        MD5STEP(F3, c, d, a, b, in[ 7] + 0xf6bb4b60, 16);
+        MD5STEP(F3, b, c, d, a, in[10] + 0xbebfbc70, 23);
+        MD5STEP(F3, a, b, c, d, in[13] + 0x289b7ec6,  4);
+        MD5STEP(F3, d, a, b, c, in[ 0] + 0xeaa127fa, 11);
+        MD5STEP(F3, c, d, a, b, in[ 3] + 0xd4ef3085, 16);
+        MD5STEP(F3, b, c, d, a, in[ 6] + 0x04881d05, 23);
+        MD5STEP(F3, a, b, c, d, in[ 9] + 0xd9d4d039,  4);
+        MD5STEP(F3, d, a, b, c, in[12] + 0xe6db99e5, 11);
+        MD5STEP(F3, c, d, a, b, in[15] + 0x1fa27cf8, 16);
+        MD5STEP(F3, b, c, d, a, in[ 2] + 0xc4ac5665, 23);
+
+        MD5STEP(F4, a, b, c, d, in[ 0] + 0xf4292244,  6);
+        MD5STEP(F4, d, a, b, c, in[ 7] + 0x432aff97, 10);
+        MD5STEP(F4, c, d, a, b, in[14] + 0xab9423a7, 15);
+        MD5STEP(F4, b, c, d, a, in[ 5] + 0xfc93a039, 21);
+        MD5STEP(F4, a, b, c, d, in[12] + 0x655b59c3,  6);
+        MD5STEP(F4, d, a, b, c, in[ 3] + 0x8f0ccc92, 10);
+        MD5STEP(F4, c, d, a, b, in[10] + 0xffeff47d, 15);
+        MD5STEP(F4, b, c, d, a, in[ 1] + 0x85845dd1, 21);
+        MD5STEP(F4, a, b, c, d, in[ 8] + 0x6fa87e4f,  6);
+        MD5STEP(F4, d, a, b, c, in[15] + 0xfe2ce6e0, 10);
+        MD5STEP(F4, c, d, a, b, in[ 6] + 0xa3014314, 15);
+        MD5STEP(F4, b, c, d, a, in[13] + 0x4e0811a1, 21);
+        MD5STEP(F4, a, b, c, d, in[ 4] + 0xf7537e82,  6);
+        MD5STEP(F4, d, a, b, c, in[11] + 0xbd3af235, 10);
+        MD5STEP(F4, c, d, a, b, in[ 2] + 0x2ad7d2bb, 15);
+        MD5STEP(F4, b, c, d, a, in[ 9] + 0xeb86d391, 21);
+
+        a += sa;
+        b += sb;
+        c += sc;
+        d += sd;
+
+        for(lane = 0; lane < N; ++lane)
+            p[lane] += MD5_BLOCK_LENGTH;
+    }
+
+    for(lane = 0; lane < count; ++lane) {
+        ctx[lane]->state[0] = a[lane];
+        ctx[lane]->state[1] = b[lane];
+        ctx[lane]->state[2] = c[lane];
+        ctx[lane]->state[3] = d[lane];
+        ctx[lane]->count += (uint64_t)blocks << 9;
+        data[lane] = p[lane];
+    }
+}
+
+template <typename V, unsigned N>
+static inline __attribute__((always_inline))
+void sha1_lanes(SHA1_CTX **ctx, const uint8_t **data, size_t blocks, unsigned count)
+{
+    const uint8_t *p[N];
+    V a, b, c, d, e, sa, sb, sc, sd, se, in[16];
+    unsigned lane, pos;
+    size_t block;
+
+    for(lane = 0; lane < N; ++lane) {
+        pos = lane < count ? lane : 0;
+        p[lane] = data[pos];
+        a[lane] = ctx[pos]->state[0];
+        b[lane] = ctx[pos]->state[1];
+        c[lane] = ctx[pos]->state[2];
+        d[lane] = ctx[pos]->state[3];
+        e[lane] = ctx[pos]->state[4];
+    }
+
+    for(block = 0; block < blocks; ++block) {
+        for(pos = 0; pos < 16; ++pos) {
+            for(lane = 0; lane < N; ++lane)
+                in[pos][lane] = lane_be(p[lane] + pos * 4);
+        }
+
+        sa = a;
+        sb = b;
+        sc = c;
+        sd = d;
+        se = e;
+
+        L0(a,b,c,d,e, 0); L0(e,a,b,c,d, 1); L0(d,e,a,b,c, 2); L0(c,d,e,a,b, 3);
+        L0(b,c,d,e,a, 4); L0(a,b,c,d,e, 5); L0(e,a,b,c,d, 6); L0(d,e,a,b,c, 7);
+        L0(c,d,e,a,b, 8); L0(b,c,d,e,a, 9); L0(a,b,c,d,e,10); L0(e,a,b,c,d,11);
+        L0(d,e,a,b,c,12); L0(c,d,e,a,b,13); L0(b,c,d,e,a,14); L0(a,b,c,d,e,15);
+        L1(e,a,b,c,d,16); L1(d,e,a,b,c,17); L1(c,d,e,a,b,18); L1(b,c,d,e,a,19);
+        L2(a,b,c,d,e,20); L2(e,a,b,c,d,21); L2(d,e,a,b,c,22); L2(c,d,e,a,b,23);
+        L2(b,c,d,e,a,24); L2(a,b,c,d,e,25); L2(e,a,b,c,d,26); L2(d,e,a,b,c,27);
+        L2(c,d,e,a,b,28); L2(b,c,d,e,a,29); L2(a,b,c,d,e,30); L2(e,a,b,c,d,31);
+        L2(d,e,a,b,c,32); L2(c,d,e,a,b,33); L2(b,c,d,e,a,34); L2(a,b,c,d,e,35);
+        L2(e,a,b,c,d,36); L2(d,e,a,b,c,37); L2(c,d,e,a,b,38); L2(b,c,d,e,a,39);
+        L3(a,b,c,d,e,40); L3(e,a,b,c,d,41); L3(d,e,a,b,c,42); L3(c,d,e,a,b,43);
+        L3(b,c,d,e,a,44); L3(a,b,c,d,e,45); L3(e,a,b,c,d,46); L3(d,e,a,b,c,47);
+        L3(c,d,e,a,b,48); L3(b,c,d,e,a,49); L3(a,b,c,d,e,50); L3(e,a,b,c,d,51);
+        L3(d,e,a,b,c,52); L3(c,d,e,a,b,53); L3(b,c,d,e,a,54); L3(a,b,c,d,e,55);
+        L3(e,a,b,c,d,56); L3(d,e,a,b,c,57); L3(c,d,e,a,b,58); L3(b,c,d,e,a,59);
+        L4(a,b,c,d,e,60); L4(e,a,b,c,d,61); L4(d,e,a,b,c,62); L4(c,d,e,a,b,63);
+        L4(b,c,d,e,a,64); L4(a,b,c,d,e,65); L4(e,a,b,c,d,66); L4(d,e,a,b,c,67);
+        L4(c,d,e,a,b,68); L4(b,c,d,e,a,69); L4(a,b,c,d,e,70); L4(e,a,b,c,d,71);
+        L4(d,e,a,b,c,72); L4(c,d,e,a,b,73); L4(b,c,d,e,a,74); L4(a,b,c,d,e,75);
+        L4(e,a,b,c,d,76); L4(d,e,a,b,c,77); L4(c,d,e,a,b,78); L4(b,c,d,e,a,79);
+
+        a += sa;
+        b += sb;
+        c += sc;
+        d += sd;
+        e += se;
+
+        for(lane = 0; lane < N; ++lane)
+            p[lane] += SHA1_BLOCK_LENGTH;
+    }
+
+    for(lane = 0; lane < count; ++lane) {
+        ctx[lane]->state[0] = a[lane];
+        ctx[lane]->state[1] = b[lane];
+        ctx[lane]->state[2] = c[lane];
+        ctx[lane]->state[3] = d[lane];
+        ctx[lane]->state[4] = e[lane];
+        ctx[lane]->count += (uint64_t)blocks << 9;
+        data[lane] = p[lane];
+    }
+}
+
+static void md5_lanes4(MD5_CTX **ctx, const uint8_t **data, size_t blocks, unsigned count)
+{
+    md5_lanes<lane4_t, 4>(ctx, data, blocks, count);
+}
+
+static void sha1_lanes4(SHA1_CTX **ctx, const uint8_t **data, size_t blocks, unsigned count)
+{
+    sha1_lanes<lane4_t, 4>(ctx, data, blocks, count);
+}
+
+#endif
+
+#ifdef  LANES_X86
+
+__attribute__((target("avx2")))
+static void md5_lanes8(MD5_CTX **ctx, const uint8_t **data, size_t blocks, unsigned count)
+{
+    md5_lanes<lane8_t, 8>(ctx, data, blocks, count);
+}
+
+__attribute__((target("avx2")))
+static void sha1_lanes8(SHA1_CTX **ctx, const uint8_t **data, size_t blocks, unsigned count)
+{
+    sha1_lanes<lane8_t, 8>(ctx, data, blocks, count);
+}
+
+// sha1 with the sha extensions, which do four rounds an instruction...
+__attribute__((target("sha,ssse3,sse4.1")))
+static void sha1_native(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ll, 0x08090a0b0c0d0e0fll);
+    __m128i abcd, e0, e1, save_abcd, save_e0;
+    __m128i msg0, msg1, msg2, msg3;
+
+    abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1b);
+    e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+    while(blocks--) {
+        save_abcd = abcd;
+        save_e0 = e0;
+
+        // rounds 0-15 load the message
+        msg0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), mask);
+        e0 = _mm_add_epi32(e0, msg0);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+        msg1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)), mask);
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+        msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+        msg2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)), mask);
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+        msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+        msg0 = _mm_xor_si128(msg0, msg2);
+
+        msg3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)), mask);
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+        msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+        msg1 = _mm_xor_si128(msg1, msg3);
+
+        // rounds 16-67 each extend the schedule the same way
+        e0 = _mm_sha1nexte_epu32(e0, msg0);
+        e1 = abcd;
+        msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+        msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+        msg2 = _mm_xor_si128(msg2, msg0);
+
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+        msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+        msg3 = _mm_xor_si128(msg3, msg1);
+
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+        msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+        msg0 = _mm_xor_si128(msg0, msg2);
+
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+        msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+        msg1 = _mm_xor_si128(msg1, msg3);
+
+        e0 = _mm_sha1nexte_epu32(e0, msg0);
+        e1 = abcd;
+        msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+        msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+        msg2 = _mm_xor_si128(msg2, msg0);
+
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+        msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+        msg3 = _mm_xor_si128(msg3, msg1);
+
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+        msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+        msg0 = _mm_xor_si128(msg0, msg2);
+
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+        msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+        msg1 = _mm_xor_si128(msg1, msg3);
+
+        e0 = _mm_sha1nexte_epu32(e0, msg0);
+        e1 = abcd;
+        msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+        msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+        msg2 = _mm_xor_si128(msg2, msg0);
+
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+        msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+        msg3 = _mm_xor_si128(msg3, msg1);
+
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+        msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+        msg0 = _mm_xor_si128(msg0, msg2);
+
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+        msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+        msg1 = _mm_xor_si128(msg1, msg3);
+
+        e0 = _mm_sha1nexte_epu32(e0, msg0);
+        e1 = abcd;
+        msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+        msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+        msg2 = _mm_xor_si128(msg2, msg0);
+
+        // rounds 68-79 finish the schedule
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+        msg3 = _mm_xor_si128(msg3, msg1);
+
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+        e0 = _mm_sha1nexte_epu32(e0, save_e0);
+        abcd = _mm_add_epi32(abcd, save_abcd);
+        data += SHA1_BLOCK_LENGTH;
+    }
+
+    _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+#endif
+
+static unsigned lanes_width = 0;
+static int lanes_native = -1;
+
+unsigned DigestLanes(void)
+{
+    unsigned width = 1;
+
+    if(lanes_width)
+        return lanes_width;
+
+#if defined(LANES_VECTOR) && (defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__))
+    width = 4;
+#endif
+
+#ifdef  LANES_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        width = 8;
+#endif
+
+    lanes_width = width;
+    return width;
+}
+
+bool SHA1Native(void)
+{
+#ifdef  LANES_X86
+    unsigned eax, ebx, ecx, edx;
+
+    if(lanes_native < 0) {
+        lanes_native = 0;
+        if(__get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+          (ecx & (1 << 9)) && (ecx & (1 << 19)) &&
+          __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1 << 29)))
+            lanes_native = 1;
+    }
+    return lanes_native > 0;
+#else
+    return false;
+#endif
+}
+
+void MD5Lanes(MD5_CTX *ctx[], const uint8_t *data[], size_t blocks, unsigned count)
+{
+    unsigned lane;
+    size_t block;
+
+#ifdef  LANES_X86
+    if(DigestLanes() == 8) {
+        md5_lanes8(ctx, data, blocks, count);
+        return;
+    }
+#endif
+
+#ifdef  LANES_VECTOR
+    if(DigestLanes() == 4) {
+        md5_lanes4(ctx, data, blocks, count);
+        return;
+    }
+#endif
+
+    for(lane = 0; lane < count; ++lane) {
+        for(block = 0; block < blocks; ++block) {
+            MD5Transform(ctx[lane]->state, data[lane]);
+            data[lane] += MD5_BLOCK_LENGTH;
+        }
+        ctx[lane]->count += (uint64_t)blocks << 9;
+    }
+}
+
+void SHA1Lanes(SHA1_CTX *ctx[], const uint8_t *data[], size_t blocks, unsigned count)
+{
+    unsigned lane;
+
+#ifdef  LANES_X86
+    if(DigestLanes() == 8) {
+        sha1_lanes8(ctx, data, blocks, count);
+        return;
+    }
+#endif
+
+#ifdef  LANES_VECTOR
+    if(DigestLanes() == 4 && !SHA1Native()) {
+        sha1_lanes4(ctx, data, blocks, count);
+        return;
+    }
+#endif
+
+    for(lane = 0; lane < count; ++lane) {
+        SHA1Blocks(ctx[lane]->state, data[lane], blocks);
+        data[lane] += blocks * SHA1_BLOCK_LENGTH;
+        ctx[lane]->count += (uint64_t)blocks << 9;
+    }
+}
+
+void SHA1Blocks(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+#ifdef  LANES_X86
+    if(SHA1Native()) {
+        sha1_native(state, data, blocks);
+        return;
+    }
+#endif
+
+    while(blocks--) {
+        SHA1Transform(state, data);
+        data += SHA1_BLOCK_LENGTH;
+    }
+}
@@ -0,0 +1,40 @@
+// Copyright (C) 2010-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Multi-buffer transforms, which hash whole blocks of several independent
+ * streams at once, one stream to each lane of a vector.  The lanes in use
+ * depend on the cpu, 8 with avx2, 4 with sse2 or neon, and 1 where there
+ * is no vector support, in which case the transforms hash one stream at a
+ * time.  Where the cpu has sha extensions, SHA1Blocks uses them.
+ */
+
+#ifndef _LANES_H_
+#define _LANES_H_
+
+#include "md5.h"
+#include "sha1.h"
+
+#define DIGEST_LANES    8
+
+unsigned DigestLanes(void);
+void MD5Lanes(MD5_CTX *ctx[], const uint8_t *data[], size_t blocks, unsigned count);
+void SHA1Lanes(SHA1_CTX *ctx[], const uint8_t *data[], size_t blocks, unsigned count);
+void SHA1Blocks(uint32_t state[5], const uint8_t *data, size_t blocks);
+bool SHA1Native(void);
+
+#endif
@@ -21,8 +21,197 @@
 #include <fcntl.h>
 #endif
 
+#ifdef  HAVE_SYS_RANDOM_H
+#include <sys/random.h>
+#endif
+
 namespace ucommon {
 
+#ifndef _MSWINDOWS_
+
+// fill() uses a chacha20 generator for each thread, seeded from the
+// kernel.  Keystream is made a buffer at a time, and the first part of each
+// buffer replaces the key, so the state never holds what was handed out.
+// Threads reseed after RANDOM_RESEED bytes, and all do after a fork.  A
+// thread keeps its keystream if a periodic reseed fails, but a child that
+// cannot reseed would repeat the keystream of its parent, and so fails.
+
+#define RANDOM_BLOCKS   16
+#define RANDOM_SEED     40
+#define RANDOM_RESEED   (1024l * 1024l)
+
+#define RANDOM_ROTATE(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define RANDOM_QUARTER(a, b, c, d) \
+    a += b; d ^= a; d = RANDOM_ROTATE(d, 16); \
+    c += d; b ^= c; b = RANDOM_ROTATE(b, 12); \
+    a += b; d ^= a; d = RANDOM_ROTATE(d, 8); \
+    c += d; b ^= c; b = RANDOM_ROTATE(b, 7);
+
+typedef struct {
+    uint32_t input[16];
+    unsigned char stream[RANDOM_BLOCKS * 64];
+    size_t avail;
+    size_t used;
+    unsigned generation;
+} random_t;
+
+static pthread_key_t random_key;
+static pthread_once_t random_once = PTHREAD_ONCE_INIT;
+static volatile unsigned random_generation = 0;
+
+static void random_wipe(void *mem, size_t size)
+{
+    volatile unsigned char *bp = (volatile unsigned char *)mem;
+
+    while(size--)
+        *(bp++) = 0;
+}
+
+static void random_forked(void)
+{
+    ++random_generation;
+}
+
+static void random_cleanup(void *data)
+{
+    random_wipe(data, sizeof(random_t));
+    free(data);
+}
+
+static void random_setup(void)
+{
+    pthread_key_create(&random_key, &random_cleanup);
+    pthread_atfork(NULL, NULL, &random_forked);
+}
+
+static bool random_entropy(unsigned char *buf, size_t size)
+{
+    ssize_t result;
+    int fd;
+
+#ifdef  HAVE_SYS_RANDOM_H
+    while(size) {
+        result = getrandom(buf, size, 0);
+        if(result < 0 && errno == EINTR)
+            continue;
+        if(result < 1)
+            break;
+        buf += result;
+        size -= (size_t)result;
+    }
+
+    if(!size)
+        return true;
+#endif
+
+    fd = open("/dev/urandom", O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    while(size) {
+        result = read(fd, buf, size);
+        if(result < 0 && errno == EINTR)
+            continue;
+        if(result < 1)
+            break;
+        buf += result;
+        size -= (size_t)result;
+    }
+    close(fd);
+    return size == 0;
+}
+
+static void random_block(uint32_t *input, unsigned char *out)
+{
+    uint32_t x[16];
+    unsigned pos;
+
+    memcpy(x, input, sizeof(x));
+    for(pos = 0; pos < 10; ++pos) {
+        RANDOM_QUARTER(x[0], x[4], x[8], x[12])
+        RANDOM_QUARTER(x[1], x[5], x[9], x[13])
+        RANDOM_QUARTER(x[2], x[6], x[10], x[14])
+        RANDOM_QUARTER(x[3], x[7], x[11], x[15])
+        RANDOM_QUARTER(x[0], x[5], x[10], x[15])
+        RANDOM_QUARTER(x[1], x[6], x[11], x[12])
+        RANDOM_QUARTER(x[2], x[7], x[8], x[13])
+        RANDOM_QUARTER(x[3], x[4], x[9], x[14])
+    }
+
+    for(pos = 0; pos < 16; ++pos)
+        x[pos] += input[pos];
+    memcpy(out, x, sizeof(x));
+
+    if(!++input[12])
+        ++input[13];
+}
+
+static void random_rekey(random_t *rng, const unsigned char *seed)
+{
+    static const uint32_t sigma[4] = {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+
+    memcpy(rng->input, sigma, sizeof(sigma));
+    memcpy(rng->input + 4, seed, 32);
+    rng->input[12] = rng->input[13] = 0;
+    memcpy(rng->input + 14, seed + 32, 8);
+}
+
+static bool random_seed(random_t *rng)
+{
+    unsigned char seed[RANDOM_SEED];
+
+    if(!random_entropy(seed, sizeof(seed)))
+        return false;
+
+    random_rekey(rng, seed);
+    random_wipe(seed, sizeof(seed));
+    random_wipe(rng->stream, sizeof(rng->stream));
+    rng->avail = rng->used = 0;
+    rng->generation = random_generation;
+    return true;
+}
+
+static void random_refill(random_t *rng)
+{
+    for(unsigned pos = 0; pos < RANDOM_BLOCKS; ++pos)
+        random_block(rng->input, rng->stream + pos * 64);
+
+    random_rekey(rng, rng->stream);
+    memset(rng->stream, 0, RANDOM_SEED);
+    rng->avail = sizeof(rng->stream) - RANDOM_SEED;
+}
+
+static random_t *random_self(void)
+{
+    random_t *rng;
+
+    pthread_once(&random_once, &random_setup);
+    rng = (random_t *)pthread_getspecific(random_key);
+    if(!rng) {
+        rng = (random_t *)malloc(sizeof(random_t));
+        if(!rng)
+            return NULL;
+        if(!random_seed(rng)) {
+            free(rng);
+            return NULL;
+        }
+        pthread_setspecific(random_key, rng);
+    }
+    else if(rng->generation != random_generation) {
+        bool seeded = random_seed(rng);
+        crit(seeded, "random reseed after fork failed");
+    }
+    else if(rng->used >= RANDOM_RESEED) {
+        if(!random_seed(rng))
+            rng->used = 0;
+    }
+    return rng;
+}
+
+#endif
+
 void Random::seed(void)
 {
     time_t now;
@@ -44,6 +233,12 @@ bool Random::seed(const unsigned char *buf, size_t size)
             result = true;
         close(fd);
     }
+
+    // have our generator draw on the new entropy at its next use
+    pthread_once(&random_once, &random_setup);
+    random_t *rng = (random_t *)pthread_getspecific(random_key);
+    if(rng)
+        rng->used = RANDOM_RESEED;
     return result;
 #endif
 }
@@ -55,6 +250,11 @@ size_t Random::key(unsigned char *buf, size_t size)
         return size;
     return 0;
 #else
+#ifdef  HAVE_SYS_RANDOM_H
+    if(random_entropy(buf, size))
+        return size;
+#endif
+
     int fd = open("/dev/random", O_RDONLY);
     ssize_t result = 0;
 
@@ -75,24 +275,31 @@ size_t Random::fill(unsigned char *buf, size_t size)
 #ifdef  _MSWINDOWS_
     return key(buf, size);
 #else
-    int fd = open("/dev/urandom", O_RDONLY);
-    ssize_t result = 0;
+    random_t *rng = random_self();
+    size_t count = size, len;
 
-    if(fd > -1) {
-        result = read(fd, buf, size);
-        close(fd);
-    }
-    // ugly...would not trust it
-    else {
-        result = 0;
-        while(result++ < (ssize_t)size)
+    // ugly...would not trust it, only used if we could never seed
+    if(!rng) {
+        while(count--)
             *(buf++) = rand() & 0xff;
+        return size;
     }
 
-    if(result < 0)
-        result = 0;
-
-    return (size_t)result;
+    while(count) {
+        if(!rng->avail)
+            random_refill(rng);
+        len = rng->avail;
+        if(len > count)
+            len = count;
+        unsigned char *bp = rng->stream + sizeof(rng->stream) - rng->avail;
+        memcpy(buf, bp, len);
+        memset(bp, 0, len);
+        rng->avail -= len;
+        buf += len;
+        count -= len;
+    }
+    rng->used += size;
+    return size;
 #endif
 }
 
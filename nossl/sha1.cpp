@@ -16,6 +16,7 @@
 
 #include <ucommon/string.h>
 #include "sha1.h"
+#include "lanes.h"
 
 #define rol(value, bits) (((value) << (bits)) | ((value) >> (32 - (bits))))
 
@@ -189,8 +190,10 @@ SHA1Update(SHA1_CTX *context, const uint8_t *data, size_t len)
     if ((j + len) > 63) {
         (void)memcpy(&context->buffer[j], data, (i = 64-j));
         SHA1Transform(context->state, context->buffer);
-        for ( ; i + 63 < len; i += 64)
-            SHA1Transform(context->state, (uint8_t *)&data[i]);
+        if (i + 63 < len) {
+            SHA1Blocks(context->state, &data[i], (len - i) / 64);
+            i += ((len - i) / 64) * 64;
+        }
         j = 0;
     } else {
         i = 0;
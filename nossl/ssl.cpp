@@ -85,4 +85,26 @@ bool SSLBuffer::_flush(void)
     return TCPBuffer::_flush();
 }
 
+bool SSLBuffer::records(void)
+{
+    if(is_open())
+        allocate(16384);
+    return false;
+}
+
+size_t SSLBuffer::_sendv(const struct iovec *vector, unsigned count)
+{
+    return TCPBuffer::_sendv(vector, count);
+}
+
+size_t SSLBuffer::_sendfile(fsys& file, size_t size)
+{
+    return TCPBuffer::_sendfile(file, size);
+}
+
+bool SSLBuffer::is_offloaded(void) const
+{
+    return false;
+}
+
 } // namespace ucommon
@@ -67,6 +67,11 @@ ssize_t sstream::_write(const char *address, size_t size)
     return tcpstream::_write(address, size);
 }
 
+ssize_t sstream::_writev(const struct iovec *vector, unsigned count)
+{
+    return tcpstream::_writev(vector, count);
+}
+
 ssize_t sstream::_read(char *address, size_t size)
 {
     return tcpstream::_read(address, size);
@@ -82,6 +87,20 @@ int sstream::sync()
     return tcpstream::sync();
 }
 
+bool sstream::records(void)
+{
+    if(is_open()) {
+        sync();
+        StreamBuffer::allocate(16384);
+    }
+    return false;
+}
+
+bool sstream::is_offloaded(void) const
+{
+    return false;
+}
+
 } // namespace ucommon
 
 #endif
@@ -65,6 +65,18 @@ bool Digest::put(const void *address, size_t size)
     return true;
 }
 
+// evp already picks the fastest transform for the cpu, one stream at a time
+bool Digest::batch(Digest **digests, const void **memory, const size_t *size, unsigned count)
+{
+    bool result = true;
+
+    for(unsigned pos = 0; pos < count; ++pos) {
+        if(!digests[pos]->put(memory[pos], size[pos]))
+            result = false;
+    }
+    return result;
+}
+
 void Digest::reset(void)
 {
     if(!context) {
@@ -31,6 +31,14 @@
 #include <wincrypt.h>
 #endif
 
+// sessions ask openssl to hand established records to the kernel...
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS) && !defined(_MSWINDOWS_)
+#define KTLS_SENDS
+#endif
+
+// largest tls record, which whole record buffering is sized for
+#define TLS_RECORD  SSL3_RT_MAX_PLAIN_LENGTH
+
 namespace ucommon {
 
 class __LOCAL __context : public secure
@@ -41,6 +49,16 @@ public:
     SSL_CTX *ctx;
 };
 
+// with read ahead, openssl may hold input that is not yet a record...
+inline bool ssl_pending(void *ssl)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+    return SSL_has_pending((SSL *)ssl) != 0;
+#else
+    return SSL_pending((SSL *)ssl) != 0;
+#endif
+}
+
 } // namespace ucommon
 
 
@@ -110,6 +110,10 @@ secure::client_t secure::client(const char *ca)
         return ctx;
     }
 
+#ifdef  KTLS_SENDS
+    SSL_CTX_set_options(ctx->ctx, SSL_OP_ENABLE_KTLS);
+#endif
+
     if(!ca)
         return ctx;
 
@@ -140,6 +144,10 @@ secure::server_t secure::server(const char *certfile, const char *ca)
         return ctx;
     }
 
+#ifdef  KTLS_SENDS
+    SSL_CTX_set_options(ctx->ctx, SSL_OP_ENABLE_KTLS);
+#endif
+
     if(!SSL_CTX_use_certificate_chain_file(ctx->ctx, certfile)) {
         ctx->error = secure::MISSING_CERTIFICATE;
         return ctx;
@@ -17,6 +17,10 @@
 
 #include "local.h"
 
+#ifdef  KTLS_SENDS
+#include <unistd.h>
+#endif
+
 namespace ucommon {
 
 SSLBuffer::SSLBuffer(secure::client_t scontext) :
@@ -121,7 +125,7 @@ bool SSLBuffer::_pending(void)
     if(input_pending())
         return true;
 
-    if(ssl && SSL_pending((SSL *)ssl))
+    if(ssl && ssl_pending(ssl))
         return true;
 
     if(iowait && iowait != Timer::inf)
@@ -135,7 +139,7 @@ size_t SSLBuffer::_pull(char *address, size_t size)
     if(!bio)
         return TCPBuffer::_pull(address, size);
 
-    if(SSL_pending((SSL *)ssl) == 0 && iowait && iowait != Timer::inf && !Socket::wait(so, iowait))
+    if(!ssl_pending(ssl) && iowait && iowait != Timer::inf && !Socket::wait(so, iowait))
         return 0;
 
     int result = SSL_read((SSL *)ssl, address, size);
@@ -164,4 +168,96 @@ bool SSLBuffer::_flush(void)
     return false;
 }
 
+bool SSLBuffer::records(void)
+{
+    if(!is_open())
+        return false;
+
+    allocate(TLS_RECORD);
+    if(!bio)
+        return false;
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+    SSL_set_read_ahead((SSL *)ssl, 1);
+#endif
+    return true;
+}
+
+bool SSLBuffer::is_offloaded(void) const
+{
+#ifdef  KTLS_SENDS
+    if(bio)
+        return BIO_get_ktls_send(SSL_get_wbio((SSL *)ssl)) > 0;
+#endif
+    return false;
+}
+
+size_t SSLBuffer::_sendv(const struct iovec *vector, unsigned count)
+{
+    size_t total = 0;
+
+    if(!bio || is_offloaded())
+        return TCPBuffer::_sendv(vector, count);
+
+    // slices are gathered in the buffer, and so sent as full records
+    while(count--) {
+        if(put(vector->iov_base, vector->iov_len) < vector->iov_len)
+            return total;
+        total += vector->iov_len;
+        ++vector;
+    }
+
+    // a failed flush leaves the tail of our slices unsent
+    if(!flush())
+        return total > output_waiting() ? total - output_waiting() : 0;
+
+    return total;
+}
+
+size_t SSLBuffer::_sendfile(fsys& file, size_t size)
+{
+    char buf[8192];
+    size_t total = 0;
+    ssize_t result;
+
+    if(!bio)
+        return TCPBuffer::_sendfile(file, size);
+
+    if(ioerr || !flush())
+        return 0;
+
+#ifdef  KTLS_SENDS
+    if(is_offloaded()) {
+        off_t offset = ::lseek(file.handle(), 0, SEEK_CUR);
+
+        while(offset != (off_t)-1 && total < size) {
+            result = SSL_sendfile((SSL *)ssl, file.handle(), offset, size - total, 0);
+            if(result < 1)
+                break;
+            offset += result;
+            total += result;
+        }
+
+        if(offset != (off_t)-1) {
+            ::lseek(file.handle(), offset, SEEK_SET);
+            if(total < size)
+                ioerr = EIO;
+            return total;
+        }
+    }
+#endif
+
+    while(total < size) {
+        result = file.read(buf, (size - total) > sizeof(buf) ? sizeof(buf) : size - total);
+        if(result < 1)
+            break;
+        if(put(buf, result) < (size_t)result)
+            return total;
+        total += result;
+    }
+
+    flush();
+    return total;
+}
+
 } // namespace ucommon
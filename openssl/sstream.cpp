@@ -107,6 +107,60 @@ ssize_t sstream::_write(const char *address, size_t size)
     return SSL_write((SSL *)ssl, address, size);
 }
 
+ssize_t sstream::_writev(const struct iovec *vector, unsigned count)
+{
+    char record[TLS_RECORD];
+    const char *data;
+    size_t used = 0, offset = 0, len;
+    ssize_t result, total = 0;
+
+    if(!bio || is_offloaded())
+        return tcpstream::_writev(vector, count);
+
+    // small slices, such as pending output before a large write, are
+    // gathered so that they are sent as a full record rather than alone
+    while(count) {
+        data = (const char *)vector->iov_base + offset;
+        len = vector->iov_len - offset;
+        if(!used && len >= sizeof(record)) {
+            result = _write(data, len);
+            if(result < 0 && !total)
+                return result;
+            if(result > 0)
+                total += result;
+            if(result < (ssize_t)len)
+                return total;
+            offset = vector->iov_len;
+        }
+        else {
+            if(len > sizeof(record) - used)
+                len = sizeof(record) - used;
+            memcpy(record + used, data, len);
+            used += len;
+            offset += len;
+        }
+
+        if(offset == vector->iov_len) {
+            offset = 0;
+            ++vector;
+            --count;
+        }
+
+        if(!used || (used < sizeof(record) && count))
+            continue;
+
+        result = _write(record, used);
+        if(result < 0 && !total)
+            return result;
+        if(result > 0)
+            total += result;
+        if(result < (ssize_t)used)
+            return total;
+        used = 0;
+    }
+    return total;
+}
+
 ssize_t sstream::_read(char *address, size_t size)
 {
     if(!bio)
@@ -120,7 +174,7 @@ bool sstream::_wait(void)
     if(so == INVALID_SOCKET)
         return false;
 
-    if(ssl && SSL_pending((SSL *)ssl))
+    if(ssl && ssl_pending(ssl))
         return true;
 
     return tcpstream::_wait();
@@ -135,6 +189,31 @@ int sstream::sync()
     return rtn;
 }
 
+bool sstream::records(void)
+{
+    if(!is_open())
+        return false;
+
+    sync();
+    StreamBuffer::allocate(TLS_RECORD);
+    if(!bio)
+        return false;
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+    SSL_set_read_ahead((SSL *)ssl, 1);
+#endif
+    return true;
+}
+
+bool sstream::is_offloaded(void) const
+{
+#ifdef  KTLS_SENDS
+    if(bio)
+        return BIO_get_ktls_send(SSL_get_wbio((SSL *)ssl)) > 0;
+#endif
+    return false;
+}
+
 } // namespace ucommon
 
 #endif
@@ -0,0 +1,126 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <ucommon-config.h>
+#include <ucommon/ucommon.h>
+#include <commoncpp/commoncpp.h>
+#include <commoncpp/applog.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define LOGFILE     "ucommon-applog.log"
+#define THREADS     4
+#define MESSAGES    2000
+
+static ost::AppLog *applog;
+static volatile bool stopping = false;
+
+class worker : public ost::Thread
+{
+private:
+    unsigned id, count;
+
+public:
+    worker(unsigned index, unsigned messages) : ost::Thread()
+        {id = index; count = messages;}
+
+    void run(void) {
+        applog->subscribe();
+        for(unsigned pos = 0; pos < count || (!count && !stopping); ++pos)
+            applog->info("thread %u message %u\n", id, pos);
+        applog->unsubscribe();
+    }
+};
+
+// every message a thread logged is found in order, if all must arrive
+static void verify(bool all)
+{
+    char line[256];
+    unsigned next[THREADS], id, pos;
+    const char *text;
+
+    memset(next, 0, sizeof(next));
+    FILE *fp = fopen(LOGFILE, "r");
+    assert(fp != NULL);
+    while(fgets(line, sizeof(line), fp)) {
+        text = strstr(line, "thread ");
+        assert(text != NULL);
+        assert(sscanf(text, "thread %u message %u", &id, &pos) == 2);
+        assert(id < THREADS);
+        if(all)
+            assert(pos == next[id]);
+        else
+            assert(pos >= next[id]);
+        next[id] = pos + 1;
+    }
+    fclose(fp);
+
+    if(all) {
+        for(id = 0; id < THREADS; ++id)
+            assert(next[id] == MESSAGES);
+    }
+}
+
+extern "C" int main()
+{
+    worker *workers[THREADS];
+    unsigned pos;
+
+    // a small ring makes writers block for the log thread
+    ucommon::fsys::erase(LOGFILE);
+    applog = new ost::AppLog(LOGFILE, false);
+    applog->asyncEnable(4096, ost::AppLog::overflowBlock);
+    for(pos = 0; pos < THREADS; ++pos) {
+        workers[pos] = new worker(pos, MESSAGES);
+        workers[pos]->start();
+    }
+    for(pos = 0; pos < THREADS; ++pos) {
+        workers[pos]->join();
+        delete workers[pos];
+    }
+    assert(applog->dropped() == 0);
+    delete applog;
+    verify(true);
+
+    // the writer may be replaced while threads are still logging
+    ucommon::fsys::erase(LOGFILE);
+    applog = new ost::AppLog(LOGFILE, false);
+    applog->asyncEnable(4096, ost::AppLog::overflowBlock);
+    for(pos = 0; pos < THREADS; ++pos) {
+        workers[pos] = new worker(pos, 0);
+        workers[pos]->start();
+    }
+    for(pos = 0; pos < 20; ++pos) {
+        ucommon::Thread::sleep(5);
+        applog->asyncEnable(4096, ost::AppLog::overflowBlock);
+    }
+    stopping = true;
+    for(pos = 0; pos < THREADS; ++pos) {
+        workers[pos]->join();
+        delete workers[pos];
+    }
+    delete applog;
+    verify(false);
+
+    ucommon::fsys::erase(LOGFILE);
+    return 0;
+}
@@ -0,0 +1,36 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TEST_BENCH_H_
+#define _TEST_BENCH_H_
+
+#include <stdio.h>
+
+// milliseconds since the ticks were taken.
+static inline double elapsed(ucommon::Timer::tick_t start)
+{
+    return (double)(ucommon::Timer::ticks() - start) / 10000.0;
+}
+
+// report how many operations were done each second, and what each cost.
+static inline void report(const char *id, double ms, unsigned long ops, const char *unit = "op")
+{
+    printf("%-22s %8.1f ms, %10.0f %ss/sec, %8.0f ns/%s\n", id, ms,
+        ops / (ms / 1000.0), unit, (ms * 1000000.0) / ops, unit);
+}
+
+#endif
@@ -0,0 +1,128 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace ucommon;
+
+#define BLOCK   70000
+#define FILED   200000
+#define TOTAL   (6 + 1000 + BLOCK + FILED + BLOCK)
+
+static char block[BLOCK];
+static char expect[TOTAL];
+
+// collects everything sent on each accepted connection...
+class collector : public JoinableThread
+{
+public:
+    TCPServer *server;
+    char data[2][TOTAL];
+    size_t received[2];
+
+    collector(TCPServer *from) : JoinableThread() {server = from;}
+
+    inline void finish(void)
+        {join();}
+
+    void run(void) {
+        for(unsigned pass = 0; pass < 2; ++pass) {
+            socket_t so;
+            ssize_t len;
+            char *buf = data[pass];
+
+            received[pass] = 0;
+            if(!server->wait(2000))
+                return;
+            so = server->accept();
+            while((len = Socket::recvfrom(so, buf + received[pass], TOTAL - received[pass])) > 0)
+                received[pass] += len;
+            Socket::release(so);
+        }
+    }
+};
+
+extern "C" int main()
+{
+    struct iovec vector[2];
+    const char *tmp = "ucommon-buffer.tmp";
+    size_t pos = 0;
+
+    for(unsigned index = 0; index < BLOCK; ++index)
+        block[index] = (char)(index * 7 + index / 251);
+
+    memcpy(expect, "hello\n", 6);
+    pos = 6;
+    memcpy(expect + pos, block + 1, 1000);
+    pos += 1000;
+    memcpy(expect + pos, block, BLOCK);
+    pos += BLOCK;
+
+    fsys::erase(tmp);
+    fsys file(tmp, 0640, fsys::REWRITE);
+    assert(is(file));
+    for(size_t index = 0; index < FILED; index += 1000) {
+        assert(file.write(block + (index % 5000), 1000) == 1000);
+        memcpy(expect + pos + index, block + (index % 5000), 1000);
+    }
+    pos += FILED;
+    memcpy(expect + pos, block, BLOCK);
+    file.seek(0);
+
+    TCPServer server("127.0.0.1", "4456");
+    static collector reader(&server);
+    reader.start();
+
+    // buffered, gathered, file, and zero copy sends in one stream...
+    TCPBuffer client("127.0.0.1", "4456");
+    assert(client.put("hello\n", 6) == 6);
+    vector[0].iov_base = block + 1;
+    vector[0].iov_len = 1000;
+    vector[1].iov_base = block;
+    vector[1].iov_len = BLOCK;
+    assert(client.sendv(vector, 2) == 1000 + BLOCK);
+    assert(client.sendfile(file, FILED) == FILED);
+    client.zerocopy(4096);
+    assert(client.sendv(vector + 1, 1) == BLOCK);
+    client.close();
+    file.close();
+    fsys::erase(tmp);
+
+    // large stream writes bypass the stream buffer...
+    Socket::address addr("127.0.0.1", "4456");
+    tcpstream tcp(addr);
+    tcp << "hello\n";
+    tcp.write(block, BLOCK);
+    tcp.flush();
+    assert(tcp.good());
+    tcp.close();
+
+    reader.finish();
+    assert(reader.received[0] == TOTAL);
+    assert(!memcmp(reader.data[0], expect, TOTAL));
+    assert(reader.received[1] == BLOCK + 6);
+    assert(!memcmp(reader.data[1], "hello\n", 6));
+    assert(!memcmp(reader.data[1] + 6, block, BLOCK));
+    return 0;
+}
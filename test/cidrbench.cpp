@@ -0,0 +1,91 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+// compare longest prefix lookups in a large cidr policy chain, searched
+// entry by entry with cidr::find, with the same chain held in a cidrmap.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define ENTRIES     20000
+#define LOOKUPS     400000
+#define LINEAR      2000
+
+static struct sockaddr_in hosts[LOOKUPS];
+
+extern "C" int main()
+{
+    LinkedObject *policy = NULL;
+    unsigned long hits = 0;
+    Timer::tick_t start;
+    char buf[64];
+
+    srand(1);
+    for(unsigned pos = 0; pos < ENTRIES; ++pos) {
+        snprintf(buf, sizeof(buf), "%u.%u.%u.0/%u", rand() & 63, rand() & 255,
+            rand() & 255, 8 + (rand() % 17));
+        new cidr(&policy, buf);
+    }
+    for(unsigned pos = 0; pos < LOOKUPS; ++pos) {
+        hosts[pos].sin_family = AF_INET;
+        hosts[pos].sin_addr.s_addr = htonl(((uint32_t)(rand() & 63) << 24) |
+            ((uint32_t)rand() & 0xffffff));
+    }
+
+    start = Timer::ticks();
+    cidrmap index(policy);
+    report("cidrmap build", elapsed(start), index.count());
+
+    // the chain search is far slower, so only a slice of lookups are used
+    start = Timer::ticks();
+    for(unsigned pos = 0; pos < LINEAR; ++pos) {
+        if(cidr::find(policy, (struct sockaddr *)&hosts[pos]))
+            ++hits;
+    }
+    report("cidr::find", elapsed(start), LINEAR);
+
+    start = Timer::ticks();
+    for(unsigned pos = 0; pos < LOOKUPS; ++pos) {
+        if(index.find((struct sockaddr *)&hosts[pos]))
+            ++hits;
+    }
+    report("cidrmap find", elapsed(start), LOOKUPS);
+
+    start = Timer::ticks();
+    for(unsigned pos = 0; pos < LOOKUPS; ++pos) {
+        if(index.container((struct sockaddr *)&hosts[pos]))
+            ++hits;
+    }
+    report("cidrmap container", elapsed(start), LOOKUPS);
+
+    start = Timer::ticks();
+    index.set(policy);
+    report("cidrmap rebuild", elapsed(start), index.count());
+
+    printf("hits %lu\n", hits);
+    while(policy) {
+        LinkedObject *next = policy->getNext();
+        delete (cidr *)policy;
+        policy = next;
+    }
+    return 0;
+}
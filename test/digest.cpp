@@ -26,6 +26,11 @@
 
 using namespace ucommon;
 
+#define STREAMS 11
+
+static unsigned char data[STREAMS][5000];
+static const size_t sizes[STREAMS] = {0, 1, 63, 64, 65, 130, 200, 1000, 4103, 4999, 3000};
+
 int main(int argc, char **argv)
 {
     digest_t md5 = "md5";
@@ -41,6 +46,35 @@ int main(int argc, char **argv)
     md5.puts("this is some text");
     assert(eq("684d9d89b9de8178dcd80b7b4d018103", *md5));
 
+    // a batch of uneven streams, some with a partial block held already,
+    // must give what putting each stream by itself does
+    digest_t single[STREAMS], batched[STREAMS];
+    Digest *list[STREAMS];
+    const void *memory[STREAMS];
+    unsigned pos, count;
+
+    for(pos = 0; pos < STREAMS; ++pos) {
+        for(count = 0; count < sizeof(data[pos]); ++count)
+            data[pos][count] = (unsigned char)(pos * 131 + count * 7);
+        single[pos] = (pos & 1) ? "md5" : "sha1";
+        batched[pos] = (pos & 1) ? "md5" : "sha1";
+        if(pos % 3 == 1) {
+            single[pos].puts("held");
+            batched[pos].puts("held");
+        }
+        list[pos] = &batched[pos];
+        memory[pos] = data[pos];
+    }
+
+    for(count = 0; count < 2; ++count) {
+        for(pos = 0; pos < STREAMS; ++pos)
+            single[pos].put(data[pos], sizes[pos]);
+        assert(Digest::batch(list, memory, sizes, STREAMS));
+    }
+
+    for(pos = 0; pos < STREAMS; ++pos)
+        assert(eq(*single[pos], *batched[pos]));
+
     return 0;
 }
 
@@ -0,0 +1,109 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare hashing several streams with a put for each digest and with one
+// batch for all of them, for large and for small messages.  Cycles per
+// byte are shown where the cpu has a time stamp counter.
+
+#include <ucommon/ucommon.h>
+#include <ucommon/secure.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define CYCLES()    __rdtsc()
+#else
+#define CYCLES()    0
+#endif
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define STREAMS     8
+#define LARGE       (1024 * 1024)
+#define SMALL       1500
+#define TOTAL       (256l * 1024l * 1024l)
+
+static unsigned char data[STREAMS][LARGE];
+
+static void throughput(const char *id, double ms, unsigned long long cycles)
+{
+    printf("%-16s %8.1f ms, %8.1f MB/sec", id, ms,
+        ((double)TOTAL / (1024.0 * 1024.0)) / (ms / 1000.0));
+    if(cycles)
+        printf(", %5.2f cycles/byte", (double)cycles / (double)TOTAL);
+    printf("\n");
+}
+
+static void compare(const char *type, size_t size)
+{
+    digest_t single[STREAMS], batched[STREAMS];
+    Digest *list[STREAMS];
+    const void *memory[STREAMS];
+    size_t sizes[STREAMS];
+    unsigned long long cycles;
+    Timer::tick_t start;
+    char id[32];
+    long count, rounds = TOTAL / (STREAMS * size);
+    unsigned pos;
+
+    for(pos = 0; pos < STREAMS; ++pos) {
+        single[pos] = type;
+        batched[pos] = type;
+        list[pos] = &batched[pos];
+        memory[pos] = data[pos];
+        sizes[pos] = size;
+    }
+
+    snprintf(id, sizeof(id), "%s put %lu", type, (unsigned long)size);
+    start = Timer::ticks();
+    cycles = CYCLES();
+    for(count = 0; count < rounds; ++count) {
+        for(pos = 0; pos < STREAMS; ++pos)
+            single[pos].put(data[pos], size);
+    }
+    cycles = CYCLES() - cycles;
+    throughput(id, elapsed(start), cycles);
+
+    snprintf(id, sizeof(id), "%s batch %lu", type, (unsigned long)size);
+    start = Timer::ticks();
+    cycles = CYCLES();
+    for(count = 0; count < rounds; ++count)
+        Digest::batch(list, memory, sizes, STREAMS);
+    cycles = CYCLES() - cycles;
+    throughput(id, elapsed(start), cycles);
+
+    for(pos = 0; pos < STREAMS; ++pos) {
+        if(!eq(*single[pos], *batched[pos]))
+            printf("*** %s: stream %u differs\n", type, pos);
+    }
+}
+
+extern "C" int main()
+{
+    for(unsigned pos = 0; pos < STREAMS; ++pos)
+        memset(data[pos], (int)(pos * 31 + 7), LARGE);
+
+    compare("md5", LARGE);
+    compare("md5", SMALL);
+    compare("sha1", LARGE);
+    compare("sha1", SMALL);
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare running short jobs in a joinable thread each with running them
+// as executor tasks, both submitted from outside and forked from tasks.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define JOBS    20000
+#define BATCH   64
+#define DEPTH   16
+
+static volatile unsigned long sink;
+
+static void work(unsigned seed)
+{
+    unsigned long sum = seed;
+
+    for(unsigned pos = 0; pos < 256; ++pos)
+        sum = sum * 31 + pos;
+    sink += sum;
+}
+
+class job : public JoinableThread
+{
+public:
+    unsigned seed;
+
+    job() : JoinableThread() {seed = 0;}
+
+    ~job() {join();}
+
+    void run(void) {
+        work(seed);
+    }
+};
+
+class task : public Executor::task
+{
+public:
+    unsigned seed;
+
+    task() : Executor::task() {seed = 0;}
+
+    void run(void) {
+        work(seed);
+    }
+};
+
+class tree : public Executor::task
+{
+private:
+    Executor *pool;
+    unsigned depth;
+
+public:
+    tree(Executor *executor, unsigned level) : Executor::task() {
+        pool = executor;
+        depth = level;
+    }
+
+    void run(void) {
+        work(depth);
+        if(!depth)
+            return;
+
+        tree left(pool, depth - 1), right(pool, depth - 1);
+        pool->submit(&left);
+        pool->submit(&right);
+        right.join();
+        left.join();
+    }
+};
+
+static double threads(void)
+{
+    job *jobs[BATCH];
+    Timer::tick_t start = Timer::ticks();
+
+    // a bounded batch in flight, since each holds a thread and stack
+    for(unsigned count = 0; count < JOBS; count += BATCH) {
+        for(unsigned pos = 0; pos < BATCH; ++pos) {
+            jobs[pos] = new job();
+            jobs[pos]->seed = count + pos;
+            jobs[pos]->start();
+        }
+        for(unsigned pos = 0; pos < BATCH; ++pos)
+            delete jobs[pos];
+    }
+    return elapsed(start);
+}
+
+static double tasks(Executor *pool)
+{
+    task *list = new task[JOBS];
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned pos = 0; pos < JOBS; ++pos) {
+        list[pos].seed = pos;
+        pool->submit(&list[pos]);
+    }
+    pool->wait();
+    double ms = elapsed(start);
+    delete[] list;
+    return ms;
+}
+
+static double forked(Executor *pool)
+{
+    tree root(pool, DEPTH);
+    Timer::tick_t start = Timer::ticks();
+
+    pool->submit(&root);
+    root.join();
+    return elapsed(start);
+}
+
+extern "C" int main()
+{
+    Executor pool;
+    Executor bound(0, true);
+
+    pool.start();
+    bound.start();
+
+    printf("executor workers: %u\n", pool.size());
+    report("thread per job", threads(), JOBS, "job");
+    report("executor submit", tasks(&pool), JOBS, "job");
+    report("executor affinity", tasks(&bound), JOBS, "job");
+    report("executor fork join", forked(&pool), (2u << DEPTH) - 1, "job");
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+
+using namespace ucommon;
+
+static Executor *pool;
+static atomic::counter counted;
+
+class count : public Executor::task
+{
+public:
+    void run(void) {
+        ++counted;
+    }
+};
+
+class fib : public Executor::task
+{
+private:
+    unsigned value;
+
+public:
+    unsigned long result;
+
+    fib(unsigned n) : Executor::task() {value = n; result = 0;}
+
+    void run(void) {
+        if(value < 10) {
+            unsigned long prior = 0, next = 1;
+            for(unsigned pos = 0; pos < value; ++pos) {
+                unsigned long sum = prior + next;
+                prior = next;
+                next = sum;
+            }
+            result = prior;
+            return;
+        }
+
+        // sub-tasks are joined from within the task...
+        fib left(value - 1), right(value - 2);
+        pool->submit(&left);
+        pool->submit(&right);
+        right.join();
+        left.join();
+        result = left.result + right.result;
+    }
+};
+
+class slow : public Executor::task
+{
+public:
+    void run(void) {
+        Thread::sleep(200);
+    }
+};
+
+extern "C" int main()
+{
+    count tasks[1000];
+    fib tree(22);
+    slow nap;
+
+    pool = new Executor(4);
+    assert(pool->size() == 4);
+    assert(Executor::cpus() > 0);
+
+    // submitted before start, run once started
+    assert(pool->submit(&tree));
+    assert(!pool->submit(&tree));
+    pool->start();
+    tree.join();
+    assert(!tree.is_pending());
+    assert(tree.result == 17711);
+
+    for(unsigned pos = 0; pos < 1000; ++pos)
+        assert(pool->submit(&tasks[pos]));
+    pool->wait();
+    assert(pool->pending() == 0);
+    assert((long)counted == 1000);
+
+    // completed tasks may be submitted again
+    for(unsigned pos = 0; pos < 1000; ++pos)
+        assert(pool->submit(&tasks[pos]));
+    for(unsigned pos = 0; pos < 1000; ++pos)
+        tasks[pos].join();
+    assert((long)counted == 2000);
+
+    assert(pool->submit(&nap));
+    assert(!nap.join((timeout_t)10));
+    assert(nap.join((timeout_t)5000));
+
+    // pending tasks are completed when stopped
+    for(unsigned pos = 0; pos < 1000; ++pos)
+        assert(pool->submit(&tasks[pos]));
+    pool->stop();
+    assert(pool->pending() == 0);
+    assert((long)counted == 3000);
+    delete pool;
+
+    pool = new Executor(2, true);
+    pool->start();
+    tree.result = 0;
+    assert(pool->submit(&tree));
+    tree.join();
+    assert(tree.result == 17711);
+    delete pool;
+    return 0;
+}
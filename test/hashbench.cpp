@@ -0,0 +1,85 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare inserts and lookups of named pointers in the chained keyassoc
+// table with the open addressed keyhash table, one at a time and in bulk.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define KEYS        20000
+#define LOOKUPS     400000
+#define BULK        16
+
+static char *names[KEYS];
+static const char *order[LOOKUPS];
+
+extern "C" int main()
+{
+    keyassoc assoc(177, 0, 4096);
+    keyhash table;
+    void *found[BULK];
+    unsigned long hits = 0;
+    Timer::tick_t start;
+
+    srand(1);
+    for(unsigned pos = 0; pos < KEYS; ++pos) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "route.%08x.%u", (unsigned)rand(), pos);
+        names[pos] = strdup(buf);
+    }
+    for(unsigned pos = 0; pos < LOOKUPS; ++pos)
+        order[pos] = names[(unsigned)rand() % KEYS];
+
+    start = Timer::ticks();
+    for(unsigned pos = 0; pos < KEYS; ++pos)
+        assoc.create(names[pos], names[pos]);
+    report("keyassoc create", elapsed(start), KEYS);
+
+    start = Timer::ticks();
+    for(unsigned pos = 0; pos < KEYS; ++pos)
+        table.create(names[pos], names[pos]);
+    report("keyhash create", elapsed(start), KEYS);
+
+    start = Timer::ticks();
+    for(unsigned pos = 0; pos < LOOKUPS; ++pos)
+        hits += (assoc.locate(order[pos]) != NULL);
+    report("keyassoc locate", elapsed(start), LOOKUPS);
+
+    start = Timer::ticks();
+    for(unsigned pos = 0; pos < LOOKUPS; ++pos)
+        hits += (table.locate(order[pos]) != NULL);
+    report("keyhash locate", elapsed(start), LOOKUPS);
+
+    start = Timer::ticks();
+    for(unsigned pos = 0; pos < LOOKUPS; pos += BULK)
+        hits += table.locate(&order[pos], found, BULK);
+    report("keyhash bulk locate", elapsed(start), LOOKUPS);
+
+    if(hits != 3ul * LOOKUPS)
+        printf("lookups missed: %lu\n", 3ul * LOOKUPS - hits);
+
+    for(unsigned pos = 0; pos < KEYS; ++pos)
+        free(names[pos]);
+    return 0;
+}
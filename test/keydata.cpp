@@ -22,9 +22,29 @@
 #include <ucommon/ucommon.h>
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 using namespace ucommon;
 
+#include "readers.h"
+
+static void write(const char *path, const char *text)
+{
+    FILE *fp = fopen(path, "w");
+    assert(fp != NULL);
+    fputs(text, fp);
+    fclose(fp);
+}
+
+static void checkKeys(keyconfig *config)
+{
+    keyconfig::instance keys(*config);
+    keydata *section = keys->get("server");
+    assert(section != NULL);
+    assert(eq(section->get("port"), section->get("check")));
+}
+
 extern "C" int main()
 {
     keydata *keys;
@@ -40,5 +60,72 @@ extern "C" int main()
     keys = myfile["section2"];
     assert(keys != NULL);
     assert(eq_case(keys->get("key1"), "replaced value"));
+
+    char path[] = "/tmp/keydataXXXXXX";
+    int fd = mkstemp(path);
+    assert(fd > -1);
+    close(fd);
+
+    // many keys, continued lines, and no newline at the end
+    String text = "[Many]\n";
+    char buf[64];
+    for(unsigned pos = 0; pos < 2000; ++pos) {
+        snprintf(buf, sizeof(buf), "key%u = \"value %u\"\n", pos, pos);
+        text += buf;
+    }
+    text += "long = first \\\n  second\\\r\n third\n[other]\nlast = end";
+    write(path, text);
+
+    keyfile many(path);
+    assert(many.err() == 0);
+    keys = many["many"];
+    assert(keys != NULL);
+    for(unsigned pos = 0; pos < 2000; ++pos) {
+        snprintf(buf, sizeof(buf), "KEY%u", pos);
+        const char *value = keys->get(buf);
+        assert(value != NULL);
+        snprintf(buf, sizeof(buf), "value %u", pos);
+        assert(eq(value, buf));
+    }
+    assert(eq(keys->get("long"), "first   second third"));
+    assert(eq(many["other"]->get("last"), "end"));
+    keys->set("key7", "changed");
+    keys->clear("key8");
+    assert(eq(keys->get("key7"), "changed"));
+    assert(keys->get("key8") == NULL);
+    unsigned count = 0;
+    for(keydata::iterator kv = keys->begin(); is(kv); kv.next())
+        ++count;
+    assert(count == 2000);
+
+    // overlay another file, which replaces keys of existing sections
+    many.load("keydata.conf");
+    assert(eq(many["section2"]->get("key1"), "replaced value"));
+    assert(eq(many["many"]->get("key9"), "value 9"));
+
+    // replace a shared config while threads read it
+    write(path, "[server]\nport = 0\ncheck = 0\n");
+    keyconfig config(path);
+    assert(config.err() == 0);
+    volatile bool done = false;
+    readThread<keyconfig> *readers[3];
+    for(unsigned pos = 0; pos < 3; ++pos) {
+        readers[pos] = new readThread<keyconfig>(&config, &checkKeys, &done);
+        readers[pos]->start();
+    }
+    for(unsigned pos = 1; pos <= 50; ++pos) {
+        snprintf(buf, sizeof(buf), "[server]\nport = %u\ncheck = %u\n", pos, pos);
+        write(path, buf);
+        assert(config.reload());
+    }
+    done = true;
+    for(unsigned pos = 0; pos < 3; ++pos)
+        delete readers[pos];
+
+    remove(path);
+    assert(!config.reload());
+    assert(config.err() != 0);
+    keyconfig::instance current(config);
+    assert(eq(current->get("server")->get("port"), "50"));
     return 0;
 }
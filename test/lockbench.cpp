@@ -0,0 +1,167 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare the library locking classes, which may be built on futexes,
+// with the same semaphore logic built directly on pthread mutex and cond,
+// both uncontended and for thread to thread handoff latency.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define OPERATIONS  2000000
+#define HANDOFFS    50000
+
+class pthread_semaphore
+{
+private:
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned count, waits, used;
+
+public:
+    pthread_semaphore(unsigned limit, unsigned avail) {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&cond, NULL);
+        count = limit;
+        used = limit - avail;
+        waits = 0;
+    }
+
+    ~pthread_semaphore() {
+        pthread_cond_destroy(&cond);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void wait(void) {
+        pthread_mutex_lock(&mutex);
+        while(used >= count) {
+            ++waits;
+            pthread_cond_wait(&cond, &mutex);
+            --waits;
+        }
+        ++used;
+        pthread_mutex_unlock(&mutex);
+    }
+
+    void release(void) {
+        pthread_mutex_lock(&mutex);
+        if(used)
+            --used;
+        if(waits)
+            pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+};
+
+template<class T>
+class pingpong : public JoinableThread
+{
+private:
+    T *ping, *pong;
+
+public:
+    pingpong(T *in, T *out) : JoinableThread() {ping = in; pong = out;}
+
+    ~pingpong() {join();}
+
+    void run(void) {
+        for(unsigned count = 0; count < HANDOFFS; ++count) {
+            ping->wait();
+            pong->release();
+        }
+    }
+};
+
+template<class T>
+static double uncontended(T *sem)
+{
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned count = 0; count < OPERATIONS; ++count) {
+        sem->wait();
+        sem->release();
+    }
+    return elapsed(start);
+}
+
+template<class T>
+static double handoff(T *ping, T *pong)
+{
+    Timer::tick_t start = Timer::ticks();
+    pingpong<T> *thread = new pingpong<T>(ping, pong);
+
+    thread->start();
+    for(unsigned count = 0; count < HANDOFFS; ++count) {
+        ping->release();
+        pong->wait();
+    }
+    delete thread;
+    return elapsed(start);
+}
+
+static double mutexes(void)
+{
+    Mutex lock;
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned count = 0; count < OPERATIONS; ++count) {
+        lock.acquire();
+        lock.release();
+    }
+    return elapsed(start);
+}
+
+static double pthread_mutexes(void)
+{
+    pthread_mutex_t lock;
+    Timer::tick_t start = Timer::ticks();
+
+    pthread_mutex_init(&lock, NULL);
+    for(unsigned count = 0; count < OPERATIONS; ++count) {
+        pthread_mutex_lock(&lock);
+        pthread_mutex_unlock(&lock);
+    }
+    pthread_mutex_destroy(&lock);
+    return elapsed(start);
+}
+
+extern "C" int main()
+{
+    Semaphore sem(1), ping(1, 0), pong(1, 0);
+    pthread_semaphore psem(1, 1), pping(1, 0), ppong(1, 0);
+
+#ifdef  _FUTEX_
+    printf("library locking: futex\n");
+#else
+    printf("library locking: pthread\n");
+#endif
+
+    // handoffs run first since glibc skips atomics until a thread exists
+    report("semaphore handoff", handoff(&ping, &pong), HANDOFFS);
+    report("pthread handoff", handoff(&pping, &ppong), HANDOFFS);
+    report("mutex", mutexes(), OPERATIONS);
+    report("pthread mutex", pthread_mutexes(), OPERATIONS);
+    report("semaphore", uncontended(&sem), OPERATIONS);
+    report("pthread semaphore", uncontended(&psem), OPERATIONS);
+    return 0;
+}
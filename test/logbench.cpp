@@ -0,0 +1,104 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare application log messages per second written directly under the
+// log mutex and through asynchronous logging, for 1 to 32 logging threads.
+// times include writing every message out to the log file.  The thread
+// queue spooler is not measured since its thread cannot be stopped.
+
+#include <ucommon/ucommon.h>
+#include <commoncpp/commoncpp.h>
+#include <commoncpp/applog.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+
+#define MESSAGES    192000
+#define LOGFILE     "ucommon-logbench.log"
+
+static ost::AppLog *applog;
+static ucommon::barrier *gate;
+
+class worker : public ost::Thread
+{
+private:
+    unsigned count;
+
+public:
+    worker(unsigned messages) : ost::Thread() {count = messages;}
+
+    void run(void) {
+        applog->subscribe();
+        gate->wait();
+        for(unsigned pos = 0; pos < count; ++pos)
+            applog->info("worker message %u of %u\n", pos, count);
+        applog->unsubscribe();
+    }
+};
+
+static void bench(const char *id, unsigned threads, int mode)
+{
+    worker *workers[32];
+    unsigned long dropped = 0;
+    ucommon::Timer::tick_t start;
+    double ms;
+
+    ucommon::fsys::erase(LOGFILE);
+    applog = new ost::AppLog(LOGFILE, mode == 0);
+    if(mode == 1)
+        applog->asyncEnable(65536, ost::AppLog::overflowBlock);
+    else if(mode == 2)
+        applog->asyncEnable(65536, ost::AppLog::overflowDrop);
+
+    gate = new ucommon::barrier(threads + 1);
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        workers[pos] = new worker(MESSAGES / threads);
+        workers[pos]->start();
+    }
+
+    gate->wait();
+    start = ucommon::Timer::ticks();
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        workers[pos]->join();
+        delete workers[pos];
+    }
+    dropped = applog->dropped();
+    delete applog;
+    ms = elapsed(start);
+    delete gate;
+
+    printf("%-12s %2u threads %8.1f ms, %10.0f msgs/sec", id, threads,
+        ms, MESSAGES / (ms / 1000.0));
+    if(mode == 2)
+        printf(", %lu dropped", dropped);
+    printf("\n");
+}
+
+extern "C" int main()
+{
+    static const unsigned counts[] = {1, 2, 4, 8, 16, 32};
+    static const char *modes[] = {"direct", "async block", "async drop"};
+
+    for(int mode = 0; mode < 3; ++mode) {
+        for(unsigned pos = 0; pos < sizeof(counts) / sizeof(unsigned); ++pos)
+            bench(modes[mode], counts[pos], mode);
+    }
+    ucommon::fsys::erase(LOGFILE);
+    return 0;
+}
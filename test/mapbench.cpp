@@ -0,0 +1,179 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare map table lookups per second for a locked and a concurrent
+// table, for 1 to 16 looking up threads, while another thread keeps
+// adding and removing objects.  The concurrent table starts small and
+// grows as the sessions are added.  Every lookup of a session that is
+// always mapped must find it, whatever case it is asked for in.
+
+#include <ucommon/ucommon.h>
+#include <commoncpp/commoncpp.h>
+#include <commoncpp/object.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include "bench.h"
+
+#define SESSIONS    4096
+#define CHURN       256
+#define LOOKUPS     1600000
+
+class session : public ost::MapObject
+{
+public:
+    char name[32];
+
+    session(unsigned id) : ost::MapObject(name)
+        {snprintf(name, sizeof(name), "Session-%08x", id * 2654435761u);}
+};
+
+static ost::MapTable *table;
+static session *sessions[SESSIONS];
+static session *churn[CHURN];
+static ucommon::barrier *gate;
+static volatile bool updating;
+static unsigned long missed;
+
+class reader : public ost::Thread
+{
+private:
+    unsigned count, seed;
+
+public:
+    reader(unsigned lookups, unsigned id) : ost::Thread()
+        {count = lookups; seed = id;}
+
+    void run(void) {
+        char key[32];
+        unsigned long miss = 0;
+
+        gate->wait();
+        for(unsigned pos = 0; pos < count; ++pos) {
+            seed = seed * 1103515245u + 12345u;
+            session *s = sessions[(seed >> 8) % SESSIONS];
+            if(seed & 0x10000) {
+                for(unsigned i = 0; i < sizeof(key); ++i)
+                    if(!(key[i] = (char)toupper((unsigned char)s->name[i])))
+                        break;
+                if(table->getObject(key) != s)
+                    ++miss;
+            }
+            else if(table->getObject(s->name) != s)
+                ++miss;
+        }
+        if(miss) {
+            ucommon::Mutex::protect(&missed);
+            missed += miss;
+            ucommon::Mutex::release(&missed);
+        }
+    }
+};
+
+class writer : public ost::Thread
+{
+public:
+    unsigned long changes;
+
+    writer() : ost::Thread() {changes = 0;}
+
+    void run(void) {
+        unsigned pos = 0;
+
+        gate->wait();
+        while(updating) {
+            session *s = churn[pos++ % CHURN];
+            table->addObject(*s);
+            s->detach();
+            ++changes;
+        }
+    }
+};
+
+static void bench(const char *id, unsigned threads, bool concurrent)
+{
+    reader *readers[16];
+    writer *update;
+    ucommon::Timer::tick_t start;
+    double ms;
+
+    if(concurrent)
+        table = new ost::MapTable(16, true);
+    else
+        table = new ost::MapTable(SESSIONS);
+
+    for(unsigned pos = 0; pos < SESSIONS; ++pos)
+        table->addObject(*sessions[pos]);
+
+    missed = 0;
+    updating = true;
+    gate = new ucommon::barrier(threads + 2);
+    update = new writer();
+    update->start();
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        readers[pos] = new reader(LOOKUPS / threads, pos + 1);
+        readers[pos]->start();
+    }
+
+    gate->wait();
+    start = ucommon::Timer::ticks();
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        readers[pos]->join();
+        delete readers[pos];
+    }
+    ms = elapsed(start);
+    updating = false;
+    update->join();
+
+    printf("%-12s %2u threads %8.1f ms, %10.0f lookups/sec, %8lu changes, %u slots\n",
+        id, threads, ms, LOOKUPS / (ms / 1000.0), update->changes,
+        table->getRange());
+
+    if(missed) {
+        fprintf(stderr, "*** %s: %lu lookups missed\n", id, missed);
+        exit(1);
+    }
+
+    for(unsigned pos = 0; pos < SESSIONS; ++pos)
+        sessions[pos]->detach();
+    delete update;
+    delete gate;
+    delete table;
+}
+
+extern "C" int main()
+{
+    static const unsigned counts[] = {1, 2, 4, 8, 16};
+
+    for(unsigned pos = 0; pos < SESSIONS; ++pos)
+        sessions[pos] = new session(pos);
+    for(unsigned pos = 0; pos < CHURN; ++pos)
+        churn[pos] = new session(SESSIONS + pos);
+
+    for(unsigned pos = 0; pos < sizeof(counts) / sizeof(unsigned); ++pos)
+        bench("locked", counts[pos], false);
+    for(unsigned pos = 0; pos < sizeof(counts) / sizeof(unsigned); ++pos)
+        bench("concurrent", counts[pos], true);
+
+    for(unsigned pos = 0; pos < SESSIONS; ++pos)
+        delete sessions[pos];
+    for(unsigned pos = 0; pos < CHURN; ++pos)
+        delete churn[pos];
+    return 0;
+}
@@ -0,0 +1,195 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <ucommon-config.h>
+#include <ucommon/ucommon.h>
+#include <commoncpp/commoncpp.h>
+#include <commoncpp/object.h>
+
+#include <stdio.h>
+#include <ctype.h>
+
+#define STABLE      64
+#define GROWN       1024
+#define CHURN       32
+#define READERS     4
+
+class session : public ost::MapObject
+{
+public:
+    char name[32];
+
+    session(unsigned id) : ost::MapObject(name)
+        {snprintf(name, sizeof(name), "Session-%08x", id * 2654435761u);}
+};
+
+static ost::MapTable *table;
+static session *stable[STABLE];
+static session *grown[GROWN];
+static session *churn[CHURN];
+static ucommon::barrier *gate;
+static volatile bool updating = true;
+
+// stable sessions must always be found, whatever case they are asked for
+// in, and sessions that come and go are either found or not there...
+class reader : public ost::Thread
+{
+private:
+    unsigned seed;
+
+public:
+    unsigned long lookups;
+
+    reader(unsigned id) : ost::Thread() {seed = id; lookups = 0;}
+
+    void run(void) {
+        char key[32];
+        session *s;
+
+        gate->wait();
+        while(updating) {
+            seed = seed * 1103515245u + 12345u;
+            s = stable[(seed >> 8) % STABLE];
+            for(unsigned pos = 0; pos < sizeof(key); ++pos)
+                if(!(key[pos] = (char)toupper((unsigned char)s->name[pos])))
+                    break;
+            assert(table->getObject(key) == s);
+            assert(table->getObject(s->name) == s);
+
+            s = grown[(seed >> 8) % GROWN];
+            void *obj = table->getObject(s->name);
+            assert(obj == NULL || obj == s);
+
+            s = churn[(seed >> 8) % CHURN];
+            obj = table->getObject(s->name);
+            assert(obj == NULL || obj == s);
+            ++lookups;
+        }
+    }
+};
+
+// adds enough sessions to double the slots many times while lookups
+// are walking them, and then removes them all again...
+class grower : public ost::Thread
+{
+public:
+    grower() : ost::Thread() {}
+
+    void run(void) {
+        gate->wait();
+        for(unsigned pos = 0; pos < GROWN; ++pos) {
+            table->addObject(*grown[pos]);
+            if(!(pos % 64))
+                ost::Thread::yield();
+        }
+        for(unsigned pos = 0; pos < GROWN; ++pos) {
+            grown[pos]->detach();
+            if(!(pos % 64))
+                ost::Thread::yield();
+        }
+    }
+};
+
+class churner : public ost::Thread
+{
+public:
+    churner() : ost::Thread() {}
+
+    void run(void) {
+        unsigned pos = 0;
+
+        gate->wait();
+        while(updating) {
+            session *s = churn[pos++ % CHURN];
+            table->addObject(*s);
+            s->detach();
+        }
+    }
+};
+
+extern "C" int main()
+{
+    reader *readers[READERS];
+    grower *grow;
+    churner *change;
+    unsigned range;
+
+    for(unsigned pos = 0; pos < STABLE; ++pos)
+        stable[pos] = new session(pos);
+    for(unsigned pos = 0; pos < GROWN; ++pos)
+        grown[pos] = new session(STABLE + pos);
+    for(unsigned pos = 0; pos < CHURN; ++pos)
+        churn[pos] = new session(STABLE + GROWN + pos);
+
+    table = new ost::MapTable(4, true);
+    assert(table->isConcurrent());
+    for(unsigned pos = 0; pos < STABLE; ++pos)
+        table->addObject(*stable[pos]);
+    assert(table->getSize() == STABLE);
+    range = table->getRange();
+
+    gate = new ucommon::barrier(READERS + 3);
+    grow = new grower();
+    change = new churner();
+    grow->start();
+    change->start();
+    for(unsigned pos = 0; pos < READERS; ++pos) {
+        readers[pos] = new reader(pos + 1);
+        readers[pos]->start();
+    }
+
+    gate->wait();
+    grow->join();
+    updating = false;
+    change->join();
+    for(unsigned pos = 0; pos < READERS; ++pos) {
+        readers[pos]->join();
+        assert(readers[pos]->lookups > 0);
+        delete readers[pos];
+    }
+
+    // the slots grew while lookups ran, and only stable sessions are left
+    assert(table->getRange() >= range * 32);
+    assert(table->getSize() == STABLE);
+    for(unsigned pos = 0; pos < STABLE; ++pos)
+        assert(table->getObject(stable[pos]->name) == stable[pos]);
+    for(unsigned pos = 0; pos < GROWN; ++pos)
+        assert(table->getObject(grown[pos]->name) == NULL);
+    for(unsigned pos = 0; pos < CHURN; ++pos)
+        assert(table->getObject(churn[pos]->name) == NULL);
+
+    for(unsigned pos = 0; pos < STABLE; ++pos)
+        stable[pos]->detach();
+    assert(table->getSize() == 0);
+
+    delete grow;
+    delete change;
+    delete gate;
+    delete table;
+
+    for(unsigned pos = 0; pos < STABLE; ++pos)
+        delete stable[pos];
+    for(unsigned pos = 0; pos < GROWN; ++pos)
+        delete grown[pos];
+    for(unsigned pos = 0; pos < CHURN; ++pos)
+        delete churn[pos];
+    return 0;
+}
@@ -25,10 +25,38 @@
 
 using namespace ucommon;
 
+static mempager mypager(4096);
+
+class churn : public JoinableThread
+{
+public:
+    churn() : JoinableThread() {}
+
+    ~churn() {join();}
+
+    void run(void) {
+        void *mem[64];
+        for(unsigned loop = 0; loop < 1000; ++loop) {
+            for(unsigned pos = 0; pos < 64; ++pos) {
+                mem[pos] = mypager.alloc(24 + (pos % 4) * 40);
+                memset(mem[pos], (int)pos, 24);
+            }
+            for(unsigned pos = 0; pos < 64; ++pos) {
+                assert(*((char *)mem[pos]) == (char)pos);
+                mypager.dealloc(mem[pos]);
+            }
+        }
+    }
+};
+
 extern "C" int main()
 {
     stringlist_t mylist;
     stringlistitem_t *item;
+    keyhash table;
+    hashof<unsigned> typed(100);
+    unsigned values[4000];
+    char name[32];
 
     mylist.add("100");
     mylist.add("050");
@@ -52,5 +80,75 @@ extern "C" int main()
     assert(eq(list[1], "300"));
 
     assert(list[2] == NULL);
+
+    // small blocks are reused once dealloc'd...
+    void *first = mypager.alloc(40);
+    void *second = mypager.alloc(40);
+    assert(first != second);
+    mypager.dealloc(first);
+    assert(mypager.alloc(33) == first);
+    assert(mypager.utilization() > 0);
+
+    churn *t1 = new churn();
+    churn *t2 = new churn();
+    t1->start();
+    t2->start();
+    delete t1;
+    delete t2;
+    assert(mypager.pages() < 16);
+
+    // large requests are still carved from pages...
+    char *big = (char *)mypager.alloc(2048);
+    mypager.dealloc(big);
+    mypager.purge();
+    assert(mypager.pages() == 0);
+    assert(mypager.utilization() == 0);
+
+    // open addressed hash table, checked while it grows and rehashes...
+    for(unsigned pos = 0; pos < 4000; ++pos) {
+        values[pos] = pos;
+        snprintf(name, sizeof(name), "key%u", pos);
+        assert(table.create(name, &values[pos]));
+        assert(table.locate(name) == &values[pos]);
+        if(pos % 97 == 0) {
+            for(unsigned prior = 0; prior <= pos; prior += 13) {
+                snprintf(name, sizeof(name), "key%u", prior);
+                assert(table.locate(name) == &values[prior]);
+            }
+        }
+    }
+    assert(table.count() == 4000);
+    assert(!table.create("key17", &values[0]));
+    assert(table.locate("missing") == NULL);
+    for(unsigned pos = 0; pos < 4000; pos += 2) {
+        snprintf(name, sizeof(name), "key%u", pos);
+        assert(table.remove(name) == &values[pos]);
+    }
+    assert(table.count() == 2000);
+    assert(table.remove("key0") == NULL);
+    for(unsigned pos = 0; pos < 4000; ++pos) {
+        snprintf(name, sizeof(name), "key%u", pos);
+        assert(table.locate(name) == ((pos & 1) ? &values[pos] : NULL));
+    }
+    table.assign("key1", &values[2]);
+    assert(table("key1") == &values[2]);
+
+    const char *names[3] = {"key1", "key2", "key3"};
+    void *found[3];
+    assert(table.locate(names, found, 3) == 2);
+    assert(found[0] == &values[2] && found[1] == NULL && found[2] == &values[3]);
+
+    uint32_t address = 0x7f000001;
+    assert(table.create(&address, sizeof(address), &values[5]));
+    assert(table.locate(&address, sizeof(address)) == &values[5]);
+    assert(keyhash::hash("abc", 3) != keyhash::hash("abd", 3));
+    table.purge();
+    assert(table.count() == 0);
+    assert(table.locate("key1") == NULL);
+
+    assert(typed.create("one", &values[1]));
+    assert(*typed["one"] == 1);
+    assert(typed.remove("one") == &values[1]);
+    assert(typed.count() == 0);
     return 0;
 }
@@ -0,0 +1,88 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// measure contention when many threads allocate small objects from one
+// shared mempager.  A 12k page size is not a power of two, so that pager
+// carves every request under its mutex, while the 16k pager uses size
+// class slabs with per thread caches.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define ITEMS   200000
+#define BATCH   64
+
+class worker : public JoinableThread
+{
+public:
+    mempager *pager;
+
+    worker(mempager *p) : JoinableThread() {pager = p;}
+
+    ~worker() {join();}
+
+    void run(void) {
+        void *mem[BATCH];
+        for(unsigned loop = 0; loop < ITEMS / BATCH; ++loop) {
+            for(unsigned pos = 0; pos < BATCH; ++pos)
+                mem[pos] = pager->alloc(16 + (pos % 8) * 8);
+            for(unsigned pos = 0; pos < BATCH; ++pos)
+                pager->dealloc(mem[pos]);
+        }
+    }
+};
+
+static double bench(mempager *pager, unsigned count)
+{
+    worker **threads = new worker*[count];
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned pos = 0; pos < count; ++pos) {
+        threads[pos] = new worker(pager);
+        threads[pos]->start();
+    }
+
+    for(unsigned pos = 0; pos < count; ++pos)
+        delete threads[pos];
+
+    delete[] threads;
+    return elapsed(start);
+}
+
+extern "C" int main(int argc, char **argv)
+{
+    unsigned limit = 16;
+
+    if(argc > 1)
+        limit = atoi(argv[1]);
+
+    for(unsigned count = 1; count <= limit; count *= 2) {
+        mempager carved(12288), slabbed(16384);
+        double ct = bench(&carved, count);
+        double st = bench(&slabbed, count);
+
+        printf("%2u threads: carved %8.1f ms %4u pages %3u%%, slabs %8.1f ms %4u pages\n",
+            count, ct, carved.pages(), carved.utilization(), st, slabbed.pages());
+    }
+    return 0;
+}
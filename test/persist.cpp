@@ -0,0 +1,199 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+
+#if defined(OLD_STDCPP) || defined(NEW_STDCPP)
+#include <sstream>
+#include <unistd.h>
+
+using namespace ucommon;
+
+class testNode : public PersistObject
+{
+public:
+    int32_t number;
+    double real;
+    std::string name;
+    std::vector<uint16_t> values;
+    testNode *next, *other;
+
+    testNode() : PersistObject()
+        {number = 0; real = 0.0; next = other = NULL;}
+
+    bool write(PersistEngine& archive) const {
+        archive << number << real << name << values;
+        archive << (PersistObject *)next << (PersistObject *)other;
+        return true;
+    }
+
+    bool read(PersistEngine& archive) {
+        archive >> number >> real >> name >> values;
+        archive >> next >> other;
+        return true;
+    }
+
+    DECLARE_PERSISTENCE(testNode)
+};
+
+IMPLEMENT_PERSISTENCE(testNode, "ucommon::testNode")
+
+// a list of nodes, each also referring back to the first...
+static testNode *create(unsigned count)
+{
+    testNode *first = NULL, *last = NULL;
+
+    for(unsigned pos = 0; pos < count; ++pos) {
+        testNode *node = new testNode;
+        node->number = (int32_t)pos * 3;
+        node->real = pos / 4.0;
+        node->name = (pos % 2) ? "odd" : std::string("even\0text", 9);
+        node->values.assign(pos % 5, (uint16_t)pos);
+        node->other = first;
+        if(last)
+            last->next = node;
+        else
+            first = node;
+        last = node;
+    }
+    return first;
+}
+
+static bool compare(testNode *from, testNode *to)
+{
+    testNode *first = to;
+
+    while(from && to) {
+        if(from->number != to->number || from->real != to->real)
+            return false;
+        if(from->name != to->name || from->values != to->values)
+            return false;
+        if((from->other == NULL) != (to->other == NULL))
+            return false;
+        if(to->other && to->other != first)
+            return false;
+        from = from->next;
+        to = to->next;
+    }
+    return from == NULL && to == NULL;
+}
+
+static void destroy(testNode *node)
+{
+    while(node) {
+        testNode *next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+extern "C" int main()
+{
+    testNode *list = create(500), *copy;
+    std::string text;
+
+    // an archive is the same written to a stream and into memory
+    std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+    {
+        PersistEngine archive(stream, PersistEngine::modeWrite);
+        archive << *list;
+        assert(stream.str().size() > 0);
+        archive << (uint32_t)12345;
+        archive << text;
+    }
+    PersistEngine memory;
+    memory << *list;
+    memory << (uint32_t)12345;
+    memory << text;
+    assert(stream.str().size() == memory.getSize());
+    assert(!memcmp(stream.str().data(), memory.getData(), memory.getSize()));
+
+    uint32_t tail = 0;
+    copy = NULL;
+    {
+        PersistEngine archive(stream, PersistEngine::modeRead);
+        archive >> copy;
+        archive >> tail;
+        archive >> text;
+    }
+    assert(tail == 12345);
+    assert(compare(list, copy));
+    destroy(copy);
+
+    copy = NULL;
+    tail = 0;
+    PersistEngine input(memory.getData(), memory.getSize());
+    input >> copy;
+    input >> tail;
+    input >> text;
+    assert(tail == 12345);
+    assert(compare(list, copy));
+    destroy(copy);
+
+    // reading past the end of an archive in memory is an error
+    bool failed = false;
+    try {
+        input >> tail;
+    }
+    catch(PersistException& e) {
+        failed = true;
+    }
+    assert(failed);
+
+    char path[] = "/tmp/ucommonPersistXXXXXX";
+    int fd = mkstemp(path);
+    assert(fd > -1);
+    FILE *fp = fdopen(fd, "wb");
+    fwrite(memory.getData(), memory.getSize(), 1, fp);
+    fclose(fp);
+
+    copy = NULL;
+    {
+        PersistEngine archive(path);
+        archive >> copy;
+    }
+    assert(compare(list, copy));
+    destroy(copy);
+    remove(path);
+
+    failed = false;
+    try {
+        PersistEngine archive(path);
+    }
+    catch(PersistException& e) {
+        failed = true;
+    }
+    assert(failed);
+
+    destroy(list);
+    return 0;
+}
+
+#else
+
+extern "C" int main()
+{
+    return 0;
+}
+
+#endif
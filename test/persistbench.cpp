@@ -0,0 +1,179 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// round trip of a large object graph thru a stream, thru memory, and
+// from a mapped archive file.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+
+#if defined(OLD_STDCPP) || defined(NEW_STDCPP)
+#include <sstream>
+#include <unistd.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define DEPTH       17
+#define PASSES      5
+
+class benchNode : public PersistObject
+{
+public:
+    int32_t id;
+    uint16_t flags;
+    double weight;
+    std::string label;
+    benchNode *left, *right, *parent;
+
+    benchNode() : PersistObject()
+        {id = 0; flags = 0; weight = 0.0; left = right = parent = NULL;}
+
+    bool write(PersistEngine& archive) const {
+        archive << id << flags << weight << label;
+        archive << (PersistObject *)left << (PersistObject *)right;
+        archive << (PersistObject *)parent;
+        return true;
+    }
+
+    bool read(PersistEngine& archive) {
+        archive >> id >> flags >> weight >> label;
+        archive >> left >> right >> parent;
+        return true;
+    }
+
+    DECLARE_PERSISTENCE(benchNode)
+};
+
+IMPLEMENT_PERSISTENCE(benchNode, "ucommon::benchNode")
+
+static unsigned long nodes = 0;
+
+static benchNode *create(unsigned depth, benchNode *parent)
+{
+    if(!depth)
+        return NULL;
+
+    char label[32];
+    benchNode *node = new benchNode;
+    node->id = (int32_t)nodes++;
+    node->flags = (uint16_t)(depth * 7);
+    node->weight = node->id / 3.0;
+    snprintf(label, sizeof(label), "node %d", node->id);
+    node->label = label;
+    node->parent = parent;
+    node->left = create(depth - 1, node);
+    node->right = create(depth - 1, node);
+    return node;
+}
+
+static void destroy(benchNode *node)
+{
+    if(!node)
+        return;
+    destroy(node->left);
+    destroy(node->right);
+    delete node;
+}
+
+static void throughput(const char *id, double ms, size_t size)
+{
+    double mb = (double)size * PASSES / (1024.0 * 1024.0);
+
+    printf("%-12s %8.1f ms, %8.1f MB/s, %8.0f objects/ms\n", id, ms,
+        mb / (ms / 1000.0), (double)nodes * PASSES / ms);
+}
+
+extern "C" int main()
+{
+    benchNode *root = create(DEPTH, NULL), *copy;
+    std::string archive;
+    size_t size = 0;
+    Timer::tick_t start;
+
+    start = Timer::ticks();
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+        PersistEngine engine(stream, PersistEngine::modeWrite);
+        engine << *root;
+        engine.flush();
+        archive = stream.str();
+    }
+    size = archive.size();
+    printf("%lu objects, archive %lu bytes\n", nodes, (unsigned long)size);
+    throughput("stream write", elapsed(start), size);
+
+    start = Timer::ticks();
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        std::stringstream stream(archive, std::ios::in | std::ios::out | std::ios::binary);
+        PersistEngine engine(stream, PersistEngine::modeRead);
+        copy = NULL;
+        engine >> copy;
+        destroy(copy);
+    }
+    throughput("stream read", elapsed(start), size);
+
+    start = Timer::ticks();
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        PersistEngine engine;
+        engine << *root;
+        if(engine.getSize() != size)
+            return 1;
+    }
+    throughput("memory write", elapsed(start), size);
+
+    start = Timer::ticks();
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        PersistEngine engine(archive.data(), archive.size());
+        copy = NULL;
+        engine >> copy;
+        destroy(copy);
+    }
+    throughput("memory read", elapsed(start), size);
+
+    char path[] = "/tmp/persistbenchXXXXXX";
+    int fd = mkstemp(path);
+    if(fd < 0)
+        return 1;
+    FILE *fp = fdopen(fd, "wb");
+    fwrite(archive.data(), size, 1, fp);
+    fclose(fp);
+
+    start = Timer::ticks();
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        PersistEngine engine(path);
+        copy = NULL;
+        engine >> copy;
+        destroy(copy);
+    }
+    throughput("mapped read", elapsed(start), size);
+    remove(path);
+
+    destroy(root);
+    return 0;
+}
+
+#else
+
+extern "C" int main()
+{
+    return 0;
+}
+
+#endif
@@ -39,6 +39,43 @@ public:
 static mempager pool;
 static paged_reuse<myobject> myobjects(&pool, 100);
 static queueof<myobject> mycache(&pool, 10);
+static ringof<unsigned> myring(100);
+static unsigned long consumed = 0;
+
+class producer : public JoinableThread
+{
+public:
+    unsigned base;
+
+    producer(unsigned b) : JoinableThread() {base = b;}
+
+    ~producer() {join();}
+
+    void run(void) {
+        for(unsigned i = 1; i <= 1000; ++i) {
+            unsigned value = base + i;
+            myring.put(&value);
+        }
+    }
+};
+
+class consumer : public JoinableThread
+{
+public:
+    unsigned long total;
+
+    consumer() : JoinableThread() {total = 0;}
+
+    ~consumer() {join(); consumed += total;}
+
+    void run(void) {
+        unsigned value;
+        for(unsigned i = 0; i < 1000; ++i) {
+            myring.get(&value);
+            total += value;
+        }
+    }
+};
 
 extern "C" int main()
 {
@@ -69,6 +106,39 @@ extern "C" int main()
     x = init<myobject>(NULL);
     assert(x == NULL);
     assert(reused == 11);
+
+    // ring is rounded to a power of two and is fifo...
+    unsigned value;
+    assert(myring.size() == 128);
+    assert(!myring);
+    for(i = 0; i < 128; ++i)
+        myring << i;
+    assert(myring.count() == 128);
+    assert(!myring.put(&i, 10));
+    myring >> value;
+    assert(value == 0);
+    assert(myring.put(&i, 0));
+    for(i = 1; i < 129; ++i) {
+        assert(myring.get(&value, 0));
+        assert(value == i);
+    }
+    assert(!myring.get(&value, 10));
+
+    // multiple producers and consumers...
+    producer *p1 = new producer(0);
+    producer *p2 = new producer(1000);
+    consumer *c1 = new consumer();
+    consumer *c2 = new consumer();
+    c1->start();
+    c2->start();
+    p1->start();
+    p2->start();
+    delete p1;
+    delete p2;
+    delete c1;
+    delete c2;
+    assert(!myring);
+    assert(consumed == 2001000l);
     return 0;
 }
 
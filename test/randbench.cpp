@@ -0,0 +1,81 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare Random::fill with reading /dev/urandom for each request, for
+// small tokens and for large blocks.
+
+#include <ucommon/ucommon.h>
+#include <ucommon/secure.h>
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define TOKEN       16
+#define TOKENS      1000000l
+#define BLOCK       4096
+#define BLOCKS      (64l * 1024l * 1024l / BLOCK)
+
+static void urandom(unsigned char *buf, size_t size)
+{
+    int fd = open("/dev/urandom", O_RDONLY);
+
+    if(fd > -1) {
+        if(read(fd, buf, size) < 0)
+            buf[0] = 0;
+        close(fd);
+    }
+}
+
+static void throughput(const char *id, long count, size_t size, double ms)
+{
+    printf("%-16s %8.1f ms, %10.0f calls/sec, %8.1f MB/sec\n", id, ms,
+        count / (ms / 1000.0),
+        ((double)count * size / (1024.0 * 1024.0)) / (ms / 1000.0));
+}
+
+extern "C" int main()
+{
+    static unsigned char buf[BLOCK];
+    Timer::tick_t start;
+    long count;
+
+    start = Timer::ticks();
+    for(count = 0; count < TOKENS / 10; ++count)
+        urandom(buf, TOKEN);
+    throughput("urandom tokens", TOKENS / 10, TOKEN, elapsed(start));
+
+    start = Timer::ticks();
+    for(count = 0; count < TOKENS; ++count)
+        Random::fill(buf, TOKEN);
+    throughput("fill tokens", TOKENS, TOKEN, elapsed(start));
+
+    start = Timer::ticks();
+    for(count = 0; count < BLOCKS; ++count)
+        urandom(buf, BLOCK);
+    throughput("urandom blocks", BLOCKS, BLOCK, elapsed(start));
+
+    start = Timer::ticks();
+    for(count = 0; count < BLOCKS; ++count)
+        Random::fill(buf, BLOCK);
+    throughput("fill blocks", BLOCKS, BLOCK, elapsed(start));
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <ucommon-config.h>
+#include <ucommon/secure.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _MSWINDOWS_
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace ucommon;
+
+#define SAMPLE  (1024 * 1024)
+#define TOKEN   7
+
+static unsigned char thread_token[32];
+
+class worker : public JoinableThread
+{
+public:
+    ~worker() {join();}
+
+    void run(void) {
+        Random::fill(thread_token, sizeof(thread_token));
+    }
+};
+
+extern "C" int main()
+{
+    static unsigned char sample[SAMPLE];
+    unsigned char one[32], two[32], zero[32];
+    unsigned counts[256];
+    unsigned pos;
+
+    memset(zero, 0, sizeof(zero));
+    Random::fill(one, sizeof(one));
+    Random::fill(two, sizeof(two));
+    assert(memcmp(one, zero, sizeof(one)) != 0);
+    assert(memcmp(one, two, sizeof(one)) != 0);
+
+    // small odd sized fills cross every refill boundary
+    for(pos = 0; pos + TOKEN <= SAMPLE; pos += TOKEN)
+        Random::fill(sample + pos, TOKEN);
+    Random::fill(sample + pos, SAMPLE - pos);
+
+    memset(counts, 0, sizeof(counts));
+    for(pos = 0; pos < SAMPLE; ++pos)
+        ++counts[sample[pos]];
+    for(pos = 0; pos < 256; ++pos)
+        assert(counts[pos] > SAMPLE / 256 - 600 && counts[pos] < SAMPLE / 256 + 600);
+
+    // large fills are as even
+    Random::fill(sample, SAMPLE);
+    memset(counts, 0, sizeof(counts));
+    for(pos = 0; pos < SAMPLE; ++pos)
+        ++counts[sample[pos]];
+    for(pos = 0; pos < 256; ++pos)
+        assert(counts[pos] > SAMPLE / 256 - 600 && counts[pos] < SAMPLE / 256 + 600);
+
+    // another thread has its own generator
+    worker *thread = new worker();
+    thread->start();
+    Random::fill(one, sizeof(one));
+    delete thread;
+    assert(memcmp(thread_token, zero, sizeof(thread_token)) != 0);
+    assert(memcmp(thread_token, one, sizeof(one)) != 0);
+
+#ifndef _MSWINDOWS_
+    // a forked child must not repeat what its parent gets next
+    int fds[2], status;
+    assert(pipe(fds) == 0);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if(!pid) {
+        Random::fill(two, sizeof(two));
+        if(write(fds[1], two, sizeof(two)) != (ssize_t)sizeof(two))
+            _exit(1);
+        _exit(0);
+    }
+    Random::fill(one, sizeof(one));
+    assert(read(fds[0], two, sizeof(two)) == (ssize_t)sizeof(two));
+    waitpid(pid, &status, 0);
+    close(fds[0]);
+    close(fds[1]);
+    assert(memcmp(one, two, sizeof(one)) != 0);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+
+using namespace ucommon;
+
+static atomic::counter closed;
+
+class echo : public Reactor::handler
+{
+public:
+    echo(socket_t so) : Reactor::handler(so) {}
+
+    void input(void) {
+        char buf[256];
+        ssize_t len;
+
+        arm(500);
+        while((len = Socket::recvfrom(so, buf, sizeof(buf))) > 0)
+            Socket::sendto(so, buf, len);
+        if(len == 0)
+            detach();
+    }
+
+    void detached(void) {
+        Socket::release(so);
+        ++closed;
+        delete this;
+    }
+};
+
+class listener : public Reactor::handler
+{
+public:
+    listener(TCPServer& server) : Reactor::handler(server.handle()) {}
+
+    void input(void) {
+        socket_t client;
+
+        while((client = Socket::acceptfrom(so)) != INVALID_SOCKET)
+            reactor->attach(new echo(client));
+    }
+
+    Reactor *reactor;
+};
+
+extern "C" int main()
+{
+    char buf[64];
+
+    TCPServer server("127.0.0.1", "4455");
+    Reactor reactor(2, 50);
+    listener listen(server);
+
+    listen.reactor = &reactor;
+    assert(reactor.attach(&listen));
+    reactor.start();
+
+    Socket::address addr("127.0.0.1", "4455");
+    Socket client(AF_INET, SOCK_STREAM);
+    assert(client.connectto(addr.getList()) == 0);
+    assert(client.wait((timeout_t)2000) == 0);
+    assert(client.writes("hello\n") == 6);
+    assert(client.readline(buf, sizeof(buf)) == 6);
+    assert(eq(buf, "hello"));
+    assert(reactor.count() == 2);
+
+    // idle connection is expired by the reactor...
+    Thread::sleep(1000);
+    assert(reactor.count() == 1);
+    assert((long)closed == 1);
+
+    reactor.stop();
+    return 0;
+}
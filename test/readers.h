@@ -0,0 +1,46 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TEST_READERS_H_
+#define _TEST_READERS_H_
+
+// a thread that keeps checking a shared object until told to stop, used
+// to read shared pointers while they are being replaced.
+template <class T>
+class readThread : public JoinableThread
+{
+public:
+    typedef void (*check_t)(T *shared);
+
+private:
+    T *shared;
+    check_t check;
+    volatile bool *done;
+
+    void run(void) {
+        while(!*done)
+            check(shared);
+    };
+
+public:
+    readThread(T *pointer, check_t method, volatile bool *flag) : JoinableThread()
+        {shared = pointer; check = method; done = flag;}
+
+    ~readThread() {join();}
+};
+
+#endif
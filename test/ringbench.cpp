@@ -0,0 +1,109 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare the lock-free ring with the conditional based buffer when many
+// producer threads feed a single consumer.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define PRODUCERS   16
+#define ITEMS       100000
+
+static bufferof<unsigned long> *buffer;
+static ringof<unsigned long> *ring;
+
+class producer : public JoinableThread
+{
+public:
+    bool lockfree;
+
+    producer(bool mode) : JoinableThread() {lockfree = mode;}
+
+    ~producer() {join();}
+
+    void run(void) {
+        for(unsigned long i = 0; i < ITEMS; ++i) {
+            if(lockfree)
+                ring->put(&i);
+            else
+                buffer->put(&i);
+        }
+    }
+};
+
+static double bench(bool lockfree)
+{
+    producer *threads[PRODUCERS];
+    unsigned long total = 0, value;
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned pos = 0; pos < PRODUCERS; ++pos) {
+        threads[pos] = new producer(lockfree);
+        threads[pos]->start();
+    }
+
+    for(unsigned long count = 0; count < PRODUCERS * ITEMS; ++count) {
+        if(lockfree)
+            ring->get(&value);
+        else
+            buffer->copy(&value);
+        total += value;
+    }
+
+    for(unsigned pos = 0; pos < PRODUCERS; ++pos)
+        delete threads[pos];
+
+    if(total != (unsigned long)PRODUCERS * ((ITEMS * (ITEMS - 1l)) / 2)) {
+        fprintf(stderr, "*** lost items\n");
+        exit(-1);
+    }
+
+    return elapsed(start);
+}
+
+extern "C" int main(int argc, char **argv)
+{
+    unsigned size = 1024;
+    double buffered, lockfree;
+
+    if(argc > 1)
+        size = atoi(argv[1]);
+
+    buffer = new bufferof<unsigned long>(size);
+    ring = new ringof<unsigned long>(size);
+
+    buffered = bench(false);
+    lockfree = bench(true);
+
+    printf("%d producers, %d items each, %u slots%s\n",
+        PRODUCERS, ITEMS, size, atomic::simulated ? " (simulated atomics)" : "");
+    printf("buffer: %.1f ms, %.0f items/sec\n", buffered,
+        (PRODUCERS * ITEMS) / (buffered / 1000.0));
+    printf("ring:   %.1f ms, %.0f items/sec\n", lockfree,
+        (PRODUCERS * ITEMS) / (lockfree / 1000.0));
+
+    delete buffer;
+    delete ring;
+    return 0;
+}
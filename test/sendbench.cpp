@@ -0,0 +1,117 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare bulk transmit paths of TCPBuffer over loopback: copying through
+// the output buffer, gathered sends, file sends, and zero copy sends.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define CHUNK   (256 * 1024)
+#define TRANSFER (512l * 1024l * 1024l)
+
+static char chunk[CHUNK];
+
+class sink : public JoinableThread
+{
+private:
+    TCPServer *server;
+
+public:
+    sink(TCPServer *from) : JoinableThread() {server = from;}
+
+    ~sink() {join();}
+
+    void run(void) {
+        char buf[65536];
+
+        if(!server->wait(2000))
+            return;
+
+        socket_t so = server->accept();
+        while(Socket::recvfrom(so, buf, sizeof(buf)) > 0)
+            ;
+        Socket::release(so);
+    }
+};
+
+static void throughput(const char *id, double ms)
+{
+    printf("%-16s %8.1f ms, %8.1f MB/sec\n", id, ms,
+        ((double)TRANSFER / (1024.0 * 1024.0)) / (ms / 1000.0));
+}
+
+static double transfer(unsigned method, fsys *file)
+{
+    TCPServer server("127.0.0.1", "4457");
+    sink *thread = new sink(&server);
+    struct iovec vector;
+    Timer::tick_t start;
+
+    thread->start();
+    TCPBuffer client("127.0.0.1", "4457", 65536);
+    if(method == 3 && !client.zerocopy(CHUNK))
+        printf("zero copy not supported, copying\n");
+
+    start = Timer::ticks();
+    for(long total = 0; total < TRANSFER; total += CHUNK) {
+        switch(method) {
+        case 0:
+            client.put(chunk, CHUNK);
+            break;
+        case 2:
+            file->seek(0);
+            client.sendfile(*file, CHUNK);
+            break;
+        default:
+            vector.iov_base = chunk;
+            vector.iov_len = CHUNK;
+            client.sendv(&vector, 1);
+        }
+    }
+    client.flush();
+    client.close();
+    delete thread;
+    return elapsed(start);
+}
+
+extern "C" int main()
+{
+    const char *tmp = "ucommon-sendbench.tmp";
+
+    for(unsigned pos = 0; pos < CHUNK; ++pos)
+        chunk[pos] = (char)pos;
+
+    fsys::erase(tmp);
+    fsys file(tmp, 0640, fsys::REWRITE);
+    file.write(chunk, CHUNK);
+
+    throughput("put and flush", transfer(0, &file));
+    throughput("sendv", transfer(1, &file));
+    throughput("sendfile", transfer(2, &file));
+    throughput("zero copy", transfer(3, &file));
+
+    file.close();
+    fsys::erase(tmp);
+    return 0;
+}
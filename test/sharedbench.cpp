@@ -0,0 +1,106 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+// compare readers of a shared singleton through a shared pointer that uses
+// shared access locking with one that is read copy updated, with and
+// without a writer replacing the singleton while they read.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define READS       500000
+#define UPDATES     200
+
+class config : public SharedObject
+{
+public:
+    unsigned value;
+
+    config(unsigned v) : SharedObject() {value = v;}
+};
+
+class reader : public JoinableThread
+{
+public:
+    shared_pointer<config> *pointer;
+    unsigned long sum;
+
+    reader(shared_pointer<config> *p) : JoinableThread() {pointer = p; sum = 0;}
+
+    void run(void) {
+        for(unsigned count = 0; count < READS; ++count) {
+            shared_instance<config> cfg(*pointer);
+            sum += cfg->value;
+        }
+    }
+
+    void finish(void) {join();}
+};
+
+static void reads(const char *id, unsigned threads, double ms, unsigned ops)
+{
+    printf("%-10s %2u threads %8.1f ms, %10.0f reads/sec, %8.0f ns/read\n", id,
+        threads, ms, ops / (ms / 1000.0), (ms * 1000000.0) / ops);
+}
+
+static void readers(bool lockfree, unsigned threads, bool updating)
+{
+    shared_pointer<config> pointer(lockfree);
+    reader **list = new reader *[threads];
+    Timer::tick_t start;
+
+    pointer = new config(1);
+    start = Timer::ticks();
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        list[pos] = new reader(&pointer);
+        list[pos]->start();
+    }
+    if(updating) {
+        for(unsigned count = 0; count < UPDATES; ++count) {
+            pointer = new config(count);
+            Thread::sleep(1);
+        }
+    }
+    for(unsigned pos = 0; pos < threads; ++pos) {
+        list[pos]->finish();
+        delete list[pos];
+    }
+    reads(pointer.is_lockfree() ? "lockfree" : "locked", threads, elapsed(start), READS * threads);
+    delete[] list;
+    pointer = NULL;
+}
+
+extern "C" int main()
+{
+    unsigned threads;
+
+    for(threads = 1; threads <= 8; threads *= 2) {
+        readers(false, threads, false);
+        readers(true, threads, false);
+    }
+    printf("with updates...\n");
+    for(threads = 1; threads <= 8; threads *= 2) {
+        readers(false, threads, true);
+        readers(true, threads, true);
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// count the heap allocations and time of creating, copying, appending,
+// and returning short strings, which are held in the string object, and
+// of longer strings, which are held in a shared heap cstring.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#if __cplusplus >= 201103L
+#include <utility>
+#endif
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define OPERATIONS  2000000
+
+static unsigned long allocs = 0;
+
+#ifdef  __GLIBC__
+extern "C" void *__libc_malloc(size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    ++allocs;
+    return __libc_malloc(size);
+}
+#endif
+
+static const char *shorter = "short text";
+static const char *longer = "a much longer text string that is held on the heap";
+
+static size_t total = 0;
+
+static String substring(const String& from)
+{
+    return from(0, from.len() - 1);
+}
+
+static void allocations(const char *id, const char *text, double ms, unsigned long count)
+{
+    printf("%-10s %-6s %8.1f ms, %6.0f ns/op, %5.2f allocs/op\n", id,
+        text == shorter ? "short" : "long", ms, (ms * 1000000.0) / OPERATIONS,
+        (double)count / OPERATIONS);
+}
+
+static void create(const char *text)
+{
+    unsigned long count = allocs;
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned pos = 0; pos < OPERATIONS; ++pos) {
+        String str(text);
+        total += str.len();
+    }
+    allocations("create", text, elapsed(start), allocs - count);
+}
+
+static void copy(const char *text)
+{
+    String from(text);
+    unsigned long count = allocs;
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned pos = 0; pos < OPERATIONS; ++pos) {
+        String str(from);
+        total += str.len();
+    }
+    allocations("copy", text, elapsed(start), allocs - count);
+}
+
+static void append(const char *text)
+{
+    unsigned long count = allocs;
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned pos = 0; pos < OPERATIONS; ++pos) {
+        String str("ab");
+        str += text + 2;
+        total += str.len();
+    }
+    allocations("append", text, elapsed(start), allocs - count);
+}
+
+static void result(const char *text)
+{
+    String from(text);
+    unsigned long count = allocs;
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned pos = 0; pos < OPERATIONS; ++pos) {
+        String str = substring(from);
+        total += str.len();
+    }
+    allocations("return", text, elapsed(start), allocs - count);
+}
+
+#if __cplusplus >= 201103L
+static void move(const char *text)
+{
+    String from(text);
+    unsigned long count = allocs;
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned pos = 0; pos < OPERATIONS; ++pos) {
+        String str(std::move(from));
+        total += str.len();
+        from = std::move(str);
+    }
+    allocations("move", text, elapsed(start), allocs - count);
+}
+#endif
+
+extern "C" int main()
+{
+#ifndef __GLIBC__
+    printf("allocations not counted\n");
+#endif
+
+    create(shorter);
+    create(longer);
+    copy(shorter);
+    copy(longer);
+    append(shorter);
+    append(longer);
+    result(shorter);
+    result(longer);
+#if __cplusplus >= 201103L
+    move(shorter);
+    move(longer);
+#endif
+
+    return total == 0;
+}
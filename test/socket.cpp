@@ -22,6 +22,7 @@
 #include <ucommon/ucommon.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 
 using namespace ucommon;
 
@@ -66,6 +67,125 @@ extern "C" int main()
     assert(localhost.isAny());
     assert(localhost.family() == AF_INET);
 
+    // batched datagrams over loopback, echoed back to their sender...
+    Socket::address rxaddr("127.0.0.1", 4446), txaddr("127.0.0.1", 4447);
+    socket_t rx = Socket::create(AF_INET, SOCK_DGRAM, 0);
+    socket_t tx = Socket::create(AF_INET, SOCK_DGRAM, 0);
+    assert(!Socket::bindto(rx, rxaddr.get(AF_INET)));
+    assert(!Socket::bindto(tx, txaddr.get(AF_INET)));
+
+    DatagramBatch out(8, 64), in(16, 64);
+    for(unsigned index = 0; index < 8; ++index) {
+        snprintf(addrbuf, sizeof(addrbuf), "packet %u", index);
+        assert(out.put(addrbuf, strlen(addrbuf), rxaddr.get(AF_INET)));
+    }
+    assert(out.is_full());
+    assert(!out.put("x", 1));
+    assert(out.send(tx) == 8);
+    assert(out.count() == 0);
+
+    unsigned received = 0;
+    while(received < 8) {
+        unsigned count = in.receive(rx);
+        assert(count > 0);
+        for(unsigned index = 0; index < count; ++index) {
+            snprintf(addrbuf, sizeof(addrbuf), "packet %u", received + index);
+            assert(in.size(index) == strlen(addrbuf));
+            assert(!memcmp(in.data(index), addrbuf, in.size(index)));
+            assert(eq(in.peer(index), txaddr.get(AF_INET)));
+        }
+        received += count;
+        assert(in.send(rx) == count);
+    }
+    received = 0;
+    while(received < 8) {
+        unsigned count = out.receive(tx);
+        assert(count > 0);
+        assert(eq(out.peer(0), rxaddr.get(AF_INET)));
+        received += count;
+    }
+    Socket::release(rx);
+    Socket::release(tx);
+
+    // lines are read ahead and split from a single receive...
+    TCPServer server("127.0.0.1", "4445");
+    Socket client(AF_INET, SOCK_STREAM);
+    Socket::address serveraddr("127.0.0.1", "4445");
+    assert(client.connectto(serveraddr.getList()) == 0);
+    assert(server.wait(1000));
+    Socket session(server.accept());
+    struct sockaddr_storage peer;
+    assert(client.writes("first\r\nsecond\nthird line is long\nrest") == 37);
+    client.cancel();
+    assert(session.readline(addrbuf, sizeof(addrbuf)) == 6);
+    assert(eq(addrbuf, "first"));
+    String text((strsize_t)32);
+    assert(session.readline(text) == 7);
+    assert(eq(text, "second"));
+    assert(session.pending() == 23);
+    assert(session.readline(addrbuf, 6) == 5);
+    assert(eq(addrbuf, "third"));
+    assert(session.readline(addrbuf, sizeof(addrbuf)) == 14);
+    assert(eq(addrbuf, " line is long"));
+    assert(session.readfrom(addrbuf, sizeof(addrbuf), &peer) == 4);
+    assert(!memcmp(addrbuf, "rest", 4));
+    assert(peer.ss_family == AF_INET);
+    assert(((struct sockaddr_in *)&peer)->sin_addr.s_addr == htonl(INADDR_LOOPBACK));
+    assert(session.readline(addrbuf, sizeof(addrbuf)) == 0);
+
+    // an indexed policy finds the same entries as searching the chain...
+    LinkedObject *policy = NULL;
+    new cidr(&policy, "10.0.0.0/8", "ten");
+    new cidr(&policy, "10.1.0.0/16", "ten-one");
+    new cidr(&policy, "10.1.2.0/24", "ten-one-two");
+    new cidr(&policy, "10.1.2.0/24", "duplicate");
+    new cidr(&policy, "192.168.0.0/16", "private");
+    new cidr(&policy, "0.0.0.0/0", "default");
+    cidrmap index(policy);
+    assert(index.count() == 5);
+    Socket::address ten("10.1.2.3"), other("10.9.0.1"), outside("8.8.8.8");
+    assert(index.find(ten.get(AF_INET)) == cidr::find(policy, ten.get(AF_INET)));
+    assert(eq(index.find(ten.get(AF_INET))->getName(), cidr::find(policy, ten.get(AF_INET))->getName()));
+    assert(eq(index.find(other.get(AF_INET))->getName(), "ten"));
+    assert(eq(index.container(ten.get(AF_INET))->getName(), "default"));
+    assert(index.find(outside.get(AF_INET)) == NULL);
+    assert(index.container(outside.get(AF_INET)) == cidr::container(policy, outside.get(AF_INET)));
+
+    srand(1);
+    for(unsigned count = 0; count < 200; ++count) {
+        snprintf(addrbuf, sizeof(addrbuf), "%u.%u.%u.0/%u", rand() & 15, rand() & 255, rand() & 255, rand() % 33);
+        new cidr(&policy, addrbuf);
+    }
+    index.set(policy);
+    for(unsigned count = 0; count < 2000; ++count) {
+        struct sockaddr_in host;
+        memset(&host, 0, sizeof(host));
+        host.sin_family = AF_INET;
+        host.sin_addr.s_addr = htonl(((uint32_t)(rand() & 15) << 24) | ((uint32_t)rand() & 0xffffff));
+        assert(index.find((struct sockaddr *)&host) == cidr::find(policy, (struct sockaddr *)&host));
+        assert(index.container((struct sockaddr *)&host) == cidr::container(policy, (struct sockaddr *)&host));
+    }
+
+#ifdef  AF_INET6
+    new cidr(&policy, "2001:db8::/32", "doc");
+    new cidr(&policy, "2001:db8:1::/48", "doc-one");
+    index.set(policy);
+    Socket::address doc("2001:db8:1::5"), doc2("2001:db8:2::5");
+    if(doc.get(AF_INET6) && doc2.get(AF_INET6)) {
+        assert(eq(index.find(doc.get(AF_INET6))->getName(), "doc-one"));
+        assert(eq(index.find(doc2.get(AF_INET6))->getName(), "doc"));
+        assert(eq(index.container(doc.get(AF_INET6))->getName(), "doc"));
+    }
+#endif
+    index.clear();
+    assert(index.count() == 0);
+    assert(index.find(ten.get(AF_INET)) == NULL);
+    while(policy) {
+        LinkedObject *next = policy->getNext();
+        delete (cidr *)policy;
+        policy = next;
+    }
+
 #ifdef  AF_INET6
     // we can only test if interface/ipv6 support is actually running
     // so we use getinterface to find out first.  it will return -1 for
@@ -22,11 +22,35 @@
 #include <ucommon/ucommon.h>
 
 #include <stdio.h>
+#include <stdlib.h>
+#if __cplusplus >= 201103L
+#include <utility>
+#endif
 
 using namespace ucommon;
 
 static string_t testing("second test");
 
+// plain per character versions of the list scans to check against...
+static const char *first_of(const char *text, const char *list, bool member)
+{
+    while(*text && (strchr(list, *text) != NULL) != member)
+        ++text;
+    return text;
+}
+
+static const char *last_of(const char *text, const char *list, bool member)
+{
+    const char *cp = text + strlen(text);
+
+    while(cp > text) {
+        --cp;
+        if((strchr(list, *cp) != NULL) == member)
+            return cp;
+    }
+    return NULL;
+}
+
 extern "C" int main()
 {
     char buff[33];
@@ -43,6 +67,8 @@ extern "C" int main()
     assert(eq_case("hello this is a test", *mystr));
     assert(eq_case("second test", *testing));
     assert(eq_case(" Is a test", mystr(-10)));
+    assert(String::hash_case("Key.Name") == String::hash_case("kEY.nAME"));
+    assert(String::hash_case("key") != String::hash_case("kez"));
     mystr = "  abc 123 \n  ";
     assert(eq_case("abc 123", String::strip(mystr.c_mem(), " \n")));
     String::set(buff, sizeof(buff), "this is \"a test\"");
@@ -89,5 +115,129 @@ extern "C" int main()
     delete[] test;
     delete[] cdup;
 
+    // character list scans, from every alignment and over vector lengths
+    static const char *lists[] = {",", " \t", " \t\r\n,;:=", "\xe9,"};
+    static const char alphabet[] = " \t,;abcXYZ=\xe9";
+    char text[256], copy[256];
+    srand(1);
+    for(unsigned loop = 0; loop < 2000; ++loop) {
+        unsigned offset = rand() % 32;
+        unsigned len = rand() % 200;
+        const char *list = lists[loop % 4];
+        for(unsigned pos = 0; pos < len; ++pos)
+            text[offset + pos] = alphabet[rand() % (sizeof(alphabet) - 1)];
+        text[offset + len] = 0;
+        char *cp = text + offset;
+        const char *found = first_of(cp, list, true);
+
+        assert(String::seek(cp, list) == (size_t)(found - cp));
+        assert(String::find(cp, list) == (*found ? found : NULL));
+        assert(String::rfind(cp, list) == last_of(cp, list, true));
+        found = first_of(cp, list, false);
+        assert(String::trim(cp, list) == found);
+        assert(String::skip(cp, list) == (*found ? found : NULL));
+        assert((String::rskip(cp, list) != NULL) == (last_of(cp, list, false) != NULL));
+
+        unsigned tally = 0;
+        for(unsigned pos = 0; pos < len; ++pos) {
+            if(strchr(list, cp[pos]))
+                ++tally;
+        }
+        assert(String::ccount(cp, list) == tally);
+
+        String str(cp);
+        if(len) {
+            found = first_of(cp, list, true);
+            assert(str.find(list) ? str.find(list) - str.c_str() == found - cp : !*found);
+            found = first_of(cp, list, false);
+            assert(str.skip(list) ? str.skip(list) - str.c_str() == found - cp : !*found);
+            found = last_of(cp, list, true);
+            assert(str.rfind(list) ? str.rfind(list) - str.c_str() == found - cp : !found);
+            found = last_of(cp, list, false);
+            assert(str.rskip(list) ? str.rskip(list) - str.c_str() == found - cp : !found);
+        }
+
+        String::set(copy, sizeof(copy), cp);
+        found = last_of(cp, list, false);
+        String::chop(copy, list);
+        assert(strlen(copy) == (size_t)(found ? found - cp + 1 : 0));
+        str.chop(list);
+        assert(eq(str, copy));
+        str.trim(list);
+        assert(eq(str, String::trim(copy, list)));
+    }
+
+    // tokens and keys across long lines...
+    String::set(text, sizeof(text), "  alpha,\tbeta ,, gamma-delta    epsilon zeta eta theta iota kappa  ");
+    tokens = NULL;
+    count = 0;
+    while(NULL != (tp = String::token(text, &tokens, " ,\t")))
+        ++count;
+    assert(count == 9);
+    assert(eq(String::find("alpha beta gamma", "beta", " "), "beta gamma"));
+    assert(String::find("alpha betagamma", "beta", " ") == NULL);
+    assert(eq(String::ifind("alpha beta gamma", "BETA", " "), "beta gamma"));
+    assert(eq(String::ifind("some long line of text with a Content-Length header", "content-length"), "Content-Length header"));
+    assert(String::ifind("content-lengt", "content-length") == NULL);
+
+    String searching = "one two One two ONE";
+    assert(eq(searching.search("one", 2, String::INSENSITIVE), "One two ONE"));
+    assert(eq(searching.search("two", 2), "two ONE"));
+    assert(searching.search("one", 2) == NULL);
+    assert(searching.replace("one", "1", String::INSENSITIVE) == 3);
+    assert(eq(searching, "1 two 1 two 1"));
+
+    String::hexdump(core, hexbuf, "4");
+    assert(eq(hexbuf, "01102f45"));
+    String::set(hexbuf, sizeof(hexbuf), "01102F45");
+    String::hexpack(hcore, hexbuf, "4");
+    assert(!memcmp(core, hcore, 4));
+
+    // short strings are copies, longer strings share until modified...
+    String shorter = "short", shorter2 = shorter;
+    shorter2 += " and sweet";
+    assert(eq(shorter, "short"));
+    assert(eq(shorter2, "short and sweet"));
+    shorter2 += " and now too long to keep";
+    assert(eq(shorter2, "short and sweet and now too long to keep"));
+    shorter = shorter2;
+    shorter2 += "!";
+    assert(eq(shorter, "short and sweet and now too long to keep"));
+    assert(eq(shorter2, "short and sweet and now too long to keep!"));
+    shorter = "tiny";
+    String::swap(shorter, shorter2);
+    assert(eq(shorter, "short and sweet and now too long to keep!"));
+    assert(eq(shorter2, "tiny"));
+    String::swap(shorter, shorter2);
+    assert(eq(shorter, "tiny"));
+    shorter2 = shorter;
+    shorter.clear();
+    assert(eq(shorter2, "tiny"));
+    String padded(8, '.');
+    String padded2 = padded;
+    padded2.set(0, "ab", 2);
+    assert(padded.len() == 8 && eq(padded2, "ab......"));
+
+    union {
+        void *align;
+        char data[sizeof(String::cstring) + 16];
+    } fixbuf;
+    memstring fixed(fixbuf.data, 16);
+    fixed = "held";
+    String unfixed = fixed;
+    fixed = "changed";
+    assert(eq(unfixed, "held"));
+
+#if __cplusplus >= 201103L
+    String moved = std::move(shorter2);
+    assert(eq(moved, "tiny"));
+    String longer = "a string that is far too long to be short";
+    String taken(std::move(longer));
+    assert(eq(taken, "a string that is far too long to be short"));
+    assert(longer.len() == 0);
+    moved = std::move(taken);
+    assert(eq(moved, "a string that is far too long to be short"));
+#endif
+
     return 0;
 }
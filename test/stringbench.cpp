@@ -0,0 +1,233 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+// compare the String character list scans, tokens, case insensitive search
+// and hex conversion with the per character loops they replaced.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define LINES       2000
+#define LENGTH      400
+#define PASSES      50
+
+static char lines[LINES][LENGTH + 1];
+static char work[LENGTH + 1];
+static unsigned long hits = 0;
+
+static size_t old_seek(const char *str, const char *clist)
+{
+    size_t pos = 0;
+
+    while(str[pos]) {
+        if(strchr(clist, str[pos]))
+            return pos;
+        ++pos;
+    }
+    return pos;
+}
+
+static unsigned old_ccount(const char *str, const char *clist)
+{
+    unsigned count = 0;
+    while(str && *str) {
+        if(strchr(clist, *(str++)))
+            ++count;
+    }
+    return count;
+}
+
+static char *old_chop(char *str, const char *clist)
+{
+    size_t offset = strlen(str);
+    while(offset && strchr(clist, str[offset - 1]))
+        str[--offset] = 0;
+    return str;
+}
+
+static char *old_token(char *text, char **token, const char *clist)
+{
+    char *result;
+
+    if(!*token)
+        *token = text;
+
+    while(**token && strchr(clist, **token))
+        ++*token;
+
+    result = *token;
+    if(!*result) {
+        *token = text;
+        return NULL;
+    }
+
+    while(**token && !strchr(clist, **token))
+        ++(*token);
+
+    if(**token) {
+        **token = 0;
+        ++(*token);
+    }
+    return result;
+}
+
+static const char *old_ifind(const char *str, const char *key)
+{
+    unsigned l1 = strlen(str);
+    unsigned l2 = strlen(key);
+
+    while(l1 >= l2) {
+        if(!strncasecmp(key, str, l2))
+            return str;
+        ++str;
+        --l1;
+    }
+    return NULL;
+}
+
+static void old_hexdump(const unsigned char *binary, char *string, unsigned size)
+{
+    while(size--) {
+        snprintf(string, 3, "%02x", *(binary++));
+        string += 2;
+    }
+}
+
+typedef void (*bench_t)(const char *line);
+
+static void new_seek(const char *line)
+{
+    hits += String::seek((char *)line, "\r\n;:");
+}
+
+static void old_seek_test(const char *line)
+{
+    hits += old_seek(line, "\r\n;:");
+}
+
+static void new_ccount(const char *line)
+{
+    hits += String::ccount(line, " \t,;=");
+}
+
+static void old_ccount_test(const char *line)
+{
+    hits += old_ccount(line, " \t,;=");
+}
+
+static void new_chop(const char *line)
+{
+    memcpy(work, line, LENGTH + 1);
+    hits += strlen(String::chop(work, " \t\r\n"));
+}
+
+static void old_chop_test(const char *line)
+{
+    memcpy(work, line, LENGTH + 1);
+    hits += strlen(old_chop(work, " \t\r\n"));
+}
+
+static void new_token(const char *line)
+{
+    char *tokens = NULL;
+
+    memcpy(work, line, LENGTH + 1);
+    while(String::token(work, &tokens, " \t,;="))
+        ++hits;
+}
+
+static void old_token_test(const char *line)
+{
+    char *tokens = NULL;
+
+    memcpy(work, line, LENGTH + 1);
+    while(old_token(work, &tokens, " \t,;="))
+        ++hits;
+}
+
+static void new_ifind(const char *line)
+{
+    if(String::ifind(line, "content-length"))
+        ++hits;
+}
+
+static void old_ifind_test(const char *line)
+{
+    if(old_ifind(line, "content-length"))
+        ++hits;
+}
+
+static void new_hexdump(const char *line)
+{
+    String::hexdump((const unsigned char *)line, work, "64");
+    hits += work[0];
+}
+
+static void old_hexdump_test(const char *line)
+{
+    old_hexdump((const unsigned char *)line, work, 64);
+    hits += work[0];
+}
+
+static void run(const char *id, bench_t test)
+{
+    Timer::tick_t start = Timer::ticks();
+
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        for(unsigned line = 0; line < LINES; ++line)
+            test(lines[line]);
+    }
+    report(id, elapsed(start), (unsigned long)PASSES * LINES);
+}
+
+extern "C" int main()
+{
+    static const char words[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-";
+
+    srand(1);
+    for(unsigned line = 0; line < LINES; ++line) {
+        for(unsigned pos = 0; pos < LENGTH; ++pos) {
+            if(rand() % 9 == 0)
+                lines[line][pos] = " \t,="[rand() % 4];
+            else
+                lines[line][pos] = words[rand() % (sizeof(words) - 1)];
+        }
+        lines[line][LENGTH] = 0;
+        memcpy(&lines[line][LENGTH - 4], " \t \n", 4);
+    }
+
+    run("seek", &new_seek);
+    run("seek per char", &old_seek_test);
+    run("ccount", &new_ccount);
+    run("ccount per char", &old_ccount_test);
+    run("chop", &new_chop);
+    run("chop per char", &old_chop_test);
+    run("token", &new_token);
+    run("token per char", &old_token_test);
+    run("ifind", &new_ifind);
+    run("ifind per char", &old_ifind_test);
+    run("hexdump", &new_hexdump);
+    run("hexdump snprintf", &old_hexdump_test);
+    printf("hits %lu\n", hits);
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare TCPStream throughput over loopback with segment buffering and
+// with bulk buffering, for blocks, single characters, and printf lines.
+// The receiving side checks the sum of every byte it is sent.
+
+#include <ucommon/ucommon.h>
+#include <commoncpp/commoncpp.h>
+#include <commoncpp/tcp.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+
+#define PORT        4458
+#define BLOCK       (64 * 1024)
+#define BLOCKS      (256l * 1024l * 1024l)
+#define BYTES       (16l * 1024l * 1024l)
+#define LINES       400000l
+
+enum {BULK = 1, BYTE = 2, LINE = 4};
+
+static char block[BLOCK];
+
+class sink : public ost::Thread
+{
+private:
+    ost::TCPSocket *server;
+    int mode;
+
+public:
+    unsigned long total, sum;
+
+    sink(ost::TCPSocket *from, int how) : ost::Thread()
+        {server = from; mode = how; total = sum = 0;}
+
+    void run(void) {
+        char buf[BLOCK];
+        std::string line;
+        int ch;
+
+        if(!server->isPendingConnection(2000))
+            return;
+
+        ost::TCPStream input(*server);
+        if(mode & BULK)
+            input.bulkBuffering();
+
+        if(mode & LINE) {
+            while(std::getline(input, line)) {
+                total += line.size() + 1;
+                sum += (unsigned char)line[0];
+            }
+        }
+        else if(mode & BYTE) {
+            while((ch = input.get()) != EOF) {
+                ++total;
+                sum += (unsigned char)ch;
+            }
+        }
+        else {
+            for(;;) {
+                input.read(buf, sizeof(buf));
+                std::streamsize len = input.gcount();
+                if(len < 1)
+                    break;
+                total += (unsigned long)len;
+                for(std::streamsize pos = 0; pos < len; pos += 4096)
+                    sum += (unsigned char)buf[pos];
+            }
+        }
+    }
+};
+
+static void transfer(const char *id, int mode)
+{
+    ost::TCPSocket server(ost::IPV4Address("127.0.0.1"), PORT);
+    sink *thread = new sink(&server, mode);
+    unsigned long total = 0, sum = 0;
+    ucommon::Timer::tick_t start;
+    size_t size;
+    double ms;
+
+    thread->start();
+    ost::TCPStream output(ost::IPV4Host("127.0.0.1"), PORT);
+    if(mode & BULK)
+        output.bulkBuffering();
+
+    start = ucommon::Timer::ticks();
+    if(mode & LINE) {
+        for(long count = 0; count < LINES; ++count) {
+            total += (unsigned long)output.printf("%c line %ld of %ld\n",
+                'a' + (int)(count % 26), count, LINES);
+            sum += 'a' + (unsigned long)(count % 26);
+        }
+    }
+    else if(mode & BYTE) {
+        for(long count = 0; count < BYTES; ++count) {
+            output.put(block[count % BLOCK]);
+            sum += (unsigned char)block[count % BLOCK];
+        }
+        total = BYTES;
+    }
+    else {
+        for(long count = 0; count < BLOCKS; count += BLOCK) {
+            output.write(block, BLOCK);
+            for(unsigned pos = 0; pos < BLOCK; pos += 4096)
+                sum += (unsigned char)block[pos];
+        }
+        total = BLOCKS;
+    }
+    output.flush();
+    size = output.getBufferSize();
+    output.disconnect();
+    thread->join();
+    ms = elapsed(start);
+
+    printf("%-16s %8.1f ms, %8.1f MB/sec, buffer %lu\n", id, ms,
+        ((double)total / (1024.0 * 1024.0)) / (ms / 1000.0),
+        (unsigned long)size);
+
+    if(thread->total != total || thread->sum != sum) {
+        fprintf(stderr, "*** %s: received %lu of %lu bytes\n", id,
+            thread->total, total);
+        exit(1);
+    }
+    delete thread;
+}
+
+extern "C" int main()
+{
+    for(unsigned pos = 0; pos < BLOCK; ++pos)
+        block[pos] = (char)(pos * 31 + 7);
+
+    transfer("segment blocks", 0);
+    transfer("bulk blocks", BULK);
+    transfer("segment bytes", BYTE);
+    transfer("bulk bytes", BULK | BYTE);
+    transfer("segment printf", LINE);
+    transfer("bulk printf", BULK | LINE);
+    return 0;
+}
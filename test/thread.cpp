@@ -25,8 +25,15 @@
 
 using namespace ucommon;
 
+#include "readers.h"
+
 static unsigned count = 0;
 
+static Mutex locking;
+static Semaphore limiting(2);
+static barrier gate(4);
+static unsigned total = 0, active = 0, peak = 0;
+
 class testThread : public JoinableThread
 {
 public:
@@ -38,6 +45,118 @@ public:
     };
 };
 
+class lockThread : public JoinableThread
+{
+public:
+    lockThread() : JoinableThread() {};
+
+    ~lockThread() {join();}
+
+    void run(void) {
+        gate.wait();
+        for(unsigned loop = 0; loop < 10000; ++loop) {
+            limiting.wait();
+            locking.acquire();
+            ++total;
+            if(++active > peak)
+                peak = active;
+            locking.release();
+            if(loop % 1000 == 0)
+                Thread::yield();
+            locking.acquire();
+            --active;
+            locking.release();
+            limiting.release();
+        }
+    };
+};
+
+class protectThread : public JoinableThread
+{
+public:
+    const void *object;
+    volatile bool *held;
+
+    protectThread(const void *ptr, volatile bool *flag) : JoinableThread() {object = ptr; held = flag;};
+
+    ~protectThread() {join();}
+
+    void run(void) {
+        Mutex::protect(object);
+        *held = true;
+        Mutex::release(object);
+    };
+};
+
+class testConfig : public SharedObject
+{
+public:
+    unsigned first, second;
+    volatile unsigned valid;
+
+    testConfig(unsigned value) : SharedObject()
+        {first = second = value; valid = 0x5a5a; ++configs;}
+
+    ~testConfig()
+        {valid = 0; --configs;}
+
+    static volatile long configs;
+};
+
+volatile long testConfig::configs = 0;
+
+static void checkConfig(shared_pointer<testConfig> *config)
+{
+    shared_instance<testConfig> cfg(*config);
+    assert(cfg->valid == 0x5a5a);
+    assert(cfg->first == cfg->second);
+    // only lockfree readers may nest while a writer waits...
+    if(config->is_lockfree()) {
+        shared_instance<testConfig> nested(*config);
+        assert(nested->valid == 0x5a5a);
+        assert(nested->first >= cfg->first);
+    }
+}
+
+static void sharing(bool lockfree)
+{
+    shared_pointer<testConfig> config(lockfree);
+    volatile bool done = false;
+    readThread< shared_pointer<testConfig> > *readers[3];
+
+    config = new testConfig(0);
+    for(unsigned pos = 0; pos < 3; ++pos) {
+        readers[pos] = new readThread< shared_pointer<testConfig> >(&config, &checkConfig, &done);
+        readers[pos]->start();
+    }
+    for(unsigned value = 1; value <= 500; ++value) {
+        config = new testConfig(value);
+        if(value % 50 == 0)
+            Thread::yield();
+    }
+    done = true;
+    for(unsigned pos = 0; pos < 3; ++pos)
+        delete readers[pos];
+
+    shared_instance<testConfig> cfg(config);
+    assert(cfg->first == 500);
+    cfg.release();
+
+    // a lockfree pointer may be replaced while we still read it, and the
+    // prior object then lives until we release it...
+    if(config.is_lockfree()) {
+        shared_instance<testConfig> held(config);
+        config = new testConfig(501);
+        assert(held->valid == 0x5a5a && held->first == 500);
+        assert(testConfig::configs == 2);
+        held.release();
+        assert(testConfig::configs == 1);
+    }
+
+    config = NULL;
+    assert(testConfig::configs == 0);
+}
+
 extern "C" int main()
 {
     time_t now, later;
@@ -57,6 +176,65 @@ extern "C" int main()
     evt.wait(2000);
     time(&later);
     assert(later >= now + 1);
+
+    lockThread *lockers[3];
+    for(unsigned pos = 0; pos < 3; ++pos) {
+        lockers[pos] = new lockThread();
+        lockers[pos]->start();
+    }
+    gate.wait();
+    for(unsigned pos = 0; pos < 3; ++pos)
+        delete lockers[pos];
+    assert(total == 30000);
+    assert(active == 0);
+    assert(peak <= 2);
+
+    // a protected object may be protected again by the thread holding it...
+    unsigned long acquired, contended;
+    int objects[2];
+    assert(Mutex::protect(&objects[0]));
+    assert(Mutex::protect(&objects[1]));
+    assert(Mutex::protect(&objects[0]));
+    assert(Mutex::release(&objects[0]));
+    assert(Mutex::release(&objects[1]));
+    assert(Mutex::release(&objects[0]));
+    assert(!Mutex::release(&objects[0]));
+    assert(Mutex::contention(&acquired, &contended) > 1);
+    assert(acquired > 0 && contended <= acquired);
+
+    // every object sharing a single stripe is still held separately
+    Mutex::indexing(1);
+    assert(Mutex::protect(&objects[0]));
+    assert(!Mutex::release(&objects[1]));
+    assert(Mutex::protect(&objects[1]));
+    assert(Mutex::release(&objects[0]));
+    assert(Mutex::release(&objects[1]));
+    assert(!Mutex::release(&objects[1]));
+
+    // more objects than a stripe holds at once wait for one to be free
+    int pool[5];
+    volatile bool held = false;
+    for(unsigned pos = 0; pos < 4; ++pos)
+        assert(Mutex::protect(&pool[pos]));
+    protectThread *starving = new protectThread(&pool[4], &held);
+    starving->start();
+    Thread::sleep(50);
+    assert(!held);
+    assert(Mutex::release(&pool[0]));
+    delete starving;
+    assert(held);
+    for(unsigned pos = 1; pos < 4; ++pos)
+        assert(Mutex::release(&pool[pos]));
+    Mutex::indexing(64);
+
+    Semaphore busy(1, 0);
+    assert(!busy.wait(50));
+    busy.release();
+    assert(busy.wait(50));
+
+    // replaced shared objects are only deleted once readers are done...
+    sharing(false);
+    sharing(true);
     return 0;
 }
 
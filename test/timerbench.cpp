@@ -0,0 +1,105 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// measure timer queue arm, cancel, and expire costs for many armed
+// session style timers.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+class benchqueue : public TimerQueue
+{
+public:
+    void modify(void) {}
+    void update(void) {}
+};
+
+class benchevent : public TQEvent
+{
+public:
+    static unsigned long fired;
+
+    benchevent() : TQEvent(Timer::inf) {}
+
+    void expired(void) {++fired;}
+};
+
+unsigned long benchevent::fired = 0;
+
+static double nsec(Timer::tick_t start, unsigned long ops)
+{
+    return (double)(Timer::ticks() - start) * 100.0 / (double)ops;
+}
+
+static void bench(unsigned long count)
+{
+    benchqueue queue;
+    benchevent *events = new benchevent[count];
+    Timer::tick_t start;
+    unsigned long pos;
+    double arm, cancel, idle, expire;
+
+    srand(1);
+    for(pos = 0; pos < count; ++pos)
+        queue += events[pos];
+
+    // session timeouts spread over ten minutes...
+    start = Timer::ticks();
+    for(pos = 0; pos < count; ++pos)
+        events[pos].arm(1000 + (rand() % 600000));
+    arm = nsec(start, count);
+
+    start = Timer::ticks();
+    for(pos = 0; pos < 1000; ++pos)
+        queue.expire();
+    idle = nsec(start, 1000);
+
+    start = Timer::ticks();
+    for(pos = 0; pos < count; ++pos)
+        events[pos].disarm();
+    cancel = nsec(start, count);
+
+    for(pos = 0; pos < count; ++pos)
+        events[pos].arm(rand() % 50);
+    Thread::sleep(60);
+    benchevent::fired = 0;
+    start = Timer::ticks();
+    queue.expire();
+    expire = nsec(start, count);
+
+    printf("%8lu timers: arm %6.0f ns, cancel %6.0f ns, idle expire %9.0f ns, fire %6.0f ns/timer%s\n",
+        count, arm, cancel, idle, expire, benchevent::fired == count ? "" : " (missed)");
+
+    delete[] events;
+}
+
+extern "C" int main(int argc, char **argv)
+{
+    unsigned long limit = 1000000;
+
+    if(argc > 1)
+        limit = atol(argv[1]);
+
+    for(unsigned long count = 1000; count <= limit; count *= 10)
+        bench(count);
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+
+using namespace ucommon;
+
+class myqueue : public TimerQueue
+{
+public:
+    unsigned changes;
+
+    myqueue() : TimerQueue() {changes = 0;}
+
+    void modify(void) {}
+
+    void update(void) {++changes;}
+};
+
+class myevent : public TQEvent
+{
+public:
+    unsigned fired;
+    timeout_t period;
+
+    myevent(myqueue *q, timeout_t t, timeout_t p = 0) : TQEvent(q, t) {fired = 0; period = p;}
+
+    void expired(void) {
+        ++fired;
+        if(period)
+            arm(period);
+    }
+};
+
+// re-arms through the timer itself rather than the event...
+class resetevent : public TQEvent
+{
+public:
+    unsigned fired;
+
+    resetevent(myqueue *q, timeout_t t) : TQEvent(q, t) {fired = 0;}
+
+    void expired(void) {
+        if(++fired < 3)
+            Timer::set((timeout_t)10);
+    }
+};
+
+// asks to be looked at again sooner than its timer says
+class pollevent : public TQEvent
+{
+public:
+    pollevent(myqueue *q, timeout_t t) : TQEvent(q, t) {}
+
+    void expired(void) {
+        arm(1000);
+    }
+
+    timeout_t timeout(void) {
+        TQEvent::timeout();
+        return 5;
+    }
+};
+
+extern "C" int main()
+{
+    myqueue queue;
+    timeout_t next;
+
+    myevent quick(&queue, 20);
+    myevent periodic(&queue, 30, 30);
+    myevent slow(&queue, 400);
+    myevent never(&queue, 50);
+    myevent distant(&queue, 100000);
+
+    assert(queue.changes == 5);
+    never.disarm();
+
+    next = queue.expire();
+    assert(next > 0 && next <= 20);
+    assert(quick.fired == 0);
+
+    Thread::sleep(100);
+    next = queue.expire();
+    assert(quick.fired == 1);
+    assert(periodic.fired == 1);
+    assert(slow.fired == 0);
+    assert(next > 0 && next <= 30);
+
+    // slow event sits in a higher wheel and must be cascaded down...
+    while(slow.fired == 0) {
+        Thread::sleep(next);
+        next = queue.expire();
+    }
+    assert(slow.fired == 1);
+    assert(periodic.fired >= 10);
+    assert(quick.fired == 1);
+    assert(never.fired == 0);
+    assert(distant.fired == 0);
+
+    periodic.disarm();
+    next = queue.expire();
+    assert(next > 0 && next <= 100000);
+
+    distant.arm(0);
+    Thread::sleep(2);
+    assert(queue.expire() == Timer::inf);
+    assert(distant.fired == 1);
+
+    quick.arm(10);
+    quick.detach();
+    Thread::sleep(20);
+    assert(queue.expire() == Timer::inf);
+    assert(quick.fired == 1);
+
+    myqueue other;
+    resetevent reset(&other, 10);
+    pollevent poll(&other, 10);
+
+    Thread::sleep(20);
+    next = other.expire();
+    assert(reset.fired == 1);
+    assert(next > 0 && next <= 5);
+
+    while(reset.fired < 3) {
+        Thread::sleep(10);
+        other.expire();
+    }
+    assert(reset.fired == 3);
+    poll.disarm();
+    assert(other.expire() == Timer::inf);
+    return 0;
+}
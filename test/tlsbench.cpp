@@ -0,0 +1,201 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare tls throughput over loopback for SSLBuffer and sstream with
+// segment sized buffers and with whole record buffering, and for gathered
+// and file sends, which are sent by the kernel when it has our records.
+// A self signed certificate is made with the openssl command.  The
+// receiving side checks the sum of every byte it is sent.
+
+#include <ucommon/ucommon.h>
+#include <ucommon/secure.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define PORT        "4459"
+#define CHUNK       (64 * 1024)
+#define HEADER      64
+#define MESSAGE     1000
+#define TRANSFER    (64l * 1024l * 1024l)
+
+enum {PUT = 0, SENDV, SENDFILE, STREAM};
+
+static char chunk[CHUNK];
+static secure::server_t server_context;
+static secure::client_t client_context;
+static unsigned long received, received_sum;
+
+class sink : public JoinableThread
+{
+private:
+    TCPServer *server;
+    bool records;
+
+public:
+    sink(TCPServer *from, bool whole) : JoinableThread()
+        {server = from; records = whole;}
+
+    ~sink() {join();}
+
+    void run(void) {
+        char buf[CHUNK];
+        size_t len;
+
+        if(!server->wait(2000))
+            return;
+
+        // socket buffers sized for a small segment stall on loopback,
+        // where a segment is far larger, so we receive with large ones
+        SSLBuffer input(server, server_context, CHUNK);
+        if(records)
+            input.records();
+
+        while((len = input.get(buf, sizeof(buf))) > 0) {
+            received += (unsigned long)len;
+            for(size_t pos = 0; pos < len; ++pos)
+                received_sum += (unsigned char)buf[pos];
+        }
+    }
+};
+
+static void transfer(const char *id, unsigned method, bool records, fsys *file)
+{
+    TCPServer server("127.0.0.1", PORT);
+    sink *thread = new sink(&server, records);
+    struct iovec vector[2];
+    unsigned long total = 0, sum = 0, chunksum = 0;
+    size_t len;
+    Timer::tick_t start;
+    bool offloaded;
+    double ms;
+
+    for(unsigned pos = 0; pos < CHUNK; ++pos)
+        chunksum += (unsigned char)chunk[pos];
+
+    received = received_sum = 0;
+    thread->start();
+    if(method == STREAM) {
+        sstream output(client_context);
+        output.open("127.0.0.1", PORT);
+        if(records)
+            output.records();
+        offloaded = output.is_offloaded();
+
+        start = Timer::ticks();
+        while(total < TRANSFER) {
+            output.write(chunk, MESSAGE);
+            for(unsigned pos = 0; pos < MESSAGE; ++pos)
+                sum += (unsigned char)chunk[pos];
+            total += MESSAGE;
+        }
+        output.flush();
+        output.close();
+    }
+    else {
+        SSLBuffer output(client_context);
+        output.open("127.0.0.1", PORT);
+        if(records)
+            output.records();
+        offloaded = output.is_offloaded();
+
+        start = Timer::ticks();
+        while(total < TRANSFER) {
+            switch(method) {
+            case SENDV:
+                vector[0].iov_base = chunk;
+                vector[0].iov_len = HEADER;
+                vector[1].iov_base = chunk;
+                vector[1].iov_len = CHUNK;
+                len = output.sendv(vector, 2);
+                for(unsigned pos = 0; pos < HEADER; ++pos)
+                    sum += (unsigned char)chunk[pos];
+                break;
+            case SENDFILE:
+                file->seek(0);
+                len = output.sendfile(*file, CHUNK);
+                break;
+            default:
+                len = output.put(chunk, CHUNK);
+            }
+            if(!len)
+                break;
+            total += (unsigned long)len;
+            sum += chunksum;
+        }
+        output.flush();
+        output.close();
+    }
+    delete thread;
+    ms = elapsed(start);
+
+    printf("%-18s %8.1f ms, %8.1f MB/sec%s\n", id, ms,
+        ((double)total / (1024.0 * 1024.0)) / (ms / 1000.0),
+        offloaded ? ", offloaded" : "");
+
+    if(received != total || received_sum != sum) {
+        fprintf(stderr, "*** %s: received %lu of %lu bytes\n", id,
+            received, total);
+        exit(1);
+    }
+}
+
+extern "C" int main()
+{
+    const char *tmp = "ucommon-tlsbench.tmp";
+    const char *pem = "ucommon-tlsbench.pem";
+
+    if(system("openssl req -x509 -newkey rsa:2048 -nodes -days 1 "
+        "-subj /CN=localhost -keyout ucommon-tlsbench.key "
+        "-out ucommon-tlsbench.crt >/dev/null 2>&1 && "
+        "cat ucommon-tlsbench.key ucommon-tlsbench.crt >ucommon-tlsbench.pem")) {
+        printf("cannot make a certificate, skipping\n");
+        return 0;
+    }
+
+    secure::init();
+    server_context = secure::server(pem);
+    client_context = secure::client();
+
+    for(unsigned pos = 0; pos < CHUNK; ++pos)
+        chunk[pos] = (char)(pos * 31 + 7);
+
+    fsys::erase(tmp);
+    fsys file(tmp, 0640, fsys::REWRITE);
+    file.write(chunk, CHUNK);
+
+    transfer("segment put", PUT, false, &file);
+    transfer("records put", PUT, true, &file);
+    transfer("segment sendv", SENDV, false, &file);
+    transfer("records sendv", SENDV, true, &file);
+    transfer("records sendfile", SENDFILE, true, &file);
+    transfer("segment stream", STREAM, false, &file);
+    transfer("records stream", STREAM, true, &file);
+
+    file.close();
+    fsys::erase(tmp);
+    fsys::erase(pem);
+    fsys::erase("ucommon-tlsbench.key");
+    fsys::erase("ucommon-tlsbench.crt");
+    delete server_context;
+    delete client_context;
+    return 0;
+}
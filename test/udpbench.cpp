@@ -0,0 +1,89 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// compare loopback packets per second moving rtp sized datagrams one per
+// call with moving them in batches, all on a single core.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define PACKETS     1000000
+#define PAYLOAD     172
+
+static Socket::address rxaddr("127.0.0.1", 4448), txaddr("127.0.0.1", 4449);
+
+static double single(socket_t tx, socket_t rx, unsigned burst)
+{
+    char packet[PAYLOAD];
+    const struct sockaddr *dest = rxaddr.get(AF_INET);
+    Timer::tick_t start = Timer::ticks();
+
+    memset(packet, 0, sizeof(packet));
+    for(unsigned count = 0; count < PACKETS; count += burst) {
+        for(unsigned index = 0; index < burst; ++index)
+            Socket::sendto(tx, packet, sizeof(packet), 0, dest);
+        for(unsigned index = 0; index < burst; ++index)
+            Socket::recvfrom(rx, packet, sizeof(packet));
+    }
+    return elapsed(start);
+}
+
+static double batched(socket_t tx, socket_t rx, unsigned burst)
+{
+    char packet[PAYLOAD];
+    DatagramBatch out(burst, PAYLOAD), in(burst, PAYLOAD);
+    const struct sockaddr *dest = rxaddr.get(AF_INET);
+    Timer::tick_t start = Timer::ticks();
+
+    memset(packet, 0, sizeof(packet));
+    for(unsigned count = 0; count < PACKETS; count += burst) {
+        while(out.put(packet, sizeof(packet), dest))
+            ;
+        out.send(tx);
+        for(unsigned index = 0; index < burst; index += in.receive(rx))
+            ;
+    }
+    return elapsed(start);
+}
+
+extern "C" int main()
+{
+    socket_t rx = Socket::create(AF_INET, SOCK_DGRAM, 0);
+    socket_t tx = Socket::create(AF_INET, SOCK_DGRAM, 0);
+    int size = 4 * 1024 * 1024;
+
+    if(Socket::bindto(rx, rxaddr.get(AF_INET)) || Socket::bindto(tx, txaddr.get(AF_INET))) {
+        fprintf(stderr, "*** cannot bind loopback sockets\n");
+        return 1;
+    }
+    setsockopt(rx, SOL_SOCKET, SO_RCVBUF, (char *)&size, sizeof(size));
+
+    report("single", single(tx, rx, 32), PACKETS, "packet");
+    report("batch 8", batched(tx, rx, 8), PACKETS, "packet");
+    report("batch 32", batched(tx, rx, 32), PACKETS, "packet");
+    report("batch 64", batched(tx, rx, 64), PACKETS, "packet");
+
+    Socket::release(rx);
+    Socket::release(tx);
+    return 0;
+}
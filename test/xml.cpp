@@ -0,0 +1,190 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEBUG
+#define DEBUG
+#endif
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+
+using namespace ucommon;
+
+static const char *document =
+    "<?xml version=\"1.0\"?>\n"
+    "<!DOCTYPE test [<!ELEMENT test ANY>]>\n"
+    "<test id=\"1\" title='a > b'>\n"
+    "  <item name=\"first\">one &amp; two &lt;three&gt; &#65;&#x42;</item>\n"
+    "  <!-- a comment - with -- dashes -->\n"
+    "  <empty/>\n"
+    "  <data><![CDATA[raw <text> ] ]] here]]></data>\n"
+    "</test>\n";
+
+static const char *expected =
+    "[test id=1 title=a > b]"
+    "[item name=first]one & two <three> AB[/item]"
+    "{ a comment - with -- dashes }"
+    "[empty][/empty]"
+    "[data]raw <text> ] ]] here[/data]"
+    "[/test]";
+
+// record events, with comments that may arrive in pieces in braces...
+class testParser : public XMLParser
+{
+private:
+    bool commenting;
+
+    void close(void) {
+        if(commenting)
+            events += "}";
+        commenting = false;
+    }
+
+public:
+    String events;
+    unsigned documents;
+    bool scribbling;
+
+    testParser() : XMLParser(256)
+        {documents = 0; commenting = false; scribbling = false;}
+
+    void startElement(caddr_t name, caddr_t *attr) {
+        close();
+        events += "[";
+        events += name;
+        while(attr && *attr) {
+            events += " ";
+            events += *(attr++);
+            events += "=";
+            events += *(attr++);
+        }
+        events += "]";
+    }
+
+    void endElement(caddr_t name) {
+        close();
+        events += "[/";
+        events += name;
+        events += "]";
+    }
+
+    void characters(caddr_t text, size_t size) {
+        close();
+        if(size)
+            events.paste(events.len(), text, (strsize_t)size);
+        if(scribbling)
+            memset(text, '*', size);
+    }
+
+    void comment(caddr_t text, size_t size) {
+        if(!commenting)
+            events += "{";
+        commenting = true;
+        if(size)
+            events.paste(events.len(), text, (strsize_t)size);
+    }
+
+    void endDocument(void)
+        {++documents;}
+
+    bool feed(const char *text, size_t chunk) {
+        size_t len = strlen(text);
+
+        events = "";
+        while(len) {
+            size_t size = (chunk < len) ? chunk : len;
+            if(!partial(text, size))
+                return false;
+            text += size;
+            len -= size;
+        }
+        return true;
+    }
+
+    inline bool load(FILE *fp)
+        {events = ""; return parse(fp);}
+
+    inline bool load(const char *path)
+        {events = ""; return parse(path);}
+
+    inline bool done(void) const
+        {return end();}
+
+    // the indenting between elements is not compared
+    bool matches(void) {
+        events.replace("\n  ", "");
+        events.replace("\n", "");
+        return eq(events, expected);
+    }
+};
+
+extern "C" int main()
+{
+    testParser parser;
+    char path[] = "/tmp/ucommonXMLXXXXXX";
+
+    // chunk sizes from whole document down to a character at a time
+    static const size_t chunks[] = {65536, 100, 17, 7, 3, 2, 1};
+    for(unsigned pos = 0; pos < sizeof(chunks) / sizeof(size_t); ++pos) {
+        assert(parser.feed(document, chunks[pos]));
+        assert(parser.documents == pos + 1);
+        assert(parser.matches());
+    }
+    assert(parser.documents == 7);
+
+    // documents in a stream, with text between them ignored
+    String twice = document;
+    twice += "ignored text & more";
+    twice += document;
+    assert(parser.feed(twice, 5));
+    assert(parser.documents == 9);
+
+    testParser unquoted, unknown;
+    assert(unquoted.feed("<a><b x=\"1></b></a>", 4) && !unquoted.done());
+    assert(!unknown.feed("<a>&bogus;</a>", 64));
+
+#ifndef _MSWINDOWS_
+    int fd = mkstemp(path);
+    assert(fd > -1);
+    FILE *fp = fdopen(fd, "w+");
+    fputs(document, fp);
+    fputs("<trailing/>", fp);
+    fflush(fp);
+    rewind(fp);
+    assert(parser.load(fp));
+    assert(parser.matches());
+    assert(fgetc(fp) == '\n');
+    fclose(fp);
+
+    assert(parser.load(path));
+    assert(parser.matches());
+
+    // handlers may write into the text of a mapped file, but never into
+    // the file itself...
+    parser.scribbling = true;
+    assert(parser.load(path));
+    assert(parser.matches());
+    parser.scribbling = false;
+    assert(parser.load(path));
+    assert(parser.matches());
+    remove(path);
+    assert(!parser.load(path));
+#endif
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Copyright (C) 2006-2014 David Sugar, Tycho Softworks.
+//
+// This file is part of GNU uCommon C++.
+//
+// GNU uCommon C++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// GNU uCommon C++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with GNU uCommon C++.  If not, see <http://www.gnu.org/licenses/>.
+
+// parse throughput of a large generated document, from memory as a whole,
+// fed in small chunks, from a stdio file, and from a mapped file.
+
+#include <ucommon/ucommon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ucommon;
+
+#include "bench.h"
+
+#define RECORDS     100000
+#define CHUNK       4096
+#define PASSES      5
+
+class countParser : public XMLParser
+{
+public:
+    unsigned long elements, attributes, text;
+
+    countParser() : XMLParser()
+        {elements = attributes = text = 0;}
+
+    void startElement(caddr_t, caddr_t *attr) {
+        ++elements;
+        while(attr && *attr) {
+            ++attributes;
+            attr += 2;
+        }
+    }
+
+    void endElement(caddr_t) {}
+
+    void characters(caddr_t, size_t size)
+        {text += size;}
+
+    bool whole(const char *data, size_t size)
+        {return partial(data, size) && end();}
+
+    bool chunked(const char *data, size_t size) {
+        while(size > CHUNK) {
+            if(!partial(data, CHUNK))
+                return false;
+            data += CHUNK;
+            size -= CHUNK;
+        }
+        return partial(data, size) && end();
+    }
+
+    bool file(const char *path) {
+        FILE *fp = fopen(path, "r");
+        if(!fp)
+            return false;
+        bool result = parse(fp);
+        fclose(fp);
+        return result;
+    }
+
+    bool mapped(const char *path)
+        {return parse(path);}
+};
+
+static char *document(size_t *size)
+{
+    size_t max = RECORDS * 256 + 64, len;
+    char *text = (char *)malloc(max);
+
+    len = snprintf(text, max, "<?xml version=\"1.0\"?>\n<records>\n");
+    for(unsigned pos = 0; pos < RECORDS; ++pos) {
+        len += snprintf(text + len, max - len,
+            "  <record id=\"%u\" type='entry' owner=\"user%u\">\n"
+            "    <name>Record number %u of the generated document</name>\n"
+            "    <value>%u &amp; some more descriptive text for the record</value>\n"
+            "  </record>\n", pos, pos % 97, pos, pos * 7);
+    }
+    len += snprintf(text + len, max - len, "</records>\n");
+    *size = len;
+    return text;
+}
+
+static void throughput(const char *id, double ms, size_t size, bool result)
+{
+    double mb = (double)size * PASSES / (1024.0 * 1024.0);
+
+    printf("%-10s %8.1f ms, %8.1f MB/s%s\n", id, ms, mb / (ms / 1000.0),
+        result ? "" : " (failed)");
+}
+
+extern "C" int main()
+{
+    size_t size;
+    char *text = document(&size);
+    char path[] = "/tmp/xmlbenchXXXXXX";
+    bool result = true;
+    Timer::tick_t start;
+
+    printf("document %lu bytes\n", (unsigned long)size);
+
+    start = Timer::ticks();
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        countParser parser;
+        result = result && parser.whole(text, size);
+    }
+    throughput("memory", elapsed(start), size, result);
+
+    start = Timer::ticks();
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        countParser parser;
+        result = result && parser.chunked(text, size);
+    }
+    throughput("chunked", elapsed(start), size, result);
+
+#ifndef _MSWINDOWS_
+    int fd = mkstemp(path);
+    if(fd < 0)
+        return 1;
+    FILE *fp = fdopen(fd, "w");
+    fwrite(text, size, 1, fp);
+    fclose(fp);
+
+    start = Timer::ticks();
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        countParser parser;
+        result = result && parser.file(path);
+    }
+    throughput("stdio", elapsed(start), size, result);
+
+    start = Timer::ticks();
+    for(unsigned pass = 0; pass < PASSES; ++pass) {
+        countParser parser;
+        result = result && parser.mapped(path);
+    }
+    throughput("mapped", elapsed(start), size, result);
+    remove(path);
+#endif
+
+    free(text);
+    return result ? 0 : 1;
+}
@@ -25,6 +25,10 @@
 #cmakedefine HAVE_SYS_FILIO_H 1
 #cmakedefine HAVE_SYS_MMAN_H 1
 #cmakedefine HAVE_SYS_POLL_H 1
+#cmakedefine HAVE_SYS_EPOLL_H 1
+#cmakedefine HAVE_SYS_SENDFILE_H 1
+#cmakedefine HAVE_SYS_RANDOM_H 1
+#cmakedefine HAVE_LINUX_ERRQUEUE_H 1
 #cmakedefine HAVE_SYS_RESOURCE_H 1
 #cmakedefine HAVE_SYS_SHM_H 1
 #cmakedefine HAVE_SYS_STAT_H 1
@@ -91,6 +95,9 @@
 #cmakedefine HAVE_WAITPID 1
 #cmakedefine HAVE_WAIT4 1
 #cmakedefine HAVE_SETGROUPS 1
+#cmakedefine HAVE_RECVMMSG 1
+#cmakedefine HAVE_SENDMMSG 1
+#cmakedefine HAVE_SCHED_SETAFFINITY 1
 #cmakedefine HAVE_FCNTL_H 1
 #cmakedefine HAVE_TERMIOS_H 1
 #cmakedefine HAVE_TERMIO_H 1
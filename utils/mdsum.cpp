@@ -17,21 +17,49 @@
 
 #include <ucommon/secure.h>
 #include <sys/stat.h>
+#if !defined(_MSWINDOWS_)
+#include <sys/mman.h>
+#define MDSUM_MAPPED
+#endif
 
 using namespace ucommon;
 
+// files up to this size are read whole into a buffer, larger ones are
+// mapped and hashed in pieces of the map size...
+#define READ_SIZE   65536
+#define MAP_SIZE    (8l * 1024l * 1024l)
+
 static shell::flagopt helpflag('h',"--help",    _TEXT("display this list"));
 static shell::flagopt althelp('?', NULL, NULL);
 static shell::stringopt hash('d', "--digest", _TEXT("digest method (md5)"), "method", "md5");
 static shell::flagopt recursive('R', "--recursive", _TEXT("recursive directory scan"));
 static shell::flagopt altrecursive('r', NULL, NULL);
 static shell::flagopt hidden('s', "--hidden", _TEXT("show hidden files"));
+static shell::numericopt jobs('j', "--jobs", _TEXT("digest worker threads (0 for cpus)"), "count", 0);
+static shell::flagopt stats('t', "--throughput", _TEXT("report throughput"));
+
+// a file that is hashed by an executor worker.  Files are kept in a ring
+// in the order they were found, and results are written in that order...
+class hashfile : public Executor::task
+{
+public:
+    string_t path;
+    int code;
+    fsys::offset_t bytes;
+    digest_t md;
+
+    void run(void);
+};
 
 static int exit_code = 0;
 static const char *argv0 = "md";
-static digest_t md;
+static Executor *workers = NULL;
+static hashfile *files = NULL;
+static unsigned window = 1, head = 0, pending = 0;
+static unsigned long hashed = 0;
+static fsys::offset_t total = 0;
 
-static void result(const char *path, int code)
+static void result(const char *path, int code, digest_t& md)
 {
     const char *err = _TEXT("i/o error");
 
@@ -78,13 +106,13 @@ static void result(const char *path, int code)
     }
 
     if(!code) {
-        if(!path)
+        if(!path || !*path)
             path="-";
         shell::printf("%s %s\n", *md, path);
         return;
     }
 
-    if(path)
+    if(path && *path)
         shell::printf("%s: %s: %s\n", argv0, path, err);
     else
         shell::errexit(1, "*** %s: %s\n", argv0, err);
@@ -92,45 +120,103 @@ static void result(const char *path, int code)
     exit_code = 1;
 }
 
-static void digest(const char *path = NULL)
+void hashfile::run(void)
 {
     fsys_t fs;
     fsys::fileinfo_t ino;
-    unsigned char buffer[1024];
-
-    if(path) {
-        int err = fsys::info(path, &ino);
+    unsigned char buffer[READ_SIZE];
+    const char *filename = *path;
+    ssize_t size;
 
-        if(err) {
-            result(path, err);
+    bytes = 0;
+    if(*filename) {
+        code = fsys::info(filename, &ino);
+        if(code)
             return;
-        }
 
         if(fsys::is_sys(&ino)) {
-            result(path, EBADF);
+            code = EBADF;
             return;
         }
 
-        fs.open(path, fsys::STREAM);
+        fs.open(filename, fsys::STREAM);
     }
     else
         fs.assign(shell::input());
 
     if(!is(fs)) {
-        result(path, fs.err());
+        code = fs.err();
         return;
     }
 
+#ifdef  MDSUM_MAPPED
+    // a large file is mapped a piece at a time rather than copied
+    if(*filename && S_ISREG(ino.st_mode) && ino.st_size > READ_SIZE) {
+        fsys::offset_t offset = 0;
+        while(offset < ino.st_size) {
+            size_t map = MAP_SIZE;
+            if((fsys::offset_t)map > ino.st_size - offset)
+                map = (size_t)(ino.st_size - offset);
+            void *data = mmap(NULL, map, PROT_READ, MAP_PRIVATE, *fs, (off_t)offset);
+            if(data == MAP_FAILED)
+                break;
+#ifdef  MADV_SEQUENTIAL
+            madvise(data, map, MADV_SEQUENTIAL);
+#endif
+            md.put(data, map);
+            munmap(data, map);
+            offset += map;
+        }
+        bytes = offset;
+        if(offset > 0 && fs.seek(offset)) {
+            code = fs.err();
+            fs.close();
+            return;
+        }
+    }
+#endif
+
     for(;;) {
-        ssize_t size = fs.read(buffer, sizeof(buffer));
+        size = fs.read(buffer, sizeof(buffer));
         if(size < 1)
             break;
         md.put(buffer, size);
+        bytes += size;
     }
 
     fs.close();
-    result(path, fs.err());
-    md.reset();
+    code = fs.err();
+}
+
+// write the oldest result, waiting for it if it is still being hashed...
+static void output(void)
+{
+    hashfile *file = &files[head];
+
+    file->join();
+    result(*file->path, file->code, file->md);
+    file->md.reset();
+    total += file->bytes;
+    ++hashed;
+    head = (head + 1) % window;
+    --pending;
+}
+
+static void digest(const char *path = NULL, int code = 0)
+{
+    if(pending == window)
+        output();
+
+    hashfile *file = &files[(head + pending++) % window];
+    file->path = path ? path : "";
+    file->code = code;
+    file->bytes = 0;
+
+    // stdin is hashed at once, since only files are found in the walk
+    if(!path)
+        file->run();
+    else if(!code)
+        workers->submit(file);
 }
 
 static void scan(String path, bool top = true)
@@ -151,7 +237,7 @@ static void scan(String path, bool top = true)
             if(is(recursive) || is(altrecursive))
                 scan(filepath, false);
             else
-                result(filepath, EISDIR);
+                digest(filepath, EISDIR);
         }
         else
             digest(filepath);
@@ -181,11 +267,25 @@ PROGRAM_MAIN(argc, argv)
         shell::errexit(2, "*** %s: %s: %s\n",
             argv0, *hash, _TEXT("unkown or unsupported digest method"));
 
-    md = *hash;
+    if(*jobs < 0)
+        shell::errexit(2, "*** %s: %ld: %s\n",
+            argv0, *jobs, _TEXT("must be zero or more"));
+
+    const char *method = *hash;
 
     // we can symlink md as md5, etc, to set alternate default digest names
     if(!is(hash) && Digest::has(argv0))
-        md = argv0;
+        method = argv0;
+
+    // enough files are kept in flight for every worker to have a queue
+    workers = new Executor((unsigned)*jobs);
+    window = workers->size() * 4 + 16;
+    files = new hashfile[window];
+    for(unsigned pos = 0; pos < window; ++pos)
+        files[pos].md = method;
+
+    Timer::tick_t start = Timer::ticks();
+    workers->start();
 
     if(!args())
         digest();
@@ -196,6 +296,21 @@ PROGRAM_MAIN(argc, argv)
             digest(args[count++]);
     }
 
+    while(pending)
+        output();
+
+    delete workers;
+    delete[] files;
+
+    if(is(stats)) {
+        double secs = (double)(Timer::ticks() - start) / 10000000.0;
+        if(secs <= 0.0)
+            secs = 0.000001;
+        fprintf(stderr, "%lu %s, %.1f MB, %.3f %s, %.1f MB/s\n",
+            hashed, _TEXT("files"), (double)total / (1024.0 * 1024.0), secs,
+            _TEXT("seconds"), (double)total / (1024.0 * 1024.0) / secs);
+    }
+
     PROGRAM_EXIT(exit_code);
 }
 